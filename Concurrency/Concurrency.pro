@@ -0,0 +1,31 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2026-10-18T10:00:00
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = Concurrency
+TEMPLATE = lib
+CONFIG += thread
+QMAKE_CXXFLAGS += -Wall -Werror -std=c++11
+
+DEFINES += CONCURRENCY_LIBRARY
+
+SOURCES +=
+
+HEADERS += \
+    ParallelFor.h \
+    ThreadPool.h \
+    DefaultInitAllocator.h \
+    Numa.h
+
+unix:!symbian {
+    maemo5 {
+        target.path = /opt/usr/lib
+    } else {
+        target.path = /usr/lib
+    }
+    INSTALLS += target
+}
@@ -0,0 +1,50 @@
+#ifndef Concurrency_DefaultInitAllocator_H
+#define Concurrency_DefaultInitAllocator_H
+
+#include <new>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <type_traits>
+
+namespace Concurrency
+{
+
+//! An allocator that default-initializes elements constructed without arguments instead of value-initializing them, so
+//! that resize(n) on a vector of scalars leaves the memory untouched. The pages of such a vector are then first written,
+//! and so placed on a NUMA node, by whichever thread fills them
+template<typename T,typename A=std::allocator<T>>
+class DefaultInitAllocator:public A
+{
+	using Traits=std::allocator_traits<A>;
+public:
+	template<typename U>
+	struct rebind
+	{
+		using other=DefaultInitAllocator<U,typename Traits::template rebind_alloc<U>>;
+	};
+
+	using A::A;
+
+	DefaultInitAllocator()=default;
+
+	template<typename U>
+	void construct(U* p) noexcept(std::is_nothrow_default_constructible<U>::value)
+	{
+		::new(static_cast<void*>(p)) U;
+	}
+
+	template<typename U,typename... Args>
+	void construct(U* p,Args&&... args)
+	{
+		Traits::construct(static_cast<A&>(*this),p,std::forward<Args>(args)...);
+	}
+};
+
+//! A vector whose resize() doesn't zero-fill
+template<typename T>
+using UninitializedVector=std::vector<T,DefaultInitAllocator<T>>;
+
+}
+
+#endif // Concurrency_DefaultInitAllocator_H
@@ -0,0 +1,177 @@
+#ifndef Concurrency_Numa_H
+#define Concurrency_Numa_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include "ParallelFor.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace Concurrency
+{
+
+namespace Detail
+{
+
+//! Parse a kernel cpu list such as "0-3,8,10-11"
+inline std::vector<unsigned int> parseCpuList(const std::string& list)
+{
+	std::vector<unsigned int> result;
+	std::istringstream stream(list);
+	std::string item;
+	while(std::getline(stream,item,','))
+	{
+		unsigned int first=0,last=0;
+		char dash=0;
+		std::istringstream range(item);
+		if(not(range>>first))
+		{
+			continue;
+		}
+		last=first;
+		if(range>>dash and dash=='-')
+		{
+			range>>last;
+		}
+		for(unsigned int cpu=first;cpu<=last;++cpu)
+		{
+			result.push_back(cpu);
+		}
+	}
+	return result;
+}
+
+//! The cpus of every NUMA node, read once from sysfs. A single node without cpus where the topology is unknown
+inline const std::vector<std::vector<unsigned int>>& topology()
+{
+	static const std::vector<std::vector<unsigned int>> s_topology=[]()
+	{
+		std::vector<std::vector<unsigned int>> result;
+#ifdef __linux__
+		while(true)
+		{
+			std::ifstream file("/sys/devices/system/node/node"+std::to_string(result.size())+"/cpulist");
+			std::string list;
+			if(not std::getline(file,list))
+			{
+				break;
+			}
+			result.push_back(parseCpuList(list));
+		}
+#endif
+		if(result.empty())
+		{
+			result.resize(1);
+		}
+		return result;
+	}();
+	return s_topology;
+}
+
+}
+
+//! The number of NUMA nodes of the machine. Never 0
+inline unsigned int numaNodes()
+{
+	return Detail::topology().size();
+}
+
+//! The cpus of a NUMA node. Empty if the node doesn't exist or the topology is unknown
+inline std::vector<unsigned int> numaNodeCpus(const unsigned int node)
+{
+	return node<numaNodes()?Detail::topology()[node]:std::vector<unsigned int>();
+}
+
+//! Spread parts over the NUMA nodes round-robin: part p goes to node p%numaNodes()
+inline std::vector<unsigned int> numaPlacement(const unsigned int parts)
+{
+	std::vector<unsigned int> result(parts);
+	for(unsigned int p=0;p<parts;++p)
+	{
+		result[p]=p%numaNodes();
+	}
+	return result;
+}
+
+//! Restricts the calling thread to the cpus of a NUMA node while it exists, and restores the previous affinity when it
+//! goes away. Memory the thread touches first in the meantime is allocated on that node by the default kernel policy.
+//! Does nothing if the node has no known cpus or the platform can't pin threads
+class NumaBinding
+{
+public:
+	explicit NumaBinding(const unsigned int node) noexcept:
+		m_bound(false)
+	{
+#ifdef __linux__
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for(const auto& cpu:numaNodeCpus(node))
+		{
+			if(cpu<CPU_SETSIZE)
+			{
+				CPU_SET(cpu,&set);
+			}
+		}
+		if(CPU_COUNT(&set) and not pthread_getaffinity_np(pthread_self(),sizeof(m_previous),&m_previous))
+		{
+			m_bound=not pthread_setaffinity_np(pthread_self(),sizeof(set),&set);
+		}
+#else
+		(void)node;
+#endif
+	}
+
+	NumaBinding(const NumaBinding&)=delete;
+
+	NumaBinding& operator=(const NumaBinding&)=delete;
+
+	~NumaBinding() noexcept
+	{
+#ifdef __linux__
+		if(m_bound)
+		{
+			pthread_setaffinity_np(pthread_self(),sizeof(m_previous),&m_previous);
+		}
+#endif
+	}
+
+	//! True iff the thread was pinned
+	bool bound() const noexcept
+	{
+		return m_bound;
+	}
+private:
+	bool m_bound;
+
+#ifdef __linux__
+	cpu_set_t m_previous;
+#endif
+};
+
+/*!
+ * \brief parallelForRanges Like parallelForRanges(bounds, f), but the call for chunk i runs on the cpus of NUMA node
+ * nodes[i], so that it works on memory that lives on that node. An empty nodes vector means no pinning
+ */
+template<typename B,typename F>
+void parallelForRanges(const std::vector<B>& bounds,const std::vector<unsigned int>& nodes,const F& f)
+{
+	if(nodes.empty())
+	{
+		parallelForRanges(bounds,f);
+		return;
+	}
+	parallelForRanges(bounds,[&nodes,&f](const std::size_t chunk,const B first,const B last)
+	{
+		const NumaBinding binding(nodes[chunk]);
+		f(chunk,first,last);
+	});
+}
+
+}
+
+#endif // Concurrency_Numa_H
@@ -0,0 +1,113 @@
+#ifndef Concurrency_ParallelFor_H
+#define Concurrency_ParallelFor_H
+
+#include <thread>
+#include <vector>
+#include <exception>
+#include <algorithm>
+#include <system_error>
+
+namespace Concurrency
+{
+
+//! The number of threads the parallel algorithms use by default. Never 0
+inline unsigned int hardwareThreads() noexcept
+{
+	const unsigned int n=std::thread::hardware_concurrency();
+	return n?n:1;
+}
+
+//! Ranges shorter than this are not split further, so that small inputs don't pay for thread creation
+static const std::size_t s_minimumChunk=1024;
+
+/*!
+ * \brief parallelForRanges Call f(i, bounds[i], bounds[i+1]) once for every consecutive pair of bounds, each call on
+ * its own thread. The calling thread makes the first call itself. Use it when the work has to be split at specific
+ * points, for example to balance the number of edges rather than the number of nodes per thread.
+ * If a call throws, the remaining calls still run to completion and the first exception is rethrown
+ */
+template<typename B,typename F>
+void parallelForRanges(const std::vector<B>& bounds,const F& f)
+{
+	if(bounds.size()<2)
+	{
+		return;
+	}
+	const std::size_t chunks=bounds.size()-1;
+	if(chunks==1)
+	{
+		f(0,bounds[0],bounds[1]);
+		return;
+	}
+	std::vector<std::exception_ptr> errors(chunks);
+	std::vector<std::thread> workers;
+	workers.reserve(chunks-1);
+	const auto run=[&f,&errors,&bounds](const std::size_t chunk) noexcept
+	{
+		try
+		{
+			f(chunk,bounds[chunk],bounds[chunk+1]);
+		}
+		catch(...)
+		{
+			errors[chunk]=std::current_exception();
+		}
+	};
+	for(std::size_t chunk=1;chunk<chunks;++chunk)
+	{
+		try
+		{
+			workers.emplace_back(run,chunk);
+		}
+		catch(const std::system_error&)
+		{
+			run(chunk);
+		}
+	}
+	run(0);
+	for(auto& w:workers)
+	{
+		w.join();
+	}
+	for(const auto& e:errors)
+	{
+		if(e)
+		{
+			std::rethrow_exception(e);
+		}
+	}
+}
+
+/*!
+ * \brief parallelFor Split the index range [first, last) into contiguous chunks of about the same size and call
+ * f(begin, end) once per chunk, each chunk on its own thread. The calling thread processes the first chunk itself.
+ * If an invocation throws, the remaining chunks still run to completion and the first exception is rethrown
+ * \param threads The maximum number of chunks. 0 means hardwareThreads()
+ */
+template<typename F>
+void parallelFor(const std::size_t first,const std::size_t last,const F& f,unsigned int threads=0)
+{
+	if(last<=first)
+	{
+		return;
+	}
+	if(not threads)
+	{
+		threads=hardwareThreads();
+	}
+	const std::size_t n=last-first;
+	const std::size_t chunks=std::max<std::size_t>(1,std::min<std::size_t>(threads,n/s_minimumChunk));
+	std::vector<std::size_t> bounds(chunks+1);
+	for(std::size_t chunk=0;chunk<=chunks;++chunk)
+	{
+		bounds[chunk]=first+n/chunks*chunk+std::min(chunk,n%chunks);
+	}
+	parallelForRanges(bounds,[&f](const std::size_t,const std::size_t begin,const std::size_t end)
+	{
+		f(begin,end);
+	});
+}
+
+}
+
+#endif // Concurrency_ParallelFor_H
@@ -0,0 +1,201 @@
+#ifndef Concurrency_ThreadPool_H
+#define Concurrency_ThreadPool_H
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <type_traits>
+#include <condition_variable>
+#include "ParallelFor.h"
+
+namespace Concurrency
+{
+
+//! A fixed set of worker threads that run submitted tasks, with work stealing. Every worker has its own queue. Tasks
+//! submitted from a worker go to the back of its own queue and it takes tasks from the back, so related work stays on
+//! the same core; idle workers steal from the front of the other queues. Tasks submitted from other threads are spread
+//! over the queues round-robin.
+//! Results and exceptions come back through std::future. A task must not block waiting for tasks queued behind it
+class ThreadPool
+{
+public:
+	//! \param threads The number of workers. 0 means hardwareThreads()
+	explicit ThreadPool(const unsigned int threads=0):
+		m_pending(0),
+		m_stopping(false),
+		m_next(0)
+	{
+		const unsigned int n=threads?threads:hardwareThreads();
+		for(unsigned int i=0;i<n;++i)
+		{
+			m_queues.emplace_back(new Queue);
+		}
+		m_workers.reserve(n);
+		try
+		{
+			for(unsigned int i=0;i<n;++i)
+			{
+				m_workers.emplace_back(&ThreadPool::work,this,i);
+			}
+		}
+		catch(...)
+		{
+			stop();
+			throw;
+		}
+	}
+
+	ThreadPool(const ThreadPool&)=delete;
+
+	ThreadPool& operator=(const ThreadPool&)=delete;
+
+	//! Run the tasks that are still queued, then stop the workers
+	~ThreadPool() noexcept
+	{
+		stop();
+	}
+
+	//! The number of workers
+	unsigned int size() const noexcept
+	{
+		return m_workers.size();
+	}
+
+	//! Queue a task. The future gets its result, or the exception it throws
+	template<typename F>
+	std::future<typename std::result_of<F()>::type> submit(F f)
+	{
+		using R=typename std::result_of<F()>::type;
+		const std::shared_ptr<std::packaged_task<R()>> task=std::make_shared<std::packaged_task<R()>>(std::move(f));
+		std::future<R> result=task->get_future();
+		const Worker& self=current();
+		const std::size_t index=self.pool==this?self.index:m_next++%m_queues.size();
+		{
+			const std::lock_guard<std::mutex> lock(m_mutex);
+			++m_pending;
+		}
+		{
+			Queue& q=*m_queues[index];
+			const std::lock_guard<std::mutex> lock(q.mutex);
+			q.tasks.push_back([task]()
+			{
+				(*task)();
+			});
+		}
+		m_condition.notify_one();
+		return result;
+	}
+private:
+	using Task=std::function<void()>;
+
+	struct Queue
+	{
+		std::mutex mutex;
+
+		std::deque<Task> tasks;
+	};
+
+	//! The pool and queue of a worker thread
+	struct Worker
+	{
+		const ThreadPool* pool;
+
+		std::size_t index;
+	};
+
+	std::vector<std::unique_ptr<Queue>> m_queues;
+
+	std::vector<std::thread> m_workers;
+
+	//! Guards the sleeping of the workers
+	std::mutex m_mutex;
+
+	std::condition_variable m_condition;
+
+	//! The number of tasks submitted and not taken by a worker yet. Only incremented while holding m_mutex, so that a
+	//! worker that checks it before sleeping can't miss a submission
+	std::atomic<long long> m_pending;
+
+	bool m_stopping;
+
+	//! Round-robin counter for tasks submitted from outside the pool
+	std::atomic<std::size_t> m_next;
+
+	//! The worker that the calling thread is, if any
+	static Worker& current() noexcept
+	{
+		static thread_local Worker worker{nullptr,0};
+		return worker;
+	}
+
+	//! Take a task from the back of a worker's own queue, or else steal one from the front of another queue
+	bool take(const std::size_t index,Task& task)
+	{
+		for(std::size_t i=0;i<m_queues.size();++i)
+		{
+			Queue& q=*m_queues[(index+i)%m_queues.size()];
+			const std::lock_guard<std::mutex> lock(q.mutex);
+			if(not q.tasks.empty())
+			{
+				if(i)
+				{
+					task=std::move(q.tasks.front());
+					q.tasks.pop_front();
+				}
+				else
+				{
+					task=std::move(q.tasks.back());
+					q.tasks.pop_back();
+				}
+				--m_pending;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void stop() noexcept
+	{
+		{
+			const std::lock_guard<std::mutex> lock(m_mutex);
+			m_stopping=true;
+		}
+		m_condition.notify_all();
+		for(auto& w:m_workers)
+		{
+			w.join();
+		}
+	}
+
+	void work(const std::size_t index)
+	{
+		current()=Worker{this,index};
+		while(true)
+		{
+			Task task;
+			if(take(index,task))
+			{
+				task();
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock,[this]()
+			{
+				return m_stopping or m_pending>0;
+			});
+			if(m_stopping and m_pending<=0)
+			{
+				return;
+			}
+		}
+	}
+};
+
+}
+
+#endif // Concurrency_ThreadPool_H
@@ -0,0 +1,26 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2026-10-18T10:05:00
+#
+#-------------------------------------------------
+
+QT       += testlib
+
+QT       -= gui
+
+TARGET = tst_ConcurrencyUnitTest
+CONFIG   += console thread
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+QMAKE_CXXFLAGS += -Wall -Werror -std=c++11
+
+SOURCES += tst_ConcurrencyUnitTest.cpp
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
+
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../Concurrency/release/ -lConcurrency
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../Concurrency/debug/ -lConcurrency
+else:unix: LIBS += -L$$OUT_PWD/../Concurrency/ -lConcurrency
+
+INCLUDEPATH += $$PWD/../Concurrency
+DEPENDPATH += $$PWD/../Concurrency
@@ -0,0 +1,185 @@
+#include <QtTest>
+#include <atomic>
+#include "ParallelFor.h"
+#include "ThreadPool.h"
+#include "DefaultInitAllocator.h"
+#include "Numa.h"
+
+using namespace Concurrency;
+
+class ConcurrencyUnitTest:public QObject
+{
+	Q_OBJECT
+public:
+	ConcurrencyUnitTest();
+private Q_SLOTS:
+	void parallelForCoverage();
+	void parallelForException();
+	void threadPool();
+	void defaultInitAllocator();
+	void numa();
+};
+
+ConcurrencyUnitTest::ConcurrencyUnitTest()
+{
+}
+
+void ConcurrencyUnitTest::parallelForCoverage()
+{
+	const std::size_t n=100*s_minimumChunk+7;
+	std::vector<std::atomic<unsigned int>> counts(n);
+	for(auto& c:counts)
+	{
+		c=0;
+	}
+	parallelFor(3,n,[&counts](const std::size_t first,const std::size_t last)
+	{
+		for(std::size_t i=first;i<last;++i)
+		{
+			++counts[i];
+		}
+	},8);
+	for(std::size_t i=0;i<n;++i)
+	{
+		QVERIFY(counts[i]==(i<3?0:1));
+	}
+	bool called=false;
+	parallelFor(5,5,[&called](const std::size_t,const std::size_t)
+	{
+		called=true;
+	});
+	QVERIFY(not called);
+}
+
+void ConcurrencyUnitTest::parallelForException()
+{
+	const std::size_t n=16*s_minimumChunk;
+	std::atomic<std::size_t> visited(0);
+	try
+	{
+		parallelFor(0,n,[&visited,n](const std::size_t first,const std::size_t last)
+		{
+			visited+=last-first;
+			if(first<=n/2 and n/2<last)
+			{
+				throw std::out_of_range("middle");
+			}
+		},4);
+		QVERIFY(false);
+	}
+	catch(const std::out_of_range&)
+	{
+		QVERIFY(visited==n);
+	}
+}
+
+void ConcurrencyUnitTest::threadPool()
+{
+	ThreadPool pool(4);
+	QVERIFY(pool.size()==4);
+	std::vector<std::future<std::size_t>> squares;
+	for(std::size_t i=0;i<1000;++i)
+	{
+		squares.push_back(pool.submit([i]()
+		{
+			return i*i;
+		}));
+	}
+	for(std::size_t i=0;i<squares.size();++i)
+	{
+		QVERIFY(squares[i].get()==i*i);
+	}
+	std::future<void> failed=pool.submit([]()
+	{
+		throw std::out_of_range("task");
+	});
+	try
+	{
+		failed.get();
+		QVERIFY(false);
+	}
+	catch(const std::out_of_range&)
+	{
+	}
+	std::atomic<unsigned int> done(0);
+	std::future<std::vector<std::future<void>>> outer=pool.submit([&pool,&done]()
+	{
+		std::vector<std::future<void>> inner;
+		for(unsigned int i=0;i<100;++i)
+		{
+			inner.push_back(pool.submit([&done]()
+			{
+				++done;
+			}));
+		}
+		return inner;
+	});
+	for(auto& f:outer.get())
+	{
+		f.get();
+	}
+	QVERIFY(done==100);
+	{
+		ThreadPool drained(2);
+		for(unsigned int i=0;i<100;++i)
+		{
+			drained.submit([&done]()
+			{
+				++done;
+			});
+		}
+	}
+	QVERIFY(done==200);
+}
+
+void ConcurrencyUnitTest::defaultInitAllocator()
+{
+	UninitializedVector<int> v(5,7);
+	QVERIFY(v.size()==5 and std::count(v.begin(),v.end(),7)==5);
+	v.resize(1000);
+	std::fill(v.begin()+5,v.end(),3);
+	v.push_back(4);
+	const UninitializedVector<int> copy(v);
+	QVERIFY(copy.size()==1001 and copy[4]==7 and copy[5]==3 and copy.back()==4);
+	UninitializedVector<std::string> strings(3);
+	QVERIFY(strings[2].empty());
+}
+
+void ConcurrencyUnitTest::numa()
+{
+	QVERIFY(Detail::parseCpuList("0-3,8,10-11\n")==std::vector<unsigned int>({0,1,2,3,8,10,11}));
+	QVERIFY(Detail::parseCpuList("").empty());
+	QVERIFY(numaNodes()>=1);
+	QVERIFY(numaNodeCpus(numaNodes()).empty());
+	const std::vector<unsigned int> placement=numaPlacement(5);
+	QVERIFY(placement.size()==5 and placement[0]==0);
+	for(const auto& node:placement)
+	{
+		QVERIFY(node<numaNodes());
+	}
+	{
+		const NumaBinding binding(0);
+		QVERIFY(binding.bound() or numaNodeCpus(0).empty());
+	}
+	const std::vector<std::size_t> bounds={0,10,20,30,40};
+	std::vector<std::atomic<unsigned int>> counts(40);
+	for(auto& c:counts)
+	{
+		c=0;
+	}
+	parallelForRanges(bounds,numaPlacement(4),[&counts](const std::size_t,const std::size_t first,const std::size_t last)
+	{
+		for(std::size_t i=first;i<last;++i)
+		{
+			++counts[i];
+		}
+	});
+	for(const auto& c:counts)
+	{
+		QVERIFY(c==1);
+	}
+}
+
+QTEST_APPLESS_MAIN(ConcurrencyUnitTest)
+
+#include "tst_ConcurrencyUnitTest.moc"
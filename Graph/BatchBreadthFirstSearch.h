@@ -0,0 +1,332 @@
+#ifndef Graph_BatchBreadthFirstSearch_H
+#define Graph_BatchBreadthFirstSearch_H
+
+#include <vector>
+#include <future>
+#include <memory>
+#include <cstdint>
+#include <utility>
+#include <stdexcept>
+#include "CompactGraph.h"
+#include "ThreadPool.h"
+
+namespace Graph
+{
+
+//! Answers many independent bounded breadth-first queries over the same CompactGraph together. Queries are grouped in
+//! batches of 64 and every batch is one multi-source BFS (Then et al., "The More the Merrier"): every node carries a
+//! 64-bit mask of the queries that have reached it, so a single sweep over an edge advances all the queries of the batch
+//! that are at its source. The batches run as tasks of a ThreadPool, and every query gets its own future.
+//! The graph and the pool must outlive the futures
+template<typename T>
+class BatchBreadthFirstSearch
+{
+public:
+	using NodeId=typename CompactGraph<T>::NodeId;
+
+	//! The nodes reached by a query, in breadth-first order, starting with the source
+	using Reached=std::vector<NodeId>;
+
+	//! The number of queries in a batch, one per bit of a mask
+	static const std::size_t s_batchSize=64;
+
+	BatchBreadthFirstSearch(const CompactGraph<T>& graph,Concurrency::ThreadPool& pool) noexcept:
+		m_graph(graph),
+		m_pool(pool)
+	{
+	}
+
+	/*!
+	 * \brief reached For every source, the nodes within maxDepth hops of it
+	 * \throw std::out_of_range If a source is not a node id
+	 */
+	std::vector<std::future<Reached>> reached(const std::vector<NodeId>& sources,const unsigned int maxDepth) const
+	{
+		check(sources);
+		std::vector<std::future<Reached>> result;
+		result.reserve(sources.size());
+		for(std::size_t first=0;first<sources.size();first+=s_batchSize)
+		{
+			const std::size_t count=std::min(s_batchSize,sources.size()-first);
+			const std::shared_ptr<std::vector<std::promise<Reached>>> promises=std::make_shared<std::vector<std::promise<Reached>>>(count);
+			for(auto& p:*promises)
+			{
+				result.push_back(p.get_future());
+			}
+			const std::vector<NodeId> batch(sources.begin()+first,sources.begin()+first+count);
+			m_pool.submit([this,batch,maxDepth,promises]()
+			{
+				try
+				{
+					std::vector<Reached> reached(batch.size());
+					search(batch,maxDepth,[&reached](const std::size_t query,const NodeId node)
+					{
+						reached[query].push_back(node);
+						return true;
+					});
+					for(std::size_t i=0;i<batch.size();++i)
+					{
+						(*promises)[i].set_value(std::move(reached[i]));
+					}
+				}
+				catch(...)
+				{
+					for(auto& p:*promises)
+					{
+						p.set_exception(std::current_exception());
+					}
+				}
+			});
+		}
+		return result;
+	}
+
+	/*!
+	 * \brief reachable For every pair, whether the second node is within maxDepth hops of the first. A query stops
+	 * spreading as soon as it finds its target
+	 * \throw std::out_of_range If a node is not a node id
+	 */
+	std::vector<std::future<bool>> reachable(const std::vector<std::pair<NodeId,NodeId>>& pairs,const unsigned int maxDepth) const
+	{
+		std::vector<NodeId> sources;
+		sources.reserve(pairs.size());
+		for(const auto& p:pairs)
+		{
+			sources.push_back(p.first);
+			if(p.second>=m_graph.size())
+			{
+				throw std::out_of_range("Target is not a node id");
+			}
+		}
+		check(sources);
+		std::vector<std::future<bool>> result;
+		result.reserve(pairs.size());
+		for(std::size_t first=0;first<pairs.size();first+=s_batchSize)
+		{
+			const std::size_t count=std::min(s_batchSize,pairs.size()-first);
+			const std::shared_ptr<std::vector<std::promise<bool>>> promises=std::make_shared<std::vector<std::promise<bool>>>(count);
+			for(auto& p:*promises)
+			{
+				result.push_back(p.get_future());
+			}
+			const std::vector<std::pair<NodeId,NodeId>> batch(pairs.begin()+first,pairs.begin()+first+count);
+			m_pool.submit([this,batch,maxDepth,promises]()
+			{
+				try
+				{
+					std::vector<NodeId> sources;
+					for(const auto& p:batch)
+					{
+						sources.push_back(p.first);
+					}
+					std::vector<bool> found(batch.size(),false);
+					search(sources,maxDepth,[&batch,&found](const std::size_t query,const NodeId node)
+					{
+						if(node==batch[query].second)
+						{
+							found[query]=true;
+							return false;
+						}
+						return true;
+					});
+					for(std::size_t i=0;i<batch.size();++i)
+					{
+						(*promises)[i].set_value(found[i]);
+					}
+				}
+				catch(...)
+				{
+					for(auto& p:*promises)
+					{
+						p.set_exception(std::current_exception());
+					}
+				}
+			});
+		}
+		return result;
+	}
+private:
+	using Mask=std::uint64_t;
+
+	//! The per-thread state of a multi-source BFS. The masks are all 0 between searches; a search clears the entries it
+	//! touched, so it costs O(reached nodes and their edges) rather than O(nodes). A node is put in a list before its
+	//! mask entry is set, so the lists always cover the non-zero entries, even when a search is interrupted
+	struct Workspace
+	{
+		//! The queries that have reached every node
+		std::vector<Mask> seen;
+
+		//! The queries that reached every node in the last level
+		std::vector<Mask> visit;
+
+		//! The queries that reach every node in the next level
+		std::vector<Mask> next;
+
+		//! The nodes of the last level and the next level
+		std::vector<NodeId> frontier;
+
+		std::vector<NodeId> nextFrontier;
+
+		//! Every node with a non-zero entry in seen
+		std::vector<NodeId> touched;
+	};
+
+	const CompactGraph<T>& m_graph;
+
+	Concurrency::ThreadPool& m_pool;
+
+	void check(const std::vector<NodeId>& sources) const
+	{
+		for(const auto& s:sources)
+		{
+			if(s>=m_graph.size())
+			{
+				throw std::out_of_range("Source is not a node id");
+			}
+		}
+	}
+
+	static Workspace& workspace() noexcept
+	{
+		static thread_local Workspace w;
+		return w;
+	}
+
+	//! Run a multi-source BFS for up to 64 sources. reach(query, node) is called once for every node a query reaches,
+	//! level by level; when it returns false the query stops spreading. If reach throws, the workspace is cleared and
+	//! the exception propagates
+	template<typename F>
+	void search(const std::vector<NodeId>& sources,const unsigned int maxDepth,const F& reach) const
+	{
+		Workspace& w=workspace();
+		const NodeId n=m_graph.size();
+		for(auto* masks:{&w.seen,&w.visit,&w.next})
+		{
+			if(masks->size()<n)
+			{
+				masks->resize(n,0);
+			}
+		}
+		try
+		{
+			spread(w,sources,maxDepth,reach);
+		}
+		catch(...)
+		{
+			reset(w);
+			throw;
+		}
+		reset(w);
+	}
+
+	//! The body of search(), which leaves the masks set along the lists of the workspace
+	template<typename F>
+	void spread(Workspace& w,const std::vector<NodeId>& sources,const unsigned int maxDepth,const F& reach) const
+	{
+		Mask active=0;
+		for(std::size_t q=0;q<sources.size();++q)
+		{
+			const NodeId s=sources[q];
+			const Mask bit=Mask(1)<<q;
+			if(not w.seen[s])
+			{
+				w.touched.push_back(s);
+			}
+			if(not w.visit[s])
+			{
+				w.frontier.push_back(s);
+			}
+			w.seen[s]|=bit;
+			if(reach(q,s))
+			{
+				w.visit[s]|=bit;
+				active|=bit;
+			}
+		}
+		for(unsigned int depth=0;depth<maxDepth and active and not w.frontier.empty();++depth)
+		{
+			for(const auto& u:w.frontier)
+			{
+				const Mask m=w.visit[u]&active;
+				w.visit[u]=0;
+				if(not m)
+				{
+					continue;
+				}
+				for(const auto& v:m_graph.neighbors(u))
+				{
+					const Mask fresh=m&~w.seen[v];
+					if(fresh)
+					{
+						if(not w.next[v])
+						{
+							w.nextFrontier.push_back(v);
+						}
+						w.next[v]|=fresh;
+						if(not w.seen[v])
+						{
+							w.touched.push_back(v);
+						}
+						w.seen[v]|=fresh;
+					}
+				}
+			}
+			w.frontier.clear();
+			for(const auto& v:w.nextFrontier)
+			{
+				Mask m=w.next[v];
+				w.next[v]=0;
+				for(Mask rest=m;rest;rest&=rest-1)
+				{
+					const Mask bit=rest&(~rest+1);
+					if(not reach(index(bit),v))
+					{
+						active&=~bit;
+						m&=~bit;
+					}
+				}
+				if(m)
+				{
+					w.frontier.push_back(v);
+					w.visit[v]=m;
+				}
+			}
+			w.nextFrontier.clear();
+		}
+	}
+
+	//! Clear the mask entries that the lists of a workspace cover, and the lists, so that the masks are all 0 again
+	static void reset(Workspace& w) noexcept
+	{
+		for(const auto& u:w.frontier)
+		{
+			w.visit[u]=0;
+		}
+		w.frontier.clear();
+		for(const auto& v:w.nextFrontier)
+		{
+			w.next[v]=0;
+		}
+		w.nextFrontier.clear();
+		for(const auto& u:w.touched)
+		{
+			w.seen[u]=0;
+		}
+		w.touched.clear();
+	}
+
+	//! The position of the single bit set in a mask, by de Bruijn multiplication
+	static std::size_t index(const Mask bit) noexcept
+	{
+		static const unsigned char positions[64]={0,1,48,2,57,49,28,3,61,58,50,42,38,29,17,4,62,55,59,36,53,51,43,22,45,39,33,30,
+			24,18,12,5,63,47,56,27,60,41,37,16,54,35,52,21,44,32,23,11,46,26,40,15,34,20,31,10,25,14,19,9,13,8,7,6};
+		return positions[(bit*Mask(0x03f79d71b4cb0a89))>>58];
+	}
+};
+
+template<typename T>
+const std::size_t BatchBreadthFirstSearch<T>::s_batchSize;
+
+}
+
+#endif // Graph_BatchBreadthFirstSearch_H
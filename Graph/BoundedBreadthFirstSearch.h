@@ -0,0 +1,148 @@
+#ifndef Graph_BoundedBreadthFirstSearch_H
+#define Graph_BoundedBreadthFirstSearch_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include "UndirectedGraph.h"
+#include "GraphTraits.h"
+
+namespace Graph
+{
+
+//! Breadth-first search from a set of seeds, up to a maximum depth and restricted to the nodes that pass a filter.
+//! An object is the workspace of the searches: a visited array stamped with the number of the search that last reached each
+//! node, and the list of visited nodes, which doubles as the queue. Both are kept between searches, so a search costs
+//! O(visited nodes and their edges) and allocates nothing once the workspace has grown to the size of the graph.
+//! A workspace must not be used by two threads at once; local() gives every thread its own.
+//! Works on any graph with GraphTraits, such as CompactGraph, CompressedGraph and UndirectedGraph, addressing nodes by
+//! their dense ids
+class BoundedBreadthFirstSearch
+{
+public:
+	using NodeId=unsigned int;
+
+	//! A node reached by a search and its distance from the closest seed
+	struct Visit
+	{
+		NodeId node;
+
+		unsigned int depth;
+	};
+
+	using Visits=std::vector<Visit>;
+
+	/*!
+	 * \brief operator () Visit the nodes within maxDepth hops of the seeds, in breadth-first order. The seeds have depth 0.
+	 * Nodes for which filter(id) returns false are neither visited nor expanded, seeds included.
+	 * The result is valid until the next search with this workspace
+	 * \throw std::out_of_range If a seed is not a node id
+	 */
+	template<typename G,typename F>
+	const Visits& operator()(const G& graph,const std::vector<NodeId>& seeds,const unsigned int maxDepth,const F& filter)
+	{
+		using Traits=GraphTraits<G>;
+		const NodeId bound=Traits::idBound(graph);
+		for(const auto& s:seeds)
+		{
+			if(not Traits::isNode(graph,s))
+			{
+				throw std::out_of_range("Seed is not a node id");
+			}
+		}
+		start(bound);
+		for(const auto& s:seeds)
+		{
+			if(m_stamps[s]<m_epoch)
+			{
+				reach(s,0,filter);
+			}
+		}
+		for(std::size_t next=0;next<m_visits.size();++next)
+		{
+			const Visit u=m_visits[next];
+			if(u.depth==maxDepth)
+			{
+				break;
+			}
+			Traits::forEachNeighborById(graph,u.node,[this,&u,&filter](const typename Traits::Node&,const NodeId v,const typename Traits::EdgeWeight)
+			{
+				if(m_stamps[v]<m_epoch)
+				{
+					reach(v,u.depth+1,filter);
+				}
+			});
+		}
+		return m_visits;
+	}
+
+	//! Search without a filter
+	template<typename G>
+	const Visits& operator()(const G& graph,const std::vector<NodeId>& seeds,const unsigned int maxDepth)
+	{
+		return (*this)(graph,seeds,maxDepth,[](const NodeId)
+		{
+			return true;
+		});
+	}
+
+	//! Whether the last search visited a node
+	bool visited(const NodeId n) const noexcept
+	{
+		return n<m_stamps.size() and m_stamps[n]==m_epoch;
+	}
+
+	//! The workspace of the calling thread
+	static BoundedBreadthFirstSearch& local()
+	{
+		static thread_local BoundedBreadthFirstSearch workspace;
+		return workspace;
+	}
+private:
+	//! The search that last reached every node: m_epoch if the node was visited, m_epoch+1 if the filter rejected it.
+	//! Stamps of earlier searches are smaller
+	std::vector<std::uint32_t> m_stamps;
+
+	//! The stamp of the current search. Always even, and 0 before the first search
+	std::uint32_t m_epoch=0;
+
+	//! The visited nodes in breadth-first order. The unexpanded ones at the end are the queue
+	Visits m_visits;
+
+	//! Prepare the workspace for a new search over the ids [0, bound)
+	void start(const NodeId bound)
+	{
+		if(m_stamps.size()<bound)
+		{
+			m_stamps.resize(bound,0);
+		}
+		if(m_epoch>=UINT32_MAX-2)
+		{
+			//The stamps would wrap around, and stamps of old searches could be mistaken for the current one
+			std::fill(m_stamps.begin(),m_stamps.end(),0);
+			m_epoch=0;
+		}
+		m_epoch+=2;
+		m_visits.clear();
+	}
+
+	//! Stamp a node that the current search reached for the first time and queue it if it passes the filter
+	template<typename F>
+	void reach(const NodeId n,const unsigned int depth,const F& filter)
+	{
+		if(filter(n))
+		{
+			m_stamps[n]=m_epoch;
+			m_visits.push_back(Visit{n,depth});
+		}
+		else
+		{
+			m_stamps[n]=m_epoch+1;
+		}
+	}
+};
+
+}
+
+#endif // Graph_BoundedBreadthFirstSearch_H
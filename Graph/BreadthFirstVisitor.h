@@ -6,25 +6,25 @@
 namespace Graph
 {
 
-//! Template class for a depth-first visitor.
-template<typename T,template<typename> class S>
-class BreadthFirstVisitor : public GraphTravesalVisitor<T,S>
+//! Template class for a breadth-first visitor.
+template<typename T,typename G=UndirectedGraph<T>>
+class BreadthFirstVisitor : public GraphTravesalVisitor<T,G,BreadthFirstVisitor<T,G>>
 {
+	using Base=GraphTravesalVisitor<T,G,BreadthFirstVisitor<T,G>>;
 public:
-	using GraphTravesalVisitor<T,S>::GraphTravesalVisitor;
+	using GraphTravesalVisitor<T,G,BreadthFirstVisitor<T,G>>::GraphTravesalVisitor;
 private:
-	void pushNextNeighbors(const typename GraphTravesalVisitor<T,S>::Node& node) noexcept override
+	friend Base;
+
+	void pushNextNeighbors(const typename Base::Node& node) noexcept
 	{
-		const auto nextNeighbors=GraphTravesalVisitor<T,S>::m_graph.neighbors(node);
-		for(const auto& n:nextNeighbors)
+		Base::Traits::forEachNeighbor(Base::m_graph,node,[this](const typename Base::Node& n,const typename Base::NodeId id,const typename Base::EdgeWeight)
 		{
-			const auto it=GraphTravesalVisitor<T,S>::m_remaining.find(n);
-			if(it!=GraphTravesalVisitor<T,S>::m_remaining.end())
+			if(Base::visit(id))
 			{
-				GraphTravesalVisitor<T,S>::m_nodes.push_back(n);
-				GraphTravesalVisitor<T,S>::m_remaining.erase(it);
+				Base::m_nodes.push_back(n);
 			}
-		}
+		});
 	}
 };
 
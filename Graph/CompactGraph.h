@@ -0,0 +1,474 @@
+#ifndef Graph_CompactGraph_H
+#define Graph_CompactGraph_H
+
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+#include "UndirectedGraph.h"
+#include "Range.h"
+#include "ParallelFor.h"
+#include "DefaultInitAllocator.h"
+#include "Numa.h"
+
+namespace Graph
+{
+
+//! Immutable compressed sparse row (CSR) snapshot of an UndirectedGraph, for analytics that don't mutate the graph.
+//! Nodes are renumbered to the ids [0, size()), the neighbors of every node are stored contiguously and sorted by id,
+//! and edge weights are kept in an array parallel to the neighbors. Every edge is stored at both endpoints.
+//! The original node values are kept as labels.
+//! The ids may be split into partitions, contiguous id ranges whose arrays were first written by threads on a chosen
+//! NUMA node (see permuted()). balancedRanges() then never crosses a partition, and rangeNodes() tells which node a
+//! range should be processed on
+template<typename T>
+class CompactGraph
+{
+public:
+	using Label=T;
+
+	using NodeId=typename UndirectedGraph<T>::NodeId;
+
+	//! Algorithms address the nodes of a CompactGraph by id
+	using Node=NodeId;
+
+	using EdgeWeight=typename UndirectedGraph<T>::EdgeWeight;
+
+	using NodeDegree=std::size_t;
+
+	//! Index into the neighbor and weight arrays
+	using EdgeIndex=std::size_t;
+
+	//! The arrays aren't zero-filled when sized, so that the threads filling them place their pages
+	using Offsets=Concurrency::UninitializedVector<EdgeIndex>;
+
+	using Targets=Concurrency::UninitializedVector<NodeId>;
+
+	using Weights=Concurrency::UninitializedVector<EdgeWeight>;
+
+	using NeighborRange=Range<typename Targets::const_iterator>;
+
+	using WeightRange=Range<typename Weights::const_iterator>;
+
+	using NoSuchNode=typename UndirectedGraph<T>::NoSuchNode;
+
+	CompactGraph()=default;
+
+	//! Take a snapshot of a graph. The neighbor lists are filled and sorted in parallel
+	explicit CompactGraph(const UndirectedGraph<T>& graph)
+	{
+		const typename UndirectedGraph<T>::NodeView nodes=graph.nodesView();
+		m_labels.assign(nodes.begin(),nodes.end());
+		const NodeId n=m_labels.size();
+		std::vector<NodeId> remap(graph.nodeIdBound());
+		m_offsets.resize(n+1);
+		for(NodeId i=0;i<n;++i)
+		{
+			remap[graph.nodeId(m_labels[i])]=i;
+			m_offsets[i+1]=m_offsets[i]+graph.degree(m_labels[i]);
+		}
+		m_targets.resize(m_offsets.back());
+		m_weights.resize(m_offsets.back());
+		Concurrency::parallelFor(0,n,[this,&graph,&remap](const std::size_t first,const std::size_t last)
+		{
+			std::vector<std::pair<NodeId,EdgeWeight>> buffer;
+			for(std::size_t i=first;i<last;++i)
+			{
+				buffer.clear();
+				for(const auto& m:graph.neighbors(m_labels[i]))
+				{
+					buffer.push_back(std::make_pair(remap[m.id],m.weight));
+				}
+				std::sort(buffer.begin(),buffer.end());
+				EdgeIndex e=m_offsets[i];
+				for(const auto& m:buffer)
+				{
+					m_targets[e]=m.first;
+					m_weights[e++]=m.second;
+				}
+			}
+		});
+		index();
+	}
+
+	//! Build a graph directly from its arrays. The neighbors of node i are targets[offsets[i]..offsets[i+1]), sorted,
+	//! with the weights at the same positions. Every edge must be present at both endpoints with the same weight
+	CompactGraph(std::vector<Label>&& labels,Offsets&& offsets,Targets&& targets,Weights&& weights):
+		m_labels(std::move(labels)),
+		m_offsets(std::move(offsets)),
+		m_targets(std::move(targets)),
+		m_weights(std::move(weights))
+	{
+		index();
+	}
+
+	//! The number of nodes
+	NodeId size() const noexcept
+	{
+		return m_labels.size();
+	}
+
+	//! True iff there are no nodes
+	bool empty() const noexcept
+	{
+		return m_labels.empty();
+	}
+
+	//! The number of edges. Each edge is stored twice, once at each endpoint
+	EdgeIndex edgeCount() const noexcept
+	{
+		return m_targets.size()/2;
+	}
+
+	//! The degree of a node
+	NodeDegree degree(const NodeId n) const noexcept
+	{
+		return m_offsets[n+1]-m_offsets[n];
+	}
+
+	//! The neighbors of a node, sorted by id
+	NeighborRange neighbors(const NodeId n) const noexcept
+	{
+		return NeighborRange(m_targets.begin()+m_offsets[n],m_targets.begin()+m_offsets[n+1]);
+	}
+
+	//! The weights of the edges of a node, in the same order as neighbors()
+	WeightRange weights(const NodeId n) const noexcept
+	{
+		return WeightRange(m_weights.begin()+m_offsets[n],m_weights.begin()+m_offsets[n+1]);
+	}
+
+	//! Test whether an edge exists, by binary search in the neighbors of n1
+	bool isEdge(const NodeId n1,const NodeId n2) const noexcept
+	{
+		const NeighborRange r=neighbors(n1);
+		return std::binary_search(r.begin(),r.end(),n2);
+	}
+
+	/*!
+	 * \brief edgeWeight Get the weight of an edge, by binary search in the neighbors of n1
+	 * \throw typename UndirectedGraph<T>::NoSuchEdge If the edge doesn't exist
+	 */
+	EdgeWeight edgeWeight(const NodeId n1,const NodeId n2) const
+	{
+		const NeighborRange r=neighbors(n1);
+		const auto it=std::lower_bound(r.begin(),r.end(),n2);
+		if(it==r.end() or *it!=n2)
+		{
+			throw typename UndirectedGraph<T>::NoSuchEdge(m_labels[n1],m_labels[n2]);
+		}
+		return m_weights[it-m_targets.begin()];
+	}
+
+	//! The original node value of an id
+	const Label& label(const NodeId n) const noexcept
+	{
+		return m_labels[n];
+	}
+
+	/*!
+	 * \brief id Get the id of an original node value
+	 * \throw NoSuchNode If the node is not in the graph
+	 */
+	NodeId id(const Label& label) const
+	{
+		NodeId result;
+		if(not tryId(label,result))
+		{
+			throw NoSuchNode(label);
+		}
+		return result;
+	}
+
+	//! Get the id of an original node value into id. Returns false, leaving id alone, if the node is not in the graph
+	bool tryId(const Label& label,NodeId& id) const noexcept
+	{
+		const typename std::unordered_map<Label,NodeId>::const_iterator it=m_ids.find(label);
+		if(it==m_ids.end())
+		{
+			return false;
+		}
+		id=it->second;
+		return true;
+	}
+
+	//! The raw arrays, for algorithms that sweep over all edges. See the array constructor for their layout
+	const Offsets& offsets() const noexcept
+	{
+		return m_offsets;
+	}
+
+	const Targets& targets() const noexcept
+	{
+		return m_targets;
+	}
+
+	const Weights& weights() const noexcept
+	{
+		return m_weights;
+	}
+
+	const std::vector<Label>& labels() const noexcept
+	{
+		return m_labels;
+	}
+
+	//! Split the ids into contiguous ranges with about the same number of nodes plus edges each, so that threads working
+	//! on one range each get the same amount of work and touch disjoint parts of the arrays. Ranges never cross a
+	//! partition: the parts are shared out among the partitions by their amount of work, at least one each.
+	//! Range i is [result[i], result[i+1]). There are at most parts ranges, or one per non-empty partition if there are
+	//! more of those, none of them empty
+	std::vector<NodeId> balancedRanges(const unsigned int parts) const
+	{
+		std::vector<NodeId> result(1,0);
+		const std::vector<NodeId> bounds=partitions();
+		const EdgeIndex total=m_offsets.back()+size();
+		std::vector<EdgeIndex> work(bounds.size()-1),shares(bounds.size()-1,0);
+		EdgeIndex assigned=0;
+		for(std::size_t p=0;p<work.size();++p)
+		{
+			work[p]=m_offsets[bounds[p+1]]+bounds[p+1]-m_offsets[bounds[p]]-bounds[p];
+			if(work[p])
+			{
+				shares[p]=std::max<EdgeIndex>(1,EdgeIndex(parts)*work[p]/total);
+				assigned+=shares[p];
+			}
+		}
+		//The parts left over by rounding down go to the partitions with the most work per part
+		for(;assigned<parts and total;++assigned)
+		{
+			std::size_t best=0;
+			for(std::size_t p=1;p<work.size();++p)
+			{
+				if(work[p] and (not work[best] or work[p]*shares[best]>work[best]*shares[p]))
+				{
+					best=p;
+				}
+			}
+			++shares[best];
+		}
+		for(std::size_t p=0;p<work.size();++p)
+		{
+			if(work[p])
+			{
+				split(bounds[p],bounds[p+1],shares[p],result);
+			}
+		}
+		return result;
+	}
+
+	//! The partition bounds: partition p is the ids [result[p], result[p+1]). A graph that wasn't partitioned is a
+	//! single partition
+	std::vector<NodeId> partitions() const
+	{
+		return m_partitions.empty()?std::vector<NodeId>{0,size()}:m_partitions;
+	}
+
+	//! The NUMA node the arrays of every partition were placed on. Empty if they weren't placed
+	const std::vector<unsigned int>& placement() const noexcept
+	{
+		return m_placement;
+	}
+
+	//! The NUMA node to process every range of ids on, as returned by balancedRanges(): the node of the partition the
+	//! range starts in. Empty if the partitions weren't placed
+	std::vector<unsigned int> rangeNodes(const std::vector<NodeId>& ranges) const
+	{
+		std::vector<unsigned int> result;
+		if(m_placement.empty() or ranges.size()<2)
+		{
+			return result;
+		}
+		const std::vector<NodeId> bounds=partitions();
+		result.reserve(ranges.size()-1);
+		for(std::size_t i=0;i+1<ranges.size();++i)
+		{
+			result.push_back(m_placement[std::upper_bound(bounds.begin(),bounds.end(),ranges[i])-bounds.begin()-1]);
+		}
+		return result;
+	}
+
+	/*!
+	 * \brief permuted A copy of the graph with the ids renumbered: id i of the copy is id order[i] of this graph. The
+	 * copy is split into the given partitions, and with a placement the arrays of partition p are first written by
+	 * threads pinned to NUMA node placement[p], which places their pages on that node
+	 * \param partitions The partition bounds: partition p is the ids [partitions[p], partitions[p+1]) of the copy. Empty
+	 * means a single partition
+	 * \param placement The NUMA node of every partition, or empty
+	 * \throw std::invalid_argument If order is not a permutation of the ids, the bounds don't cover the ids in
+	 * increasing order, or there isn't one NUMA node per partition
+	 */
+	CompactGraph permuted(const std::vector<NodeId>& order,const std::vector<NodeId>& partitions=std::vector<NodeId>(),const std::vector<unsigned int>& placement=std::vector<unsigned int>()) const
+	{
+		const NodeId n=size();
+		if(order.size()!=n)
+		{
+			throw std::invalid_argument("Not a permutation of the ids");
+		}
+		std::vector<NodeId> position(n,n);
+		for(NodeId i=0;i<n;++i)
+		{
+			if(order[i]>=n or position[order[i]]!=n)
+			{
+				throw std::invalid_argument("Not a permutation of the ids");
+			}
+			position[order[i]]=i;
+		}
+		if(not partitions.empty() and (partitions.size()<2 or partitions.front()!=0 or partitions.back()!=n or not std::is_sorted(partitions.begin(),partitions.end())))
+		{
+			throw std::invalid_argument("The partition bounds don't cover the ids");
+		}
+		if(not placement.empty() and placement.size()+1!=std::max<std::size_t>(partitions.size(),2))
+		{
+			throw std::invalid_argument("Not one NUMA node per partition");
+		}
+		CompactGraph result;
+		result.m_partitions=partitions;
+		result.m_placement=placement;
+		result.m_labels.reserve(n);
+		for(const auto& i:order)
+		{
+			result.m_labels.push_back(m_labels[i]);
+		}
+		//Every partition is split into chunks with about the same number of nodes, which run on the partition's node
+		const std::vector<NodeId> bounds=result.partitions();
+		const NodeId threads=Concurrency::hardwareThreads();
+		std::vector<NodeId> chunks(1,0);
+		std::vector<unsigned int> nodes;
+		for(std::size_t p=0;p+1<bounds.size();++p)
+		{
+			const NodeId length=bounds[p+1]-bounds[p];
+			if(not length)
+			{
+				continue;
+			}
+			const NodeId pieces=std::max<NodeId>(1,std::min<NodeId>(length/Concurrency::s_minimumChunk,threads*std::size_t(length)/n));
+			for(NodeId k=1;k<=pieces;++k)
+			{
+				const NodeId bound=bounds[p]+length/pieces*k+std::min(k,length%pieces);
+				if(bound>chunks.back())
+				{
+					chunks.push_back(bound);
+					if(not placement.empty())
+					{
+						nodes.push_back(placement[p]);
+					}
+				}
+			}
+		}
+		//The first pass writes the offsets relative to the start of each chunk, the second one makes them absolute and
+		//fills the neighbors
+		result.m_offsets.resize(n+1);
+		std::vector<EdgeIndex> starts(chunks.size()-1);
+		Concurrency::parallelForRanges(chunks,nodes,[this,&order,&result,&starts](const std::size_t chunk,const NodeId first,const NodeId last)
+		{
+			EdgeIndex sum=0;
+			for(NodeId i=first;i<last;++i)
+			{
+				sum+=degree(order[i]);
+				result.m_offsets[i+1]=sum;
+			}
+			starts[chunk]=sum;
+		});
+		EdgeIndex total=0;
+		for(auto& s:starts)
+		{
+			const EdgeIndex length=s;
+			s=total;
+			total+=length;
+		}
+		result.m_targets.resize(total);
+		result.m_weights.resize(total);
+		Concurrency::parallelForRanges(chunks,nodes,[this,&order,&position,&result,&starts](const std::size_t chunk,const NodeId first,const NodeId last)
+		{
+			std::vector<std::pair<NodeId,EdgeWeight>> buffer;
+			EdgeIndex e=starts[chunk];
+			for(NodeId i=first;i<last;++i)
+			{
+				result.m_offsets[i+1]+=starts[chunk];
+				buffer.clear();
+				auto w=m_weights.begin()+m_offsets[order[i]];
+				for(const auto& v:neighbors(order[i]))
+				{
+					buffer.push_back(std::make_pair(position[v],*w++));
+				}
+				std::sort(buffer.begin(),buffer.end());
+				for(const auto& m:buffer)
+				{
+					result.m_targets[e]=m.first;
+					result.m_weights[e++]=m.second;
+				}
+			}
+		});
+		result.index();
+		return result;
+	}
+private:
+	//! Original node value of every id
+	std::vector<Label> m_labels;
+
+	//! The neighbors of node i start at m_offsets[i]. There is one more entry than nodes, holding the end of the last node
+	Offsets m_offsets=Offsets(1,0);
+
+	//! The neighbors of all nodes, one node after the other
+	Targets m_targets;
+
+	//! The edge weights, parallel to m_targets
+	Weights m_weights;
+
+	//! Id of every original node value
+	std::unordered_map<Label,NodeId> m_ids;
+
+	//! The partition bounds. Empty for a single partition
+	std::vector<NodeId> m_partitions;
+
+	//! The NUMA node of every partition. Empty if not placed
+	std::vector<unsigned int> m_placement;
+
+	void index()
+	{
+		m_ids.reserve(m_labels.size());
+		for(NodeId i=0;i<m_labels.size();++i)
+		{
+			m_ids.insert(std::make_pair(m_labels[i],i));
+		}
+	}
+
+	//! Append to result the bounds of about parts ranges of [first, last) with the same number of nodes plus edges each.
+	//! result ends with first
+	void split(const NodeId first,const NodeId last,const EdgeIndex parts,std::vector<NodeId>& result) const
+	{
+		const EdgeIndex base=m_offsets[first]+first;
+		const EdgeIndex total=m_offsets[last]+last-base;
+		for(EdgeIndex p=1;p<parts;++p)
+		{
+			const EdgeIndex target=base+total/parts*p+std::min<EdgeIndex>(p,total%parts);
+			NodeId low=result.back(),high=last;
+			while(low<high)
+			{
+				const NodeId middle=low+(high-low)/2;
+				if(m_offsets[middle]+middle<target)
+				{
+					low=middle+1;
+				}
+				else
+				{
+					high=middle;
+				}
+			}
+			if(low>result.back() and low<last)
+			{
+				result.push_back(low);
+			}
+		}
+		if(last>result.back())
+		{
+			result.push_back(last);
+		}
+	}
+};
+
+}
+
+#endif // Graph_CompactGraph_H
@@ -0,0 +1,393 @@
+#ifndef Graph_CompressedGraph_H
+#define Graph_CompressedGraph_H
+
+#include <vector>
+#include <cstdint>
+#include <iterator>
+#include <unordered_map>
+#include "CompactGraph.h"
+#include "Range.h"
+#include "ParallelFor.h"
+#include "DefaultInitAllocator.h"
+
+namespace Graph
+{
+
+//! Immutable compressed snapshot of a graph, for graphs that don't fit in memory as a CompactGraph. Uses the same dense
+//! ids as the CompactGraph it is built from. The adjacency of every node is one byte string of LEB128 varints: the
+//! degree, then the gaps between consecutive sorted neighbors (the first one relative to the node itself, zigzag
+//! coded since it may be negative), each followed by the edge weight unless all weights are 1. Neighbors with nearby
+//! ids, as after a Reordering, take one byte each.
+//! degree() decodes a single varint, and neighbors() decodes sequentially while iterating
+template<typename T>
+class CompressedGraph
+{
+public:
+	using Label=T;
+
+	using NodeId=typename CompactGraph<T>::NodeId;
+
+	//! Algorithms address the nodes of a CompressedGraph by id
+	using Node=NodeId;
+
+	using EdgeWeight=typename CompactGraph<T>::EdgeWeight;
+
+	using NodeDegree=std::size_t;
+
+	using EdgeIndex=std::size_t;
+
+	using NoSuchNode=typename UndirectedGraph<T>::NoSuchNode;
+
+	//! Decodes the neighbors of a node one by one. The weight of the edge to the current neighbor is weight()
+	class NeighborIterator
+	{
+	public:
+		using iterator_category=std::forward_iterator_tag;
+		using value_type=NodeId;
+		using difference_type=std::ptrdiff_t;
+		using pointer=const NodeId*;
+		using reference=const NodeId&;
+
+		NeighborIterator() noexcept:
+			m_next(nullptr),
+			m_remaining(0),
+			m_current(0),
+			m_weight(0),
+			m_weighted(false)
+		{
+		}
+
+		reference operator*() const noexcept
+		{
+			return m_current;
+		}
+
+		pointer operator->() const noexcept
+		{
+			return &m_current;
+		}
+
+		EdgeWeight weight() const noexcept
+		{
+			return m_weight;
+		}
+
+		NeighborIterator& operator++() noexcept
+		{
+			if(--m_remaining)
+			{
+				m_current+=decode(m_next)+1;
+				readWeight();
+			}
+			return *this;
+		}
+
+		NeighborIterator operator++(int) noexcept
+		{
+			const NeighborIterator result=*this;
+			++*this;
+			return result;
+		}
+
+		//! Only meaningful between iterators over the neighbors of the same node
+		bool operator==(const NeighborIterator& other) const noexcept
+		{
+			return m_remaining==other.m_remaining;
+		}
+
+		bool operator!=(const NeighborIterator& other) const noexcept
+		{
+			return not(*this==other);
+		}
+	private:
+		friend class CompressedGraph;
+
+		const unsigned char* m_next;
+
+		//! The number of neighbors left, the current one included
+		NodeDegree m_remaining;
+
+		NodeId m_current;
+
+		EdgeWeight m_weight;
+
+		bool m_weighted;
+
+		//! Start at the first of degree neighbors of node, encoded at next
+		NeighborIterator(const unsigned char* next,const NodeDegree degree,const NodeId node,const bool weighted) noexcept:
+			m_next(next),
+			m_remaining(degree),
+			m_current(0),
+			m_weight(1),
+			m_weighted(weighted)
+		{
+			if(m_remaining)
+			{
+				m_current=node+unzigzag(decode(m_next));
+				readWeight();
+			}
+		}
+
+		void readWeight() noexcept
+		{
+			if(m_weighted)
+			{
+				m_weight=decode(m_next);
+			}
+		}
+	};
+
+	using NeighborRange=Range<NeighborIterator>;
+
+	CompressedGraph()=default;
+
+	//! Compress a CompactGraph. The nodes are encoded in parallel, after a parallel pass that sizes the output exactly
+	//! \param threads The number of threads. 0 means Concurrency::hardwareThreads()
+	explicit CompressedGraph(const CompactGraph<T>& graph,const unsigned int threads=0):
+		m_labels(graph.labels()),
+		m_edgeCount(graph.edgeCount()),
+		m_weighted(false)
+	{
+		for(const auto& w:graph.weights())
+		{
+			if(w!=1)
+			{
+				m_weighted=true;
+				break;
+			}
+		}
+		const NodeId n=size();
+		m_offsets.resize(n+1);
+		m_offsets[0]=0;
+		Concurrency::parallelFor(0,n,[this,&graph](const std::size_t first,const std::size_t last)
+		{
+			for(std::size_t u=first;u<last;++u)
+			{
+				m_offsets[u+1]=encode(graph,u,nullptr);
+			}
+		},threads);
+		for(NodeId u=0;u<n;++u)
+		{
+			m_offsets[u+1]+=m_offsets[u];
+		}
+		m_bytes.resize(m_offsets.back());
+		Concurrency::parallelFor(0,n,[this,&graph](const std::size_t first,const std::size_t last)
+		{
+			for(std::size_t u=first;u<last;++u)
+			{
+				encode(graph,u,m_bytes.data()+m_offsets[u]);
+			}
+		},threads);
+		index();
+	}
+
+	//! Compress a graph through a CompactGraph snapshot
+	explicit CompressedGraph(const UndirectedGraph<T>& graph,const unsigned int threads=0):
+		CompressedGraph(CompactGraph<T>(graph),threads)
+	{
+	}
+
+	//! The number of nodes
+	NodeId size() const noexcept
+	{
+		return m_labels.size();
+	}
+
+	//! True iff there are no nodes
+	bool empty() const noexcept
+	{
+		return m_labels.empty();
+	}
+
+	//! The number of edges
+	EdgeIndex edgeCount() const noexcept
+	{
+		return m_edgeCount;
+	}
+
+	//! The degree of a node
+	NodeDegree degree(const NodeId n) const noexcept
+	{
+		const unsigned char* p=m_bytes.data()+m_offsets[n];
+		return decode(p);
+	}
+
+	//! The neighbors of a node, sorted by id
+	NeighborRange neighbors(const NodeId n) const noexcept
+	{
+		const unsigned char* p=m_bytes.data()+m_offsets[n];
+		const NodeDegree d=decode(p);
+		return NeighborRange(NeighborIterator(p,d,n,m_weighted),NeighborIterator());
+	}
+
+	//! Test whether an edge exists, by decoding the neighbors of n1 up to n2
+	bool isEdge(const NodeId n1,const NodeId n2) const noexcept
+	{
+		const NeighborIterator it=find(n1,n2);
+		return it!=NeighborIterator() and *it==n2;
+	}
+
+	/*!
+	 * \brief edgeWeight Get the weight of an edge, by decoding the neighbors of n1 up to n2
+	 * \throw typename UndirectedGraph<T>::NoSuchEdge If the edge doesn't exist
+	 */
+	EdgeWeight edgeWeight(const NodeId n1,const NodeId n2) const
+	{
+		const NeighborIterator it=find(n1,n2);
+		if(it==NeighborIterator() or *it!=n2)
+		{
+			throw typename UndirectedGraph<T>::NoSuchEdge(m_labels[n1],m_labels[n2]);
+		}
+		return it.weight();
+	}
+
+	//! The original node value of an id
+	const Label& label(const NodeId n) const noexcept
+	{
+		return m_labels[n];
+	}
+
+	/*!
+	 * \brief id Get the id of an original node value
+	 * \throw NoSuchNode If the node is not in the graph
+	 */
+	NodeId id(const Label& label) const
+	{
+		NodeId result;
+		if(not tryId(label,result))
+		{
+			throw NoSuchNode(label);
+		}
+		return result;
+	}
+
+	//! Get the id of an original node value into id. Returns false, leaving id alone, if the node is not in the graph
+	bool tryId(const Label& label,NodeId& id) const noexcept
+	{
+		const typename std::unordered_map<Label,NodeId>::const_iterator it=m_ids.find(label);
+		if(it==m_ids.end())
+		{
+			return false;
+		}
+		id=it->second;
+		return true;
+	}
+
+	const std::vector<Label>& labels() const noexcept
+	{
+		return m_labels;
+	}
+
+	//! The memory taken by the adjacency: the encoded bytes and the offset of every node
+	std::size_t bytes() const noexcept
+	{
+		return m_bytes.size()+m_offsets.size()*sizeof(EdgeIndex);
+	}
+private:
+	//! Original node value of every id
+	std::vector<Label> m_labels;
+
+	//! The encoding of node i starts at m_offsets[i]. There is one more entry than nodes
+	Concurrency::UninitializedVector<EdgeIndex> m_offsets=Concurrency::UninitializedVector<EdgeIndex>(1,0);
+
+	//! The encodings of all nodes, one node after the other
+	Concurrency::UninitializedVector<unsigned char> m_bytes;
+
+	EdgeIndex m_edgeCount=0;
+
+	//! False if all the weights are 1 and not stored
+	bool m_weighted=false;
+
+	//! Id of every original node value
+	std::unordered_map<Label,NodeId> m_ids;
+
+	void index()
+	{
+		m_ids.reserve(m_labels.size());
+		for(NodeId i=0;i<m_labels.size();++i)
+		{
+			m_ids.insert(std::make_pair(m_labels[i],i));
+		}
+	}
+
+	//! The first neighbor of n1 that is not below n2, or the end
+	NeighborIterator find(const NodeId n1,const NodeId n2) const noexcept
+	{
+		NeighborIterator it=neighbors(n1).begin();
+		while(it!=NeighborIterator() and *it<n2)
+		{
+			++it;
+		}
+		return it;
+	}
+
+	//! Write the encoding of node u of graph to out, or only measure it if out is null. Returns its length in bytes
+	std::size_t encode(const CompactGraph<T>& graph,const NodeId u,unsigned char* out) const noexcept
+	{
+		std::size_t length=put(graph.degree(u),out);
+		auto w=graph.weights(u).begin();
+		bool first=true;
+		NodeId previous=0;
+		for(const auto& v:graph.neighbors(u))
+		{
+			length+=put(first?zigzag(std::int64_t(v)-std::int64_t(u)):v-previous-1,out?out+length:nullptr);
+			if(m_weighted)
+			{
+				length+=put(*w,out?out+length:nullptr);
+			}
+			++w;
+			first=false;
+			previous=v;
+		}
+		return length;
+	}
+
+	//! Write a varint to out unless it is null. Returns its length in bytes
+	static std::size_t put(std::uint64_t value,unsigned char* out) noexcept
+	{
+		std::size_t length=1;
+		for(;value>=0x80;value>>=7,++length)
+		{
+			if(out)
+			{
+				*out++=(value&0x7f)|0x80;
+			}
+		}
+		if(out)
+		{
+			*out=value;
+		}
+		return length;
+	}
+
+	//! Read a varint and move p past it
+	static std::uint64_t decode(const unsigned char*& p) noexcept
+	{
+		if(*p<0x80)
+		{
+			return *p++;
+		}
+		std::uint64_t result=0;
+		unsigned int shift=0;
+		while(*p&0x80)
+		{
+			result|=std::uint64_t(*p++&0x7f)<<shift;
+			shift+=7;
+		}
+		return result|std::uint64_t(*p++)<<shift;
+	}
+
+	static std::uint64_t zigzag(const std::int64_t value) noexcept
+	{
+		return value<0?2*std::uint64_t(-value)-1:2*std::uint64_t(value);
+	}
+
+	static std::int64_t unzigzag(const std::uint64_t value) noexcept
+	{
+		return value&1?-std::int64_t(value>>1)-1:std::int64_t(value>>1);
+	}
+};
+
+}
+
+#endif // Graph_CompressedGraph_H
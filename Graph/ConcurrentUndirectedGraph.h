@@ -0,0 +1,443 @@
+#ifndef Graph_ConcurrentUndirectedGraph_H
+#define Graph_ConcurrentUndirectedGraph_H
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include "UndirectedGraph.h"
+
+namespace Graph
+{
+
+//! Undirected graph that many threads can mutate and query at once. Nodes are partitioned by hash into shards, each with
+//! its own lock, so operations on nodes of different shards run in parallel. An operation on an edge locks the shards of
+//! both endpoints, always in increasing shard order so that two threads can't deadlock, and updates both adjacency lists
+//! while holding both locks; every edge operation is therefore atomic. Removing a node locks the shards of the node and
+//! of all its neighbors.
+//! The API follows UndirectedGraph and throws its exceptions. Queries return copies, because the graph can change as
+//! soon as the locks are released. Use graph() to take a consistent UndirectedGraph copy of the whole graph
+template<typename T>
+class ConcurrentUndirectedGraph
+{
+public:
+	using Node=T;
+
+	using EdgeWeight=typename UndirectedGraph<T>::EdgeWeight;
+
+	using NodeSet=typename UndirectedGraph<T>::NodeSet;
+
+	//! Only the node and weight of the entries are meaningful
+	using AdjacencyList=typename UndirectedGraph<T>::AdjacencyList;
+
+	using NodeDegree=typename UndirectedGraph<T>::NodeDegree;
+
+	using GraphSize=std::size_t;
+
+	using NoSuchNode=typename UndirectedGraph<T>::NoSuchNode;
+
+	using NoSuchEdge=typename UndirectedGraph<T>::NoSuchEdge;
+
+	using EdgeExists=typename UndirectedGraph<T>::EdgeExists;
+
+	using TrivialEdge=typename UndirectedGraph<T>::TrivialEdge;
+
+	using ZeroWeightEdge=typename UndirectedGraph<T>::ZeroWeightEdge;
+
+	//! \param shards The number of shards. 0 means 4 per hardware thread
+	explicit ConcurrentUndirectedGraph(const unsigned int shards=0):
+		m_shards(shards?shards:4*Concurrency::hardwareThreads()),
+		m_size(0),
+		m_edges(0)
+	{
+		for(auto& s:m_shards)
+		{
+			s.reset(new Shard);
+		}
+	}
+
+	ConcurrentUndirectedGraph(const ConcurrentUndirectedGraph&)=delete;
+
+	ConcurrentUndirectedGraph& operator=(const ConcurrentUndirectedGraph&)=delete;
+
+	//! The number of nodes. Exact when no thread is mutating the graph
+	GraphSize size() const noexcept
+	{
+		return m_size;
+	}
+
+	bool empty() const noexcept
+	{
+		return not m_size;
+	}
+
+	//! The number of edges. Exact when no thread is mutating the graph
+	std::size_t edgeCount() const noexcept
+	{
+		return m_edges;
+	}
+
+	//! Whether a node is in the graph
+	bool contains(const Node& node) const
+	{
+		const Shard& s=shard(node);
+		const std::lock_guard<std::mutex> lock(s.mutex);
+		return s.nodes.find(node)!=s.nodes.end();
+	}
+
+	/*!
+	 * \brief degree Get the degree of a node
+	 * \throw NoSuchNode If the node doesn't belong to the graph
+	 */
+	NodeDegree degree(const Node& node) const
+	{
+		const Shard& s=shard(node);
+		const std::lock_guard<std::mutex> lock(s.mutex);
+		return find(s,node).size();
+	}
+
+	/*!
+	 * \brief neighbors Get a copy of the neighbors of a node
+	 * \throw NoSuchNode If the node doesn't belong to the graph
+	 */
+	AdjacencyList neighbors(const Node& node) const
+	{
+		const Shard& s=shard(node);
+		const std::lock_guard<std::mutex> lock(s.mutex);
+		return find(s,node);
+	}
+
+	/*!
+	 * \brief isEdge Test whether an edge between two nodes exists
+	 * \throw NoSuchNode If one of the nodes doesn't belong to the graph
+	 */
+	bool isEdge(const Node& n1,const Node& n2) const
+	{
+		const PairLock lock(*this,n1,n2);
+		const AdjacencyList& l=find(shard(n1),n1);
+		find(shard(n2),n2);
+		return l.find(n2)!=l.end();
+	}
+
+	/*!
+	 * \brief edgeWeight Get the weight of an edge
+	 * \throw NoSuchNode If one of the nodes doesn't belong to the graph
+	 * \throw NoSuchEdge If the edge doesn't exist
+	 */
+	EdgeWeight edgeWeight(const Node& n1,const Node& n2) const
+	{
+		const PairLock lock(*this,n1,n2);
+		const AdjacencyList& l=find(shard(n1),n1);
+		find(shard(n2),n2);
+		const typename AdjacencyList::const_iterator it=l.find(n2);
+		if(it==l.end())
+		{
+			throw NoSuchEdge(n1,n2);
+		}
+		return it->weight;
+	}
+
+	//! Insert a node without neighbors. Nothing happens if it exists
+	void insert(const Node& node)
+	{
+		Shard& s=shard(node);
+		const std::lock_guard<std::mutex> lock(s.mutex);
+		insertNode(s,node);
+	}
+
+	/*!
+	 * \brief insert Insert a node with a set of neighbors, like UndirectedGraph::insert(). If the node exists, the new
+	 * neighbors are merged with the existing ones and existing edges keep their weight. Missing neighbors are added.
+	 * Every edge is added atomically, but other threads can see the node before all its edges are added
+	 * \throw TrivialEdge If node is in neighbors
+	 * \throw ZeroWeightEdge If an edge has weight 0
+	 */
+	void insert(const Node& node,const AdjacencyList& neighbors)
+	{
+		if(neighbors.find(node)!=neighbors.end())
+		{
+			throw TrivialEdge(node);
+		}
+		for(const auto& n:neighbors)
+		{
+			if(not n.weight)
+			{
+				throw ZeroWeightEdge(node,n.node);
+			}
+		}
+		insert(node);
+		for(const auto& n:neighbors)
+		{
+			const PairLock lock(*this,node,n.node);
+			AdjacencyList& l=insertNode(shard(node),node);
+			if(l.find(n.node)==l.end())
+			{
+				l.insert({n.node,n.weight});
+				insertNode(shard(n.node),n.node).insert({node,n.weight});
+				++m_edges;
+			}
+		}
+	}
+
+	/*!
+	 * \brief edge Add a new edge between two existing nodes
+	 * \throw TrivialEdge If n1==n2
+	 * \throw ZeroWeightEdge If the weight is 0
+	 * \throw NoSuchNode If one of the nodes doesn't belong to the graph
+	 * \throw EdgeExists If there is already an edge between n1 and n2
+	 */
+	void edge(const Node& n1,const Node& n2,const EdgeWeight weight=1)
+	{
+		if(n1==n2)
+		{
+			throw TrivialEdge(n1);
+		}
+		if(not weight)
+		{
+			throw ZeroWeightEdge(n1,n2);
+		}
+		const PairLock lock(*this,n1,n2);
+		AdjacencyList& l1=find(shard(n1),n1);
+		AdjacencyList& l2=find(shard(n2),n2);
+		if(not l1.insert({n2,weight}).second)
+		{
+			throw EdgeExists(n1,n2);
+		}
+		l2.insert({n1,weight});
+		++m_edges;
+	}
+
+	/*!
+	 * \brief setWeight Set the weight of an existing edge
+	 * \throw TrivialEdge If n1==n2
+	 * \throw ZeroWeightEdge If the weight is 0
+	 * \throw NoSuchNode If one of the nodes doesn't belong to the graph
+	 * \throw NoSuchEdge If there is no edge between n1 and n2
+	 */
+	void setWeight(const Node& n1,const Node& n2,const EdgeWeight weight)
+	{
+		if(n1==n2)
+		{
+			throw TrivialEdge(n1);
+		}
+		if(not weight)
+		{
+			throw ZeroWeightEdge(n1,n2);
+		}
+		const PairLock lock(*this,n1,n2);
+		AdjacencyList& l1=find(shard(n1),n1);
+		AdjacencyList& l2=find(shard(n2),n2);
+		const typename AdjacencyList::iterator it=l1.find(n2);
+		if(it==l1.end())
+		{
+			throw NoSuchEdge(n1,n2);
+		}
+		it->weight=l2.find(n1)->weight=weight;
+	}
+
+	/*!
+	 * \brief remove Remove an existing edge
+	 * \throw TrivialEdge If n1==n2
+	 * \throw NoSuchNode If one of the nodes doesn't belong to the graph
+	 * \throw NoSuchEdge If there is no edge between n1 and n2
+	 */
+	void remove(const Node& n1,const Node& n2)
+	{
+		if(n1==n2)
+		{
+			throw TrivialEdge(n1);
+		}
+		const PairLock lock(*this,n1,n2);
+		AdjacencyList& l1=find(shard(n1),n1);
+		AdjacencyList& l2=find(shard(n2),n2);
+		if(not l1.erase(n2))
+		{
+			throw NoSuchEdge(n1,n2);
+		}
+		l2.erase(n1);
+		--m_edges;
+	}
+
+	/*!
+	 * \brief remove Remove a node and its edges. The shards of the node and its neighbors are locked together; if the
+	 * neighbors change while the locks are being taken, it tries again
+	 * \throw NoSuchNode If the node doesn't belong to the graph
+	 */
+	void remove(const Node& node)
+	{
+		while(true)
+		{
+			std::vector<std::size_t> shards(1,shardIndex(node));
+			{
+				const Shard& s=*m_shards[shards.front()];
+				const std::lock_guard<std::mutex> lock(s.mutex);
+				for(const auto& n:find(s,node))
+				{
+					shards.push_back(shardIndex(n.node));
+				}
+			}
+			std::sort(shards.begin(),shards.end());
+			shards.erase(std::unique(shards.begin(),shards.end()),shards.end());
+			std::vector<std::unique_lock<std::mutex>> locks;
+			locks.reserve(shards.size());
+			for(const auto& i:shards)
+			{
+				locks.emplace_back(m_shards[i]->mutex);
+			}
+			Shard& s=shard(node);
+			const typename Container::iterator it=s.nodes.find(node);
+			if(it==s.nodes.end())
+			{
+				throw NoSuchNode(node);
+			}
+			const bool covered=std::all_of(it->second.begin(),it->second.end(),[this,&shards](const typename AdjacencyList::value_type& n)
+			{
+				return std::binary_search(shards.begin(),shards.end(),shardIndex(n.node));
+			});
+			if(not covered)
+			{
+				continue;
+			}
+			for(const auto& n:it->second)
+			{
+				shard(n.node).nodes.find(n.node)->second.erase(node);
+			}
+			m_edges-=it->second.size();
+			s.nodes.erase(it);
+			--m_size;
+			return;
+		}
+	}
+
+	//! A copy of all the nodes
+	NodeSet nodes() const
+	{
+		NodeSet result;
+		for(const auto& s:m_shards)
+		{
+			const std::lock_guard<std::mutex> lock(s->mutex);
+			for(const auto& n:s->nodes)
+			{
+				result.insert(n.first);
+			}
+		}
+		return result;
+	}
+
+	//! A consistent copy of the whole graph, taken while holding all the locks
+	UndirectedGraph<T> graph() const
+	{
+		std::vector<std::unique_lock<std::mutex>> locks;
+		locks.reserve(m_shards.size());
+		for(const auto& s:m_shards)
+		{
+			locks.emplace_back(s->mutex);
+		}
+		UndirectedGraph<T> result;
+		for(const auto& s:m_shards)
+		{
+			for(const auto& n:s->nodes)
+			{
+				result.insert(n.first,n.second);
+			}
+		}
+		return result;
+	}
+private:
+	using Container=std::unordered_map<Node,AdjacencyList>;
+
+	//! Shards are allocated separately, so that the locks of different shards don't share a cache line
+	struct Shard
+	{
+		mutable std::mutex mutex;
+
+		Container nodes;
+	};
+
+	//! Locks the shards of two nodes in increasing order, or a single shard if they're the same
+	class PairLock
+	{
+	public:
+		PairLock(const ConcurrentUndirectedGraph& graph,const Node& n1,const Node& n2):
+			m_first(*graph.m_shards[std::min(graph.shardIndex(n1),graph.shardIndex(n2))]),
+			m_second(*graph.m_shards[std::max(graph.shardIndex(n1),graph.shardIndex(n2))])
+		{
+			m_first.mutex.lock();
+			if(&m_second!=&m_first)
+			{
+				m_second.mutex.lock();
+			}
+		}
+
+		PairLock(const PairLock&)=delete;
+
+		PairLock& operator=(const PairLock&)=delete;
+
+		~PairLock() noexcept
+		{
+			if(&m_second!=&m_first)
+			{
+				m_second.mutex.unlock();
+			}
+			m_first.mutex.unlock();
+		}
+	private:
+		const Shard& m_first;
+
+		const Shard& m_second;
+	};
+
+	std::vector<std::unique_ptr<Shard>> m_shards;
+
+	std::atomic<GraphSize> m_size;
+
+	std::atomic<std::size_t> m_edges;
+
+	std::size_t shardIndex(const Node& node) const noexcept
+	{
+		return std::hash<Node>()(node)%m_shards.size();
+	}
+
+	Shard& shard(const Node& node) const noexcept
+	{
+		return *m_shards[shardIndex(node)];
+	}
+
+	//! Find a node in its shard, whose lock must be held, or throw NoSuchNode
+	static AdjacencyList& find(Shard& s,const Node& node)
+	{
+		const typename Container::iterator it=s.nodes.find(node);
+		if(it==s.nodes.end())
+		{
+			throw NoSuchNode(node);
+		}
+		return it->second;
+	}
+
+	static const AdjacencyList& find(const Shard& s,const Node& node)
+	{
+		const typename Container::const_iterator it=s.nodes.find(node);
+		if(it==s.nodes.end())
+		{
+			throw NoSuchNode(node);
+		}
+		return it->second;
+	}
+
+	//! Get the adjacency list of a node in its shard, whose lock must be held, inserting the node if it doesn't exist
+	AdjacencyList& insertNode(Shard& s,const Node& node)
+	{
+		const std::pair<typename Container::iterator,bool> r=s.nodes.insert(std::make_pair(node,AdjacencyList()));
+		if(r.second)
+		{
+			++m_size;
+		}
+		return r.first->second;
+	}
+};
+
+}
+
+#endif // Graph_ConcurrentUndirectedGraph_H
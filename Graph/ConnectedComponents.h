@@ -0,0 +1,88 @@
+#ifndef Graph_ConnectedComponents_H
+#define Graph_ConnectedComponents_H
+
+#include <vector>
+#include "UndirectedGraph.h"
+#include "GraphTraits.h"
+
+namespace Graph
+{
+
+//! The connected components of any graph with GraphTraits, such as UndirectedGraph, CompactGraph or CompressedGraph,
+//! by breadth-first search over the node ids. Components are numbered in the order of their smallest id
+template<typename T,typename G=UndirectedGraph<T>>
+class ConnectedComponents
+{
+	using Traits=GraphTraits<G>;
+public:
+	using NodeId=typename Traits::NodeId;
+
+	using ConnectedComponentSet=typename UndirectedGraph<T>::ConnectedComponentSet;
+
+	explicit ConnectedComponents(const G& graph) noexcept:
+		m_graph(graph)
+	{
+	}
+
+	//! The components, as sets of node values
+	ConnectedComponentSet operator()() const
+	{
+		NodeId count=0;
+		const std::vector<NodeId> m=membership(count);
+		ConnectedComponentSet result(count);
+		for(NodeId u=0;u<m.size();++u)
+		{
+			if(m[u]<count)
+			{
+				result[m[u]].insert(Traits::label(m_graph,Traits::node(m_graph,u)));
+			}
+		}
+		return result;
+	}
+
+	//! The component number of every node id. Ids that don't belong to a node get the number of components, which is
+	//! also stored in count
+	std::vector<NodeId> membership(NodeId& count) const
+	{
+		const NodeId n=Traits::idBound(m_graph);
+		std::vector<NodeId> result(n,n);
+		std::vector<NodeId> queue;
+		queue.reserve(n);
+		count=0;
+		for(NodeId u=0;u<n;++u)
+		{
+			if(result[u]!=n or not Traits::isNode(m_graph,u))
+			{
+				continue;
+			}
+			result[u]=count;
+			queue.push_back(u);
+			for(std::size_t next=queue.size()-1;next<queue.size();++next)
+			{
+				Traits::forEachNeighbor(m_graph,Traits::node(m_graph,queue[next]),[&result,&queue,n,count](const typename Traits::Node&,const NodeId v,const typename Traits::EdgeWeight)
+				{
+					if(result[v]==n)
+					{
+						result[v]=count;
+						queue.push_back(v);
+					}
+				});
+			}
+			++count;
+		}
+		for(auto& c:result)
+		{
+			if(c==n)
+			{
+				c=count;
+			}
+		}
+		return result;
+	}
+private:
+	const G& m_graph;
+};
+
+}
+
+#endif // Graph_ConnectedComponents_H
@@ -0,0 +1,272 @@
+#ifndef Graph_DegreeBuckets_H
+#define Graph_DegreeBuckets_H
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include "UndirectedGraph.h"
+#include "GraphObserver.h"
+
+namespace Graph
+{
+
+//! Observer that keeps the nodes of a graph in one doubly linked list per degree, linked by node id, so that the
+//! extreme degrees, the nodes of a degree and the degree histogram are available without scanning the graph. Every
+//! inserted or removed edge moves its two endpoints to the neighboring bucket in O(1), plus the id lookups
+template<typename T>
+class DegreeBuckets:public GraphObserver<DegreeBuckets<T>>
+{
+public:
+	using NodeId=typename GraphTypes<T>::NodeId;
+
+	using NodeDegree=typename GraphTypes<T>::NodeDegree;
+
+	using NodeSet=typename GraphTypes<T>::NodeSet;
+
+	//! The number of nodes of every degree, from 0 to maxDegree()
+	using Histogram=std::vector<std::size_t>;
+
+	template<typename G>
+	void nodeInserted(const G& graph,const T& node)
+	{
+		const NodeId id=graph.nodeId(node);
+		if(id<m_labels.size())
+		{
+			m_labels[id]=node;
+		}
+		else
+		{
+			m_labels.push_back(node);
+			m_degrees.push_back(0);
+			m_previous.push_back(s_none);
+			m_next.push_back(s_none);
+		}
+		link(id,0);
+		++m_size;
+		m_minDegree=0;
+	}
+
+	template<typename G>
+	void edgeInserted(const G& graph,const T& n1,const T& n2,const typename G::EdgeWeight)
+	{
+		increment(graph.nodeId(n1));
+		increment(graph.nodeId(n2));
+	}
+
+	template<typename G>
+	void edgeRemoved(const G& graph,const T& n1,const T& n2,const typename G::EdgeWeight)
+	{
+		decrement(graph.nodeId(n1));
+		decrement(graph.nodeId(n2));
+	}
+
+	template<typename G>
+	void nodeRemoved(const G& graph,const T& node)
+	{
+		unlink(graph.nodeId(node));
+		if(not --m_size)
+		{
+			m_minDegree=m_maxDegree=0;
+			return;
+		}
+		while(not m_histogram[m_minDegree])
+		{
+			++m_minDegree;
+		}
+		while(not m_histogram[m_maxDegree])
+		{
+			--m_maxDegree;
+		}
+	}
+
+	/*!
+	 * \brief validate Check that every node is in the bucket of its degree, that the buckets hold exactly the nodes of
+	 * the graph and that the histogram and the extreme degrees match them
+	 * \throw CorruptedGraph On the first inconsistency found
+	 */
+	template<typename G>
+	void validate(const G& graph) const
+	{
+		std::size_t count=0;
+		NodeDegree minDegree=0;
+		NodeDegree maxDegree=0;
+		for(NodeDegree d=0;d<m_heads.size();++d)
+		{
+			std::size_t bucket=0;
+			for(NodeId id=m_heads[d],previous=s_none;id!=s_none;previous=id,id=m_next[id])
+			{
+				if(not graph.isNodeId(id) or not (graph.node(id)==m_labels[id]) or m_previous[id]!=previous)
+				{
+					throw typename G::CorruptedGraph("The degree buckets are not linked to the nodes of the graph");
+				}
+				if(m_degrees[id]!=d or graph.degree(m_labels[id])!=d)
+				{
+					std::stringstream ss;
+					ss<<"Node "<<m_labels[id]<<" is in the bucket of degree "<<d<<" but has degree "<<graph.degree(m_labels[id]);
+					throw typename G::CorruptedGraph(ss.str());
+				}
+				++bucket;
+			}
+			if(bucket!=m_histogram[d])
+			{
+				throw typename G::CorruptedGraph("The degree histogram doesn't match the buckets");
+			}
+			if(bucket)
+			{
+				minDegree=count?minDegree:d;
+				maxDegree=d;
+			}
+			count+=bucket;
+		}
+		if(count!=graph.size() or m_size!=graph.size())
+		{
+			throw typename G::CorruptedGraph("The degree buckets don't hold exactly the nodes of the graph");
+		}
+		if(minDegree!=m_minDegree or maxDegree!=m_maxDegree)
+		{
+			throw typename G::CorruptedGraph("The extreme degrees don't match the buckets");
+		}
+	}
+
+	//! The largest degree, 0 for an empty graph
+	NodeDegree maxDegree() const noexcept
+	{
+		return m_maxDegree;
+	}
+
+	//! The smallest degree, 0 for an empty graph
+	NodeDegree minDegree() const noexcept
+	{
+		return m_minDegree;
+	}
+
+	//! The nodes of a degree, in O(their number)
+	NodeSet nodesWithDegree(const NodeDegree d) const
+	{
+		NodeSet result;
+		if(d<m_heads.size())
+		{
+			result.reserve(m_histogram[d]);
+			for(NodeId id=m_heads[d];id!=s_none;id=m_next[id])
+			{
+				result.insert(m_labels[id]);
+			}
+		}
+		return result;
+	}
+
+	//! The k nodes with the largest degrees, largest first, in O(k+maxDegree()). Ties come in no particular order
+	std::vector<T> topKByDegree(const std::size_t k) const
+	{
+		std::vector<T> result;
+		result.reserve(std::min(k,m_size));
+		for(NodeDegree d=m_size?m_maxDegree+1:0;d-->0 and result.size()<k;)
+		{
+			for(NodeId id=m_heads[d];id!=s_none and result.size()<k;id=m_next[id])
+			{
+				result.push_back(m_labels[id]);
+			}
+		}
+		return result;
+	}
+
+	//! The number of nodes of every degree, empty for an empty graph
+	Histogram histogram() const
+	{
+		return m_size?Histogram(m_histogram.begin(),m_histogram.begin()+m_maxDegree+1):Histogram();
+	}
+private:
+	//! The end of a bucket list
+	static const NodeId s_none=std::numeric_limits<NodeId>::max();
+
+	//! The node of every id seen so far. Ids of removed nodes keep their old label until they are handed out again
+	std::vector<T> m_labels;
+
+	//! The degree of every node id
+	std::vector<NodeDegree> m_degrees;
+
+	//! The links of the bucket lists, by node id
+	std::vector<NodeId> m_previous;
+
+	std::vector<NodeId> m_next;
+
+	//! The first node id of every degree's bucket
+	std::vector<NodeId> m_heads;
+
+	//! The number of nodes in every bucket
+	Histogram m_histogram;
+
+	std::size_t m_size=0;
+
+	NodeDegree m_minDegree=0;
+
+	NodeDegree m_maxDegree=0;
+
+	void link(const NodeId id,const NodeDegree d)
+	{
+		if(d==m_heads.size())
+		{
+			m_heads.push_back(s_none);
+			m_histogram.push_back(0);
+		}
+		m_degrees[id]=d;
+		m_previous[id]=s_none;
+		m_next[id]=m_heads[d];
+		if(m_heads[d]!=s_none)
+		{
+			m_previous[m_heads[d]]=id;
+		}
+		m_heads[d]=id;
+		++m_histogram[d];
+	}
+
+	void unlink(const NodeId id) noexcept
+	{
+		const NodeDegree d=m_degrees[id];
+		if(m_previous[id]==s_none)
+		{
+			m_heads[d]=m_next[id];
+		}
+		else
+		{
+			m_next[m_previous[id]]=m_next[id];
+		}
+		if(m_next[id]!=s_none)
+		{
+			m_previous[m_next[id]]=m_previous[id];
+		}
+		--m_histogram[d];
+	}
+
+	void increment(const NodeId id)
+	{
+		const NodeDegree d=m_degrees[id];
+		unlink(id);
+		link(id,d+1);
+		m_maxDegree=std::max(m_maxDegree,d+1);
+		if(d==m_minDegree and not m_histogram[d])
+		{
+			m_minDegree=d+1;
+		}
+	}
+
+	void decrement(const NodeId id)
+	{
+		const NodeDegree d=m_degrees[id];
+		unlink(id);
+		link(id,d-1);
+		m_minDegree=std::min(m_minDegree,d-1);
+		if(d==m_maxDegree and not m_histogram[d])
+		{
+			m_maxDegree=d-1;
+		}
+	}
+};
+
+template<typename T>
+const typename DegreeBuckets<T>::NodeId DegreeBuckets<T>::s_none;
+
+}
+
+#endif // Graph_DegreeBuckets_H
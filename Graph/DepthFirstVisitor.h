@@ -1,35 +1,37 @@
 #ifndef Graph_DepthFirstVisitor_H
 #define Graph_DepthFirstVisitor_H
 
+#include <utility>
 #include "GraphTraversalVisitor.h"
 
 namespace Graph
 {
 
 //! Template class for a depth-first visitor.
-template<typename T,template<typename> class S>
-class DepthFirstVisitor : public GraphTravesalVisitor<T,S>
+template<typename T,typename G=UndirectedGraph<T>>
+class DepthFirstVisitor : public GraphTravesalVisitor<T,G,DepthFirstVisitor<T,G>>
 {
+	using Base=GraphTravesalVisitor<T,G,DepthFirstVisitor<T,G>>;
 public:
-	using GraphTravesalVisitor<T,S>::GraphTravesalVisitor;
+	using GraphTravesalVisitor<T,G,DepthFirstVisitor<T,G>>::GraphTravesalVisitor;
 private:
-	typename GraphTravesalVisitor<T,S>::NodeList m_stack;
+	friend Base;
 
-	void pushNextNeighbors(const typename GraphTravesalVisitor<T,S>::Node& node) noexcept override
+	//! The neighbors still to try, with their ids
+	std::list<std::pair<typename Base::Node,typename Base::NodeId>> m_stack;
+
+	void pushNextNeighbors(const typename Base::Node& node) noexcept
 	{
-		const auto nextNeighbors=GraphTravesalVisitor<T,S>::m_graph.neighbors(node);
-		for(const auto& n:nextNeighbors)
+		Base::Traits::forEachNeighbor(Base::m_graph,node,[this](const typename Base::Node& n,const typename Base::NodeId id,const typename Base::EdgeWeight)
 		{
-				m_stack.push_front(n);
-		}
+			m_stack.push_front(std::make_pair(n,id));
+		});
 		for(bool done=false;not done and not m_stack.empty();)
 		{
 			const auto& n = m_stack.front();
-			const auto it=GraphTravesalVisitor<T,S>::m_remaining.find(n);
-			if(it!=GraphTravesalVisitor<T,S>::m_remaining.end())
+			if(Base::visit(n.second))
 			{
-				GraphTravesalVisitor<T,S>::m_remaining.erase(it);
-				GraphTravesalVisitor<T,S>::m_nodes.push_back(n);
+				Base::m_nodes.push_back(n.first);
 				done=true;
 			}
 			m_stack.pop_front();
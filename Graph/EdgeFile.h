@@ -0,0 +1,415 @@
+#ifndef Graph_EdgeFile_H
+#define Graph_EdgeFile_H
+
+#include <new>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+#include "CompactGraph.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#else
+#error "EdgeFile.h needs POSIX file I/O (open, pread, pwrite and fstat), which this platform doesn't provide"
+#endif
+
+namespace Graph
+{
+
+//! The on-disk edge list that the semi-external algorithms stream, for graphs larger than memory: a 24 byte header
+//! (the magic "UTLEDGES", the id bound and the edge count, both 64-bit) followed by every edge once as two 32-bit dense
+//! ids, all in host byte order
+struct EdgeFile
+{
+	using NodeId=unsigned int;
+
+	struct Edge
+	{
+		NodeId first;
+
+		NodeId second;
+	};
+
+	static const std::size_t s_headerSize=24;
+
+	//! Large enough for the disk to stream at full speed, and a multiple of the O_DIRECT alignment
+	static const std::size_t s_defaultBlockSize=std::size_t(4)<<20;
+
+	static const std::size_t s_alignment=4096;
+
+	static const char* magic() noexcept
+	{
+		return "UTLEDGES";
+	}
+};
+
+//! Writes an edge file sequentially, buffering a block of edges at a time. The header is written by close()
+class EdgeFileWriter
+{
+public:
+	using NodeId=EdgeFile::NodeId;
+
+	/*!
+	 * \brief EdgeFileWriter Create or truncate an edge file
+	 * \param nodeBound The id bound to record if no edge has a larger id, to account for isolated nodes
+	 * \throw std::system_error If the file can't be created
+	 */
+	explicit EdgeFileWriter(const std::string& path,const NodeId nodeBound=0,const std::size_t blockSize=EdgeFile::s_defaultBlockSize):
+		m_fd(::open(path.c_str(),O_WRONLY|O_CREAT|O_TRUNC,0644)),
+		m_nodeBound(nodeBound),
+		m_edgeCount(0),
+		m_blockEdges(std::max<std::size_t>(1,blockSize/sizeof(EdgeFile::Edge)))
+	{
+		if(m_fd<0)
+		{
+			throw std::system_error(errno,std::generic_category(),"Can't create "+path);
+		}
+		m_buffer.reserve(m_blockEdges);
+	}
+
+	EdgeFileWriter(const EdgeFileWriter&)=delete;
+
+	EdgeFileWriter& operator=(const EdgeFileWriter&)=delete;
+
+	//! Closes the file if close() wasn't called. Errors are lost; call close() to see them
+	~EdgeFileWriter() noexcept
+	{
+		if(m_fd>=0)
+		{
+			try
+			{
+				close();
+			}
+			catch(...)
+			{
+			}
+		}
+	}
+
+	/*!
+	 * \brief add Append an edge
+	 * \throw std::system_error If writing fails
+	 */
+	void add(const NodeId n1,const NodeId n2)
+	{
+		m_buffer.push_back(EdgeFile::Edge{n1,n2});
+		m_nodeBound=std::max(m_nodeBound,std::max(n1,n2)+1);
+		++m_edgeCount;
+		if(m_buffer.size()==m_blockEdges)
+		{
+			flush();
+		}
+	}
+
+	/*!
+	 * \brief close Write the remaining edges and the header, and close the file
+	 * \throw std::system_error If writing fails
+	 */
+	void close()
+	{
+		flush();
+		char header[EdgeFile::s_headerSize];
+		std::memcpy(header,EdgeFile::magic(),8);
+		const std::uint64_t bound=m_nodeBound,count=m_edgeCount;
+		std::memcpy(header+8,&bound,8);
+		std::memcpy(header+16,&count,8);
+		write(header,sizeof(header),0);
+		const int fd=m_fd;
+		m_fd=-1;
+		if(::close(fd))
+		{
+			throw std::system_error(errno,std::generic_category(),"Can't close the edge file");
+		}
+	}
+
+	//! Write the edges of a graph, each once
+	template<typename T>
+	static void save(const CompactGraph<T>& graph,const std::string& path)
+	{
+		EdgeFileWriter writer(path,graph.size());
+		for(NodeId u=0;u<graph.size();++u)
+		{
+			for(const auto& v:graph.neighbors(u))
+			{
+				if(u<v)
+				{
+					writer.add(u,v);
+				}
+			}
+		}
+		writer.close();
+	}
+private:
+	int m_fd;
+
+	NodeId m_nodeBound;
+
+	std::uint64_t m_edgeCount;
+
+	const std::size_t m_blockEdges;
+
+	std::vector<EdgeFile::Edge> m_buffer;
+
+	void flush()
+	{
+		write(m_buffer.data(),m_buffer.size()*sizeof(EdgeFile::Edge),EdgeFile::s_headerSize+(m_edgeCount-m_buffer.size())*sizeof(EdgeFile::Edge));
+		m_buffer.clear();
+	}
+
+	void write(const void* data,std::size_t size,off_t offset)
+	{
+		const char* p=static_cast<const char*>(data);
+		while(size)
+		{
+			const ssize_t written=::pwrite(m_fd,p,size,offset);
+			if(written<0)
+			{
+				if(errno==EINTR)
+				{
+					continue;
+				}
+				throw std::system_error(errno,std::generic_category(),"Can't write the edge file");
+			}
+			p+=written;
+			size-=written;
+			offset+=written;
+		}
+	}
+};
+
+//! The I/O of an EdgeFileReader so far
+struct IoStatistics
+{
+	//! The bytes read from the file, header included
+	std::uint64_t bytesRead=0;
+
+	//! The read system calls
+	std::uint64_t reads=0;
+
+	//! The sequential passes over the file
+	unsigned int passes=0;
+
+	//! Whether the reads bypass the page cache
+	bool direct=false;
+};
+
+//! Streams an edge file in large sequential blocks through a single buffer, so memory use is one block whatever the size
+//! of the file. The kernel is told that access is sequential, so it reads ahead aggressively, and that the blocks
+//! already consumed won't be needed again, so a pass doesn't evict everything else from the page cache. With direct
+//! I/O the page cache is bypassed altogether, where the file system supports it (O_DIRECT)
+class EdgeFileReader
+{
+public:
+	using NodeId=EdgeFile::NodeId;
+
+	using Edge=EdgeFile::Edge;
+
+	/*!
+	 * \brief EdgeFileReader Open an edge file and read its header
+	 * \param direct Bypass the page cache if possible. statistics().direct tells whether it is
+	 * \param blockSize The bytes read at once, rounded up to a multiple of 4096
+	 * \throw std::system_error If the file can't be opened
+	 * \throw std::runtime_error If the file is not a well-formed edge file
+	 */
+	explicit EdgeFileReader(const std::string& path,const bool direct=false,const std::size_t blockSize=EdgeFile::s_defaultBlockSize):
+		m_fd(-1),
+		m_blockSize(std::max<std::size_t>(1,(blockSize+EdgeFile::s_alignment-1)/EdgeFile::s_alignment)*EdgeFile::s_alignment),
+		m_buffer(nullptr,&std::free)
+	{
+		m_fd=::open(path.c_str(),O_RDONLY);
+		if(m_fd<0)
+		{
+			throw std::system_error(errno,std::generic_category(),"Can't open "+path);
+		}
+		try
+		{
+			readHeader();
+#ifdef O_DIRECT
+			if(direct)
+			{
+				const int fd=::open(path.c_str(),O_RDONLY|O_DIRECT);
+				if(fd>=0)
+				{
+					::close(m_fd);
+					m_fd=fd;
+					m_statistics.direct=true;
+				}
+			}
+#else
+			(void)direct;
+#endif
+#ifdef POSIX_FADV_SEQUENTIAL
+			::posix_fadvise(m_fd,0,0,POSIX_FADV_SEQUENTIAL);
+#endif
+			void* buffer=nullptr;
+			if(::posix_memalign(&buffer,EdgeFile::s_alignment,m_blockSize))
+			{
+				throw std::bad_alloc();
+			}
+			m_buffer.reset(buffer);
+		}
+		catch(...)
+		{
+			::close(m_fd);
+			throw;
+		}
+	}
+
+	EdgeFileReader(const EdgeFileReader&)=delete;
+
+	EdgeFileReader& operator=(const EdgeFileReader&)=delete;
+
+	~EdgeFileReader() noexcept
+	{
+		::close(m_fd);
+	}
+
+	//! All ids are below this
+	NodeId nodeBound() const noexcept
+	{
+		return m_nodeBound;
+	}
+
+	std::uint64_t edgeCount() const noexcept
+	{
+		return m_edgeCount;
+	}
+
+	const IoStatistics& statistics() const noexcept
+	{
+		return m_statistics;
+	}
+
+	/*!
+	 * \brief forEachBlock One sequential pass over the file, calling f(begin, end) with the edges of every block. The
+	 * edges are valid only during the call
+	 * \throw std::system_error If reading fails
+	 * \throw std::runtime_error If the file is shorter than its header says
+	 */
+	template<typename F>
+	void forEachBlock(const F& f)
+	{
+		++m_statistics.passes;
+		const std::uint64_t size=EdgeFile::s_headerSize+m_edgeCount*sizeof(Edge);
+		char* const buffer=static_cast<char*>(m_buffer.get());
+		for(std::uint64_t offset=0;offset<size;offset+=m_blockSize)
+		{
+			const std::size_t wanted=std::min<std::uint64_t>(m_blockSize,size-offset);
+			if(read(buffer,offset,wanted)<wanted)
+			{
+				throw std::runtime_error("The edge file is truncated");
+			}
+			const std::size_t skip=offset?0:EdgeFile::s_headerSize;
+			const Edge* const begin=reinterpret_cast<const Edge*>(buffer+skip);
+			f(begin,begin+(wanted-skip)/sizeof(Edge));
+#ifdef POSIX_FADV_DONTNEED
+			if(not m_statistics.direct)
+			{
+				::posix_fadvise(m_fd,offset,wanted,POSIX_FADV_DONTNEED);
+			}
+#endif
+		}
+	}
+
+	/*!
+	 * \brief forEachEdge One sequential pass over the file, calling f(n1, n2) for every edge. Both ids are checked
+	 * against nodeBound() first, so f can index arrays of nodeBound() entries by them
+	 * \throw std::system_error If reading fails
+	 * \throw std::runtime_error If the file is shorter than its header says, or an id is not below nodeBound(). The edges
+	 * before it have been passed to f then
+	 */
+	template<typename F>
+	void forEachEdge(const F& f)
+	{
+		const NodeId bound=m_nodeBound;
+		forEachBlock([&f,bound](const Edge* begin,const Edge* end)
+		{
+			for(const Edge* e=begin;e<end;++e)
+			{
+				if(e->first>=bound or e->second>=bound)
+				{
+					throw std::runtime_error("Not a well-formed edge file: an id is not below the bound of the header");
+				}
+				f(e->first,e->second);
+			}
+		});
+	}
+private:
+	int m_fd;
+
+	const std::size_t m_blockSize;
+
+	//! Aligned as direct I/O requires
+	std::unique_ptr<void,decltype(&std::free)> m_buffer;
+
+	NodeId m_nodeBound;
+
+	std::uint64_t m_edgeCount;
+
+	IoStatistics m_statistics;
+
+	void readHeader()
+	{
+		char header[EdgeFile::s_headerSize];
+		const ssize_t n=::pread(m_fd,header,sizeof(header),0);
+		if(n<0)
+		{
+			throw std::system_error(errno,std::generic_category(),"Can't read the edge file");
+		}
+		if(std::size_t(n)<sizeof(header) or std::memcmp(header,EdgeFile::magic(),8))
+		{
+			throw std::runtime_error("Not an edge file");
+		}
+		std::uint64_t bound;
+		std::memcpy(&bound,header+8,8);
+		std::memcpy(&m_edgeCount,header+16,8);
+		m_nodeBound=bound;
+		struct stat status;
+		if(::fstat(m_fd,&status) or std::uint64_t(status.st_size)!=EdgeFile::s_headerSize+m_edgeCount*sizeof(Edge))
+		{
+			throw std::runtime_error("The edge file size doesn't match its header");
+		}
+		m_statistics.bytesRead+=n;
+		++m_statistics.reads;
+	}
+
+	//! Read wanted bytes at offset, retrying short reads until they are all there or the file ends. Every read asks for
+	//! the rest of the block, which is a multiple of the alignment as direct I/O requires. Returns the bytes read
+	std::size_t read(char* buffer,const std::uint64_t offset,const std::size_t wanted)
+	{
+		std::size_t total=0;
+		while(total<wanted)
+		{
+			const ssize_t n=::pread(m_fd,buffer+total,m_blockSize-total,offset+total);
+			if(n<0)
+			{
+				if(errno==EINTR)
+				{
+					continue;
+				}
+				throw std::system_error(errno,std::generic_category(),"Can't read the edge file");
+			}
+			++m_statistics.reads;
+			if(not n)
+			{
+				break;
+			}
+			m_statistics.bytesRead+=n;
+			total+=n;
+		}
+		return total;
+	}
+};
+
+}
+
+#endif // Graph_EdgeFile_H
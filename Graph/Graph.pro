@@ -8,6 +8,7 @@ QT       -= core gui
 
 TARGET = Graph
 TEMPLATE = lib
+CONFIG += thread
 QMAKE_CXXFLAGS += -Wall -Werror -std=c++11
 
 DEFINES += GRAPH_LIBRARY
@@ -20,7 +21,27 @@ HEADERS += \
     DepthFirstVisitor.h \
     IncreasingUndirectedGraph.h \
     GraphTraversalVisitor.h \
-    BreadthFirstVisitor.h
+    BreadthFirstVisitor.h \
+    Property.h \
+    Range.h \
+    CompactGraph.h \
+    PageRank.h \
+    Louvain.h \
+    SubgraphExtractor.h \
+    BoundedBreadthFirstSearch.h \
+    BatchBreadthFirstSearch.h \
+    VersionedGraph.h \
+    ConcurrentUndirectedGraph.h \
+    Partitioner.h \
+    Reordering.h \
+    CompressedGraph.h \
+    EdgeFile.h \
+    SemiExternal.h \
+    StreamingComponents.h \
+    GraphTraits.h \
+    ConnectedComponents.h \
+    GraphObserver.h \
+    DegreeBuckets.h
 
 unix:!symbian {
     maemo5 {
@@ -37,3 +58,6 @@ else:unix: LIBS += -L$$OUT_PWD/../SetOperations/ -lSetOperations
 
 INCLUDEPATH += $$PWD/../SetOperations
 DEPENDPATH += $$PWD/../SetOperations
+
+INCLUDEPATH += $$PWD/../Concurrency
+DEPENDPATH += $$PWD/../Concurrency
@@ -0,0 +1,116 @@
+#ifndef Graph_GraphObserver_H
+#define Graph_GraphObserver_H
+
+namespace Graph
+{
+
+//! Base class for the observers of UndirectedGraph mutations, with the observer P itself as template argument. An
+//! observer is a template argument of the graph, so its hooks are called statically and inlined; a graph without
+//! observers pays nothing. The hooks here do nothing, and an observer hides the ones it needs. They are called after
+//! the graph has changed, with the graph as first argument:
+//! - nodeInserted(graph, node), for every new node, before any edge of it
+//! - edgeInserted(graph, n1, n2, weight), for every new edge
+//! - edgeRemoved(graph, n1, n2, weight), for every removed edge, also the edges of a removed node
+//! - nodeRemoved(graph, node), for every removed node, after its edges. The node is still in the graph, without any
+//! edge, so that its id can be looked up
+//! - edgeWeightChanged(graph, n1, n2, oldWeight, newWeight), for every edge whose weight UndirectedGraph::setWeight()
+//! changes
+//! - nodesInserted(graph, nodes) and edgesInserted(graph, edges), once per batch inserted by
+//! UndirectedGraph::insertEdges(), all the nodes first. By default they call the single hooks of P for every item;
+//! an observer that can do better with a whole batch hides them
+//! - edgeWeightsChanged(graph, changes), once per call to UndirectedGraph::transformWeights(), with every edge whose
+//! weight changed, also when the call throws. By default it calls edgeWeightChanged() of P for every change
+//! - validate(graph), by UndirectedGraph::validate(), to check the observer against the graph
+//! Hooks should not throw: the graph keeps the change regardless. Observers that can't follow removals set s_removable
+//! to false, which turns calls to the remove() methods of the graph into compile errors
+template<typename P>
+class GraphObserver
+{
+public:
+	static const bool s_removable=true;
+
+	template<typename G>
+	void nodeInserted(const G&,const typename G::Node&) noexcept
+	{
+	}
+
+	template<typename G>
+	void edgeInserted(const G&,const typename G::Node&,const typename G::Node&,const typename G::EdgeWeight) noexcept
+	{
+	}
+
+	template<typename G>
+	void edgeRemoved(const G&,const typename G::Node&,const typename G::Node&,const typename G::EdgeWeight) noexcept
+	{
+	}
+
+	template<typename G>
+	void nodeRemoved(const G&,const typename G::Node&) noexcept
+	{
+	}
+
+	template<typename G>
+	void edgeWeightChanged(const G&,const typename G::Node&,const typename G::Node&,const typename G::EdgeWeight,const typename G::EdgeWeight) noexcept
+	{
+	}
+
+	template<typename G>
+	void nodesInserted(const G& graph,const typename G::NodeList& nodes)
+	{
+		for(const auto& n:nodes)
+		{
+			static_cast<P&>(*this).nodeInserted(graph,n);
+		}
+	}
+
+	template<typename G>
+	void edgesInserted(const G& graph,const typename G::EdgeList& edges)
+	{
+		for(const auto& e:edges)
+		{
+			static_cast<P&>(*this).edgeInserted(graph,e.n1,e.n2,e.weight);
+		}
+	}
+
+	template<typename G>
+	void edgeWeightsChanged(const G& graph,const typename G::WeightChangeList& changes)
+	{
+		for(const auto& c:changes)
+		{
+			static_cast<P&>(*this).edgeWeightChanged(graph,c.n1,c.n2,c.oldWeight,c.newWeight);
+		}
+	}
+
+	template<typename G>
+	void validate(const G&) const
+	{
+	}
+};
+
+//! All the observers of a graph, as bases of one class so that a graph without observers doesn't grow
+template<typename... O>
+class ObserverSet:public O...
+{
+public:
+	//! Whether all the observers can follow removals
+	static constexpr bool removable() noexcept
+	{
+		return removable<O...>(0);
+	}
+private:
+	template<typename P,typename... R>
+	static constexpr bool removable(int) noexcept
+	{
+		return P::s_removable and removable<R...>(0);
+	}
+
+	template<typename... R>
+	static constexpr bool removable(long) noexcept
+	{
+		return true;
+	}
+};
+
+}
+
+#endif // Graph_GraphObserver_H
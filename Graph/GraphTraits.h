@@ -0,0 +1,201 @@
+#ifndef Graph_GraphTraits_H
+#define Graph_GraphTraits_H
+
+namespace Graph
+{
+
+template<typename T,typename... O>
+class UndirectedGraph;
+
+template<typename T>
+class CompactGraph;
+
+template<typename T>
+class CompressedGraph;
+
+//! The compile-time graph concept of the generic algorithms (KCore, ConnectedComponents and the traversal visitors).
+//! A graph backend G provides a specialization with:
+//! - Node, the handle the algorithms address nodes by, and Label, the original node value
+//! - NodeId, NodeDegree, EdgeWeight and NeighborRange
+//! - idBound(g), isNode(g, id), node(g, id) and id(g, node): every node has a dense id below idBound(g)
+//! - label(g, node), degree(g, node) and neighbors(g, node), a range of Nodes
+//! - forEachNeighbor(g, node, f), calling f(neighbor, neighbor id, edge weight) for every neighbor, so that algorithms
+//! can index arrays by id without looking the neighbors up
+//! - forEachNeighborById(g, id, f), the same for the node with an id, without looking the node up either
+//! Everything is resolved at compile time, so the algorithms are inlined into every backend without virtual calls
+template<typename G>
+struct GraphTraits;
+
+template<typename T,typename... O>
+struct GraphTraits<UndirectedGraph<T,O...>>
+{
+	using G=UndirectedGraph<T,O...>;
+
+	using Node=typename G::Node;
+
+	using Label=Node;
+
+	using NodeId=typename G::NodeId;
+
+	using NodeDegree=typename G::NodeDegree;
+
+	using EdgeWeight=typename G::EdgeWeight;
+
+	using NeighborRange=typename G::NeighborNodeView;
+
+	//! Ids of removed nodes are below the bound too; see isNode()
+	static NodeId idBound(const G& g) noexcept
+	{
+		return g.nodeIdBound();
+	}
+
+	static bool isNode(const G& g,const NodeId id) noexcept
+	{
+		return g.isNodeId(id);
+	}
+
+	static const Node& node(const G& g,const NodeId id) noexcept
+	{
+		return g.node(id);
+	}
+
+	//! \throw typename G::NoSuchNode If the node is not in the graph
+	static NodeId id(const G& g,const Node& n)
+	{
+		return g.nodeId(n);
+	}
+
+	static const Label& label(const G&,const Node& n) noexcept
+	{
+		return n;
+	}
+
+	//! \throw typename G::NoSuchNode If the node is not in the graph
+	static NodeDegree degree(const G& g,const Node& n)
+	{
+		return g.degree(n);
+	}
+
+	//! \throw typename G::NoSuchNode If the node is not in the graph
+	static NeighborRange neighbors(const G& g,const Node& n)
+	{
+		return g.neighborNodesView(n);
+	}
+
+	//! Looks up the node once. The ids of the neighbors come from the adjacency list
+	//! \throw typename G::NoSuchNode If the node is not in the graph
+	template<typename F>
+	static void forEachNeighbor(const G& g,const Node& n,const F& f)
+	{
+		for(const auto& m:g.neighbors(n))
+		{
+			f(m.node,m.id,m.weight);
+		}
+	}
+
+	//! Reaches the adjacency list through the id index, without hashing. The id must belong to a node of the graph
+	template<typename F>
+	static void forEachNeighborById(const G& g,const NodeId id,const F& f)
+	{
+		for(const auto& m:g.adjacencyList(id))
+		{
+			f(m.node,m.id,m.weight);
+		}
+	}
+};
+
+//! The traits shared by the graphs that address their nodes by dense id, 0 to size()-1
+template<typename G>
+struct DenseGraphTraits
+{
+	using Node=typename G::Node;
+
+	using Label=typename G::Label;
+
+	using NodeId=typename G::NodeId;
+
+	using NodeDegree=typename G::NodeDegree;
+
+	using EdgeWeight=typename G::EdgeWeight;
+
+	using NeighborRange=typename G::NeighborRange;
+
+	static NodeId idBound(const G& g) noexcept
+	{
+		return g.size();
+	}
+
+	static bool isNode(const G& g,const NodeId id) noexcept
+	{
+		return id<g.size();
+	}
+
+	static Node node(const G&,const NodeId id) noexcept
+	{
+		return id;
+	}
+
+	static NodeId id(const G&,const Node n) noexcept
+	{
+		return n;
+	}
+
+	static const Label& label(const G& g,const Node n) noexcept
+	{
+		return g.label(n);
+	}
+
+	static NodeDegree degree(const G& g,const Node n) noexcept
+	{
+		return g.degree(n);
+	}
+
+	static NeighborRange neighbors(const G& g,const Node n) noexcept
+	{
+		return g.neighbors(n);
+	}
+
+	//! Nodes are their ids
+	template<typename F>
+	static void forEachNeighborById(const G& g,const NodeId id,const F& f)
+	{
+		GraphTraits<G>::forEachNeighbor(g,id,f);
+	}
+};
+
+template<typename T>
+struct GraphTraits<CompactGraph<T>>:DenseGraphTraits<CompactGraph<T>>
+{
+	using Base=DenseGraphTraits<CompactGraph<T>>;
+
+	template<typename F>
+	static void forEachNeighbor(const CompactGraph<T>& g,const typename Base::Node n,const F& f)
+	{
+		auto w=g.weights(n).begin();
+		for(const auto& v:g.neighbors(n))
+		{
+			f(v,v,*w);
+			++w;
+		}
+	}
+};
+
+template<typename T>
+struct GraphTraits<CompressedGraph<T>>:DenseGraphTraits<CompressedGraph<T>>
+{
+	using Base=DenseGraphTraits<CompressedGraph<T>>;
+
+	template<typename F>
+	static void forEachNeighbor(const CompressedGraph<T>& g,const typename Base::Node n,const F& f)
+	{
+		const typename Base::NeighborRange r=g.neighbors(n);
+		for(auto it=r.begin();it!=r.end();++it)
+		{
+			f(*it,*it,it.weight());
+		}
+	}
+};
+
+}
+
+#endif // Graph_GraphTraits_H
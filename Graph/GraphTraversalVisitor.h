@@ -2,24 +2,37 @@
 #define Graph_GraphTravesalVisitor_H
 
 #include <list>
+#include <vector>
+#include "GraphTraits.h"
 
 namespace Graph
 {
 
-//! Template abstract base class for graph traversal visitors.
-//!The class is intended to operate on UndirectedGraph objects, but any graph-like structure works
-template<typename T,template<typename> class S>
+//! Template base class for graph traversal visitors.
+//!The class operates on any graph G with GraphTraits, such as UndirectedGraph, CompactGraph or CompressedGraph.
+//!V is the derived visitor, which provides pushNextNeighbors(); it's called directly rather than through a virtual.
+//!Visited nodes are flagged by id, so the neighbors are not looked up while traversing. Each component starts from the
+//!unvisited node with the smallest id, which is the node inserted first as long as no nodes have been removed.
+//!The graph must not change while it's being traversed
+template<typename T,typename G,typename V>
 class GraphTravesalVisitor
 {
 public:
-	GraphTravesalVisitor(const S<T>& graph) noexcept:
+	GraphTravesalVisitor(const G& graph):
 		m_graph(graph),
-		m_remaining(graph.nodes()),
-		m_next(m_nodes.end())
+		m_visited(Traits::idBound(graph),false),
+		m_next(m_nodes.end()),
+		m_unvisited(0)
 	{
 	}
 protected:
-	using Node=typename S<T>::Node;
+	using Traits=GraphTraits<G>;
+
+	using Node=typename Traits::Node;
+
+	using NodeId=typename Traits::NodeId;
+
+	using EdgeWeight=typename Traits::EdgeWeight;
 
 	using NodeList=typename std::list<Node>;
 public:
@@ -35,47 +48,60 @@ public:
 	}
 
 	//! Get the next node in the traversal and a flag of whether this is a new component
-	typename GraphTravesalVisitor<T,S>::Element next() noexcept
+	Element next() noexcept
 	{
 		bool breakPoint=false;
-		if(GraphTravesalVisitor<T,S>::m_next==GraphTravesalVisitor<T,S>::m_nodes.end())
+		if(m_next==m_nodes.end())
 		{
-			if(GraphTravesalVisitor<T,S>::m_remaining.empty())
+			const NodeId bound=Traits::idBound(m_graph);
+			while(m_unvisited<bound and (not Traits::isNode(m_graph,m_unvisited) or m_visited[m_unvisited]))
 			{
-				return GraphTravesalVisitor<T,S>::end();
+				++m_unvisited;
+			}
+			if(m_unvisited==bound)
+			{
+				return end();
 			}
 			else
 			{
 				breakPoint=true;
-				const auto& nextNode=*GraphTravesalVisitor<T,S>::m_remaining.begin();
-				GraphTravesalVisitor<T,S>::m_next=GraphTravesalVisitor<T,S>::m_nodes.insert(GraphTravesalVisitor<T,S>::m_nodes.end(),nextNode);
-				pushNextNeighbors(nextNode);
-				GraphTravesalVisitor<T,S>::m_remaining.erase(nextNode);
+				m_next=m_nodes.insert(m_nodes.end(),Traits::node(m_graph,m_unvisited));
+				visit(m_unvisited);
+				static_cast<V&>(*this).pushNextNeighbors(*m_next);
 			}
 		}
 		else
 		{
-			pushNextNeighbors(*GraphTravesalVisitor<T,S>::m_next);
+			static_cast<V&>(*this).pushNextNeighbors(*m_next);
 		}
-		return std::make_pair(GraphTravesalVisitor<T,S>::m_next++,breakPoint);
+		return std::make_pair(m_next++,breakPoint);
 	}
 protected:
 	//! The graph
-	const S<T>& m_graph;
+	const G& m_graph;
 
 	//! The container of nodes that have been traversed so far
 	NodeList m_nodes;
 
-	using NodeSet=typename S<T>::NodeSet;
+	//! Whether every id has been traversed or is queued for traversal
+	std::vector<bool> m_visited;
 
-	//! The nodes that haven't been traversed so fast
-	NodeSet m_remaining;
+	//! Mark a node as visited by its id. Returns false if it was visited already
+	bool visit(const NodeId id) noexcept
+	{
+		if(m_visited[id])
+		{
+			return false;
+		}
+		m_visited[id]=true;
+		return true;
+	}
 private:
-	//! Utility method for pushing all neighbors of the next node in the traversal in the list of next nodes
-	virtual void pushNextNeighbors(const typename GraphTravesalVisitor<T,S>::Node& node) noexcept =0;
-
 	//! The next node that will be returned in the traversal
 	typename NodeList::iterator m_next;
+
+	//! Scans the node ids for the start of the next component. The nodes with smaller ids have all been visited
+	NodeId m_unvisited;
 };
 
 }
@@ -2,123 +2,208 @@
 #define Graph_IncreasingUndirectedGraph_H
 
 #include "UndirectedGraph.h"
+#include "GraphObserver.h"
+#include "GraphTraits.h"
+#include "ConnectedComponents.h"
 #include "DisjointSets.h"
 
 namespace Graph
 {
 
+//! Observer that keeps the connected components of a graph in disjoint sets while nodes and edges are inserted.
+//! Disjoint sets can't be split, so the graph can't remove anything
 template<typename T>
-class IncreasingUndirectedGraph:public UndirectedGraph<T>
+class ComponentObserver:public GraphObserver<ComponentObserver<T>>
 {
 public:
-	using UndirectedGraph<T>::UndirectedGraph;
+	static const bool s_removable=false;
 
-	using Node=typename UndirectedGraph<T>::Node;
-	using AdjacencyList=typename UndirectedGraph<T>::AdjacencyList;
-	using EdgeWeight=typename UndirectedGraph<T>::EdgeWeight;
+	using Components=SetOperations::DisjointSets<T>;
 
-	void insert(const Node& node) override
+	template<typename G>
+	void nodeInserted(const G&,const T& node)
 	{
-		UndirectedGraph<T>::insert(node);
-		insertInternal(node,UndirectedGraph<T>::UndirectedGraph::neighbors(node));
+		m_components.add(node);
 	}
 
-	void insert(const Node& node,const AdjacencyList& neighbors) override
+	template<typename G>
+	void edgeInserted(const G&,const T& n1,const T& n2,const typename G::EdgeWeight)
 	{
-		UndirectedGraph<T>::insert(node,neighbors);
-		insertInternal(node,neighbors);
-	}
-
-	void edge(const Node& n1,const Node& n2) override
-	{
-		UndirectedGraph<T>::edge(n1,n2);
-		edgeInternal(n1,n2);
-	}
-
-	void edge(const Node& n1,const Node& n2,const EdgeWeight weight) override
-	{
-		UndirectedGraph<T>::edge(n1,n2,weight);
-		edgeInternal(n1,n2);
+		m_components.join(n1,n2);
 	}
 
-	using ConnectedComponentSet=typename UndirectedGraph<T>::ConnectedComponentSet;
-
-	ConnectedComponentSet connectedComponents() const noexcept override
+	//! Join the endpoints of a batch. DisjointSets::joinBatch() rewrites the parent of every node, so only a batch that is
+	//! large next to the graph is joined at once, in parallel; a smaller one is joined edge by edge
+	template<typename G>
+	void edgesInserted(const G&,const typename G::EdgeList& edges)
 	{
-		return m_components.sets();
+		if(edges.size()<Concurrency::s_minimumChunk or edges.size()*s_batchRatio<m_components.size())
+		{
+			for(const auto& e:edges)
+			{
+				m_components.join(e.n1,e.n2);
+			}
+			return;
+		}
+		typename Components::ElementPairs pairs;
+		pairs.reserve(edges.size());
+		for(const auto& e:edges)
+		{
+			pairs.emplace_back(e.n1,e.n2);
+		}
+		m_components.joinBatch(pairs);
 	}
 
-	bool sameComponent(const Node& n1,const Node& n2) const
+	/*!
+	 * \brief validate Check the parent structure of the components and that they are the connected components of the
+	 * graph: every node is in exactly one component, the two endpoints of every edge are in the same component and there
+	 * are as many components as a traversal of the graph finds
+	 * \throw CorruptedGraph On the first inconsistency found
+	 */
+	template<typename G>
+	void validate(const G& graph) const
 	{
 		try
 		{
-			return m_components.find(n1)==m_components.find(n2);
+			m_components.validate();
 		}
-		catch(typename SetOperations::DisjointSets<T>::NoSuchElement& e)
+		catch(const typename Components::CorruptedParent& e)
+		{
+			std::stringstream ss;
+			ss<<"The component structure is corrupted at node "<<e.element();
+			throw typename G::CorruptedGraph(ss.str());
+		}
+		if(m_components.size()!=graph.size())
 		{
-			throw typename UndirectedGraph<T>::NoSuchNode(e.element());
+			throw typename G::CorruptedGraph("The components don't cover exactly the nodes of the graph");
+		}
+		for(const auto& n:graph.nodesView())
+		{
+			try
+			{
+				const T& root=m_components.find(n);
+				for(const auto& m:graph.neighbors(n))
+				{
+					if(not (m_components.find(m)==root))
+					{
+						std::stringstream ss;
+						ss<<"Edge ("<<n<<", "<<m.node<<") connects two different components";
+						throw typename G::CorruptedGraph(ss.str());
+					}
+				}
+			}
+			catch(const typename Components::NoSuchElement& e)
+			{
+				std::stringstream ss;
+				ss<<"Node "<<e.element()<<" doesn't belong to any component";
+				throw typename G::CorruptedGraph(ss.str());
+			}
+		}
+		typename ConnectedComponents<T>::NodeId count=0;
+		ConnectedComponents<T>(graph).membership(count);
+		if(count!=m_components.setCount())
+		{
+			throw typename G::CorruptedGraph("The components join nodes that the graph doesn't connect");
 		}
 	}
 
-	using ConnectedComponent=typename UndirectedGraph<T>::ConnectedComponent;
-
-	const ConnectedComponent& component(const Node& n) const
+	const Components& components() const noexcept
 	{
-		return m_components.set(n);
+		return m_components;
 	}
 private:
-	void remove(const Node&, const Node&) override
-	{
-		throw typename UndirectedGraph<T>::CorruptedGraph("Illegal remove edge operation");
-	}
+	//! A batch is joined at once when it has at least one edge for every s_batchRatio nodes of the graph
+	static const std::size_t s_batchRatio=8;
 
-	void remove(const Node&) override
+	Components m_components;
+};
+
+template<typename T>
+const std::size_t ComponentObserver<T>::s_batchRatio;
+
+//! A graph that can only grow and keeps its connected components up to date, so that they are queried without a
+//! traversal. The remove() methods don't compile
+template<typename T>
+class IncreasingUndirectedGraph:public UndirectedGraph<T,ComponentObserver<T>>
+{
+	using Base=UndirectedGraph<T,ComponentObserver<T>>;
+public:
+	using Base::Base;
+
+	using Node=typename Base::Node;
+
+	using ConnectedComponentSet=typename Base::ConnectedComponentSet;
+
+	ConnectedComponentSet connectedComponents() const noexcept
 	{
-		throw typename UndirectedGraph<T>::CorruptedGraph("Illegal remove node operation");
+		return components().sets();
 	}
 
-	void edgeInternal(const Node& n1,const Node& n2) noexcept
+	/*!
+	 * \brief sameComponent Whether two nodes are in the same component
+	 * \throw NoSuchNode If a node is not in the graph
+	 */
+	bool sameComponent(const Node& n1,const Node& n2) const
 	{
 		try
 		{
-			m_components.add(n1);
-		}
-		catch(typename SetOperations::DisjointSets<T>::ElementExists&)
-		{
-		}
-		try
-		{
-			m_components.add(n2);
+			return components().find(n1)==components().find(n2);
 		}
-		catch(typename SetOperations::DisjointSets<T>::ElementExists&)
+		catch(typename SetOperations::DisjointSets<T>::NoSuchElement& e)
 		{
+			throw typename Base::NoSuchNode(e.element());
 		}
-		m_components.join(n1,n2);
 	}
 
-	void insertInternal(const Node& node,const AdjacencyList& neighbors) noexcept
+	//! The number of connected components, without enumerating them
+	std::size_t componentCount() const noexcept
+	{
+		return components().setCount();
+	}
+
+	/*!
+	 * \brief componentSize The number of nodes in the component of a node, without enumerating it
+	 * \throw NoSuchNode If the node is not in the graph
+	 */
+	std::size_t componentSize(const Node& n) const
 	{
 		try
 		{
-			m_components.add(node);
+			return components().setSize(n);
 		}
-		catch(typename SetOperations::DisjointSets<T>::ElementExists&)
-		{
-		}
-		for(const auto& n:neighbors)
+		catch(typename SetOperations::DisjointSets<T>::NoSuchElement& e)
 		{
-			try
-			{
-				m_components.add(n);
-			}
-			catch(typename SetOperations::DisjointSets<T>::ElementExists&)
-			{
-			}
-			m_components.join(node,n);
+			throw typename Base::NoSuchNode(e.element());
 		}
 	}
 
-	SetOperations::DisjointSets<T> m_components;
+	//! A component by one of its nodes, the same for all its members, and its size
+	using ComponentSize=typename SetOperations::DisjointSets<T>::SetSize;
+
+	//! The k largest components, largest first
+	std::vector<ComponentSize> largestComponents(const std::size_t k) const
+	{
+		return components().largest(k);
+	}
+
+	using ConnectedComponent=typename Base::ConnectedComponent;
+
+	//! A copy of the component of a node, in O(size of the component)
+	ConnectedComponent component(const Node& n) const
+	{
+		return components().set(n);
+	}
+private:
+	const typename ComponentObserver<T>::Components& components() const noexcept
+	{
+		return Base::template observer<ComponentObserver<T>>().components();
+	}
+};
+
+//! The generic algorithms see an IncreasingUndirectedGraph as the UndirectedGraph it is
+template<typename T>
+struct GraphTraits<IncreasingUndirectedGraph<T>>:GraphTraits<UndirectedGraph<T>>
+{
 };
 
 }
@@ -1,16 +1,23 @@
 #ifndef Graph_KCore_H
 #define Graph_KCore_H
 
+#include <vector>
+#include <numeric>
+#include <algorithm>
 #include "UndirectedGraph.h"
+#include "GraphTraits.h"
 
 namespace Graph
 {
 
-template<typename T>
+//! The k-core of any graph with GraphTraits, such as UndirectedGraph, CompactGraph or CompressedGraph: the nodes that
+//! remain after repeatedly removing the nodes with degree below k. The graph is left untouched; peeling only
+//! decrements a degree counter per node id, so it runs directly on the compressed representation
+template<typename T,typename G=UndirectedGraph<T>>
 class KCore
 {
 public:
-	KCore(const UndirectedGraph<T>& graph,const unsigned int k) noexcept:
+	KCore(const G& graph,const unsigned int k) noexcept:
 		m_graph(graph),
 		m_k(k)
 	{
@@ -20,41 +27,109 @@ public:
 
 	NodeSet operator()() const noexcept
 	{
-		NodeSet good,bad;
-		sieve(good,bad);
-		while(not bad.empty())
+		using Traits=GraphTraits<G>;
+		using NodeId=typename Traits::NodeId;
+		const NodeId n=Traits::idBound(m_graph);
+		std::vector<typename Traits::NodeDegree> degrees(n,0);
+		std::vector<bool> removed(n,true);
+		std::vector<NodeId> peeled;
+		for(NodeId u=0;u<n;++u)
 		{
-			using Node=typename UndirectedGraph<T>::Node;
-			const typename NodeSet::iterator it=bad.begin();
-			const Node next=*it;
-			bad.erase(it);
-			const typename UndirectedGraph<T>::AdjacencyList& l=m_graph.neighbors(next);
-			for(const auto& n:l)
+			if(not Traits::isNode(m_graph,u))
 			{
-				if(m_graph.degree(n)==m_k)
+				continue;
+			}
+			degrees[u]=Traits::degree(m_graph,Traits::node(m_graph,u));
+			removed[u]=degrees[u]<m_k;
+			if(removed[u])
+			{
+				peeled.push_back(u);
+			}
+		}
+		for(std::size_t next=0;next<peeled.size();++next)
+		{
+			Traits::forEachNeighbor(m_graph,Traits::node(m_graph,peeled[next]),[this,&degrees,&removed,&peeled](const typename Traits::Node&,const NodeId v,const typename Traits::EdgeWeight)
+			{
+				if(not removed[v] and degrees[v]--==m_k)
 				{
-					good.erase(n);
-					bad.insert(n);
+					removed[v]=true;
+					peeled.push_back(v);
 				}
+			});
+		}
+		NodeSet result;
+		for(NodeId u=0;u<n;++u)
+		{
+			if(not removed[u])
+			{
+				result.insert(Traits::label(m_graph,Traits::node(m_graph,u)));
 			}
-			m_graph.remove(next);
 		}
-		return good;
+		return result;
 	}
-private:
-	mutable UndirectedGraph<T> m_graph;
 
-	const unsigned int m_k;
+	using NodeDegree=typename GraphTraits<G>::NodeDegree;
 
-	void sieve(NodeSet& good,NodeSet& bad) const noexcept
+	//! The core number of every node id, the largest k whose k-core holds the node, so that all the k-cores come from
+	//! one pass; k is not used. The nodes are peeled from a bucket queue: an array of the ids sorted by remaining
+	//! degree, where lowering the degree of a node swaps it to the front of its bucket and moves the bucket boundary,
+	//! so the whole decomposition is O(nodes+edges). Ids that don't belong to a node get 0
+	std::vector<NodeDegree> coreNumbers() const
 	{
-		const NodeSet nodes=m_graph.nodes();
-		for(const auto& n:nodes)
+		using Traits=GraphTraits<G>;
+		using NodeId=typename Traits::NodeId;
+		const NodeId n=Traits::idBound(m_graph);
+		std::vector<NodeDegree> degrees(n,0);
+		NodeDegree maxDegree=0;
+		std::vector<NodeId> order;
+		for(NodeId u=0;u<n;++u)
 		{
-			NodeSet& nodeSet=m_graph.degree(n)<m_k?bad:good;
-			nodeSet.insert(n);
+			if(Traits::isNode(m_graph,u))
+			{
+				degrees[u]=Traits::degree(m_graph,Traits::node(m_graph,u));
+				maxDegree=std::max(maxDegree,degrees[u]);
+				order.push_back(u);
+			}
 		}
+		std::vector<std::size_t> buckets(maxDegree+2,0);
+		for(const auto u:order)
+		{
+			++buckets[degrees[u]+1];
+		}
+		std::partial_sum(buckets.begin(),buckets.end(),buckets.begin());
+		std::vector<std::size_t> positions(n);
+		{
+			std::vector<std::size_t> next(buckets);
+			std::vector<NodeId> sorted(order.size());
+			for(const auto u:order)
+			{
+				positions[u]=next[degrees[u]]++;
+				sorted[positions[u]]=u;
+			}
+			order.swap(sorted);
+		}
+		for(std::size_t i=0;i<order.size();++i)
+		{
+			const NodeId u=order[i];
+			Traits::forEachNeighbor(m_graph,Traits::node(m_graph,u),[&degrees,&buckets,&positions,&order,u](const typename Traits::Node&,const NodeId v,const typename Traits::EdgeWeight)
+			{
+				if(degrees[v]>degrees[u])
+				{
+					const std::size_t first=buckets[degrees[v]];
+					const NodeId w=order[first];
+					std::swap(order[first],order[positions[v]]);
+					std::swap(positions[v],positions[w]);
+					++buckets[degrees[v]];
+					--degrees[v];
+				}
+			});
+		}
+		return degrees;
 	}
+private:
+	const G& m_graph;
+
+	const unsigned int m_k;
 };
 
 }
@@ -0,0 +1,490 @@
+#ifndef Graph_Louvain_H
+#define Graph_Louvain_H
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include "CompactGraph.h"
+#include "ParallelFor.h"
+
+namespace Graph
+{
+
+//! Community detection by modularity optimization with the Louvain method (Blondel, Guillaume, Lambiotte and Lefebvre).
+//! Every level moves single nodes between communities for as long as that improves modularity, then merges each
+//! community into one node of a coarser graph, until a level brings no improvement. Edge weights are used as given.
+//! The local moving phase visits the nodes sequentially in id order, so that results are deterministic and match the
+//! reference implementation, and numbering and grouping the communities between levels are sequential O(n) scans.
+//! Reading the input graph, building the nodes and edges of every coarse level and evaluating modularity after every
+//! pass run in parallel, and modularity is summed in fixed blocks so that it doesn't depend on the number of threads.
+//! Community weights are kept in arrays indexed by community id, never in hash tables
+template<typename T>
+class Louvain
+{
+public:
+	using NodeId=typename CompactGraph<T>::NodeId;
+
+	using NodeSet=typename UndirectedGraph<T>::NodeSet;
+
+	//! The communities as sets of nodes, in the same shape as UndirectedGraph<T>::ConnectedComponentSet
+	using Partition=std::vector<NodeSet>;
+
+	//! The community of every node id. Communities are numbered from 0
+	using Membership=std::vector<NodeId>;
+
+	/*!
+	 * \brief Louvain
+	 * \param resolution Values above 1 favor smaller communities, values below 1 larger ones
+	 * \param tolerance A pass or level has to improve modularity by more than this to be kept
+	 * \param threads The number of threads. 0 means Concurrency::hardwareThreads()
+	 */
+	Louvain(const CompactGraph<T>& graph,const double resolution=1,const double tolerance=1e-7,const unsigned int threads=0):
+		m_graph(graph),
+		m_resolution(resolution),
+		m_tolerance(tolerance),
+		m_threads(threads)
+	{
+	}
+
+	//! The graph is kept by reference, so it can't be a temporary
+	Louvain(CompactGraph<T>&&,const double=1,const double=1e-7,const unsigned int=0)=delete;
+
+	//! Work on a CompactGraph snapshot of the graph, taken here
+	Louvain(const UndirectedGraph<T>& graph,const double resolution=1,const double tolerance=1e-7,const unsigned int threads=0):
+		m_snapshot(graph),
+		m_graph(m_snapshot),
+		m_resolution(resolution),
+		m_tolerance(tolerance),
+		m_threads(threads)
+	{
+	}
+
+	Louvain(const Louvain&)=delete;
+
+	Louvain& operator=(const Louvain&)=delete;
+
+	//! The communities, largest first. Isolated nodes form communities of their own
+	Partition operator()() const
+	{
+		const Membership communities=membership();
+		Partition result;
+		for(NodeId i=0;i<communities.size();++i)
+		{
+			if(communities[i]>=result.size())
+			{
+				result.resize(communities[i]+1);
+			}
+			result[communities[i]].insert(m_graph.label(i));
+		}
+		std::stable_sort(result.begin(),result.end(),[](const NodeSet& a,const NodeSet& b)
+		{
+			return a.size()>b.size();
+		});
+		return result;
+	}
+
+	//! The community of every node id
+	Membership membership() const
+	{
+		Level level=base();
+		Membership result(level.size());
+		for(NodeId i=0;i<result.size();++i)
+		{
+			result[i]=i;
+		}
+		double total=0;
+		for(const auto& d:level.degrees)
+		{
+			total+=d;
+		}
+		if(total==0)
+		{
+			return result;
+		}
+		Membership communities(level.size());
+		for(NodeId i=0;i<communities.size();++i)
+		{
+			communities[i]=i;
+		}
+		double quality=modularity(level,communities,level.degrees,total);
+		while(true)
+		{
+			const double q=move(level,communities,total,quality);
+			if(q-quality<=m_tolerance)
+			{
+				break;
+			}
+			quality=q;
+			const NodeId count=renumber(communities);
+			for(auto& c:result)
+			{
+				c=communities[c];
+			}
+			if(count==level.size())
+			{
+				break;
+			}
+			level=coarsen(level,communities,count);
+			communities.resize(count);
+			for(NodeId i=0;i<count;++i)
+			{
+				communities[i]=i;
+			}
+		}
+		return result;
+	}
+
+	/*!
+	 * \brief modularity The modularity of a partition given as the community of every node id. Communities can be
+	 * numbered arbitrarily as long as the numbers are below the number of nodes
+	 * \throw std::out_of_range If there isn't one community per node or a community number is not below the number of
+	 * nodes
+	 */
+	double modularity(const Membership& communities) const
+	{
+		if(communities.size()!=m_graph.size())
+		{
+			throw std::out_of_range("Not one community per node");
+		}
+		for(const auto& c:communities)
+		{
+			if(c>=communities.size())
+			{
+				throw std::out_of_range("Not a community");
+			}
+		}
+		const Level level=base();
+		double total=0;
+		std::vector<double> degrees(level.size(),0);
+		for(NodeId u=0;u<level.size();++u)
+		{
+			total+=level.degrees[u];
+			degrees[communities[u]]+=level.degrees[u];
+		}
+		return total==0?0:modularity(level,communities,degrees,total);
+	}
+
+	/*!
+	 * \brief modularity The modularity of a partition given as sets of nodes. Nodes not in any set count as communities
+	 * of their own
+	 * \throw typename CompactGraph<T>::NoSuchNode If a set contains a node that is not in the graph
+	 */
+	double modularity(const Partition& partition) const
+	{
+		const NodeId n=m_graph.size();
+		Membership communities(n,n);
+		NodeId next=0;
+		for(const auto& s:partition)
+		{
+			for(const auto& node:s)
+			{
+				communities[m_graph.id(node)]=next;
+			}
+			next+=not s.empty();
+		}
+		for(auto& c:communities)
+		{
+			if(c==n)
+			{
+				c=next++;
+			}
+		}
+		return modularity(communities);
+	}
+private:
+	//! The graph of one level, in CSR form like CompactGraph. Node i of a coarse level is community i of the level
+	//! below, and the edges inside a community become a loop on its node
+	struct Level
+	{
+		std::vector<std::size_t> offsets;
+
+		std::vector<NodeId> targets;
+
+		std::vector<double> weights;
+
+		//! The total weight of the edges inside every node
+		std::vector<double> loops;
+
+		//! The weighted degree of every node, counting its loop twice
+		std::vector<double> degrees;
+
+		NodeId size() const noexcept
+		{
+			return loops.size();
+		}
+	};
+
+	//! Only set when constructed from an UndirectedGraph
+	const CompactGraph<T> m_snapshot;
+
+	const CompactGraph<T>& m_graph;
+
+	const double m_resolution;
+
+	const double m_tolerance;
+
+	const unsigned int m_threads;
+
+	//! The level of the input graph
+	Level base() const
+	{
+		const NodeId n=m_graph.size();
+		Level result;
+		result.offsets.assign(m_graph.offsets().begin(),m_graph.offsets().end());
+		result.targets.assign(m_graph.targets().begin(),m_graph.targets().end());
+		result.weights.resize(result.targets.size());
+		result.loops.assign(n,0);
+		result.degrees.resize(n);
+		Concurrency::parallelFor(0,n,[this,&result](const std::size_t first,const std::size_t last)
+		{
+			for(std::size_t u=first;u<last;++u)
+			{
+				double d=0;
+				for(std::size_t e=result.offsets[u];e<result.offsets[u+1];++e)
+				{
+					result.weights[e]=m_graph.weights()[e];
+					d+=result.weights[e];
+				}
+				result.degrees[u]=d;
+			}
+		},m_threads);
+		return result;
+	}
+
+	//! Modularity of a partition of a level, given the weighted degree of every community. total is the sum of all
+	//! weighted degrees
+	double modularity(const Level& level,const Membership& communities,const std::vector<double>& degrees,const double total) const
+	{
+		const double inside=sum(level.size(),[&level,&communities](const std::size_t first,const std::size_t last)
+		{
+			double w=0;
+			for(std::size_t u=first;u<last;++u)
+			{
+				w+=2*level.loops[u];
+				for(std::size_t e=level.offsets[u];e<level.offsets[u+1];++e)
+				{
+					if(communities[level.targets[e]]==communities[u])
+					{
+						w+=level.weights[e];
+					}
+				}
+			}
+			return w;
+		});
+		const double spread=sum(degrees.size(),[&degrees,total](const std::size_t first,const std::size_t last)
+		{
+			double w=0;
+			for(std::size_t c=first;c<last;++c)
+			{
+				w+=(degrees[c]/total)*(degrees[c]/total);
+			}
+			return w;
+		});
+		return inside/total-m_resolution*spread;
+	}
+
+	//! The sum of f(begin, end) over the blocks of Concurrency::s_minimumChunk consecutive indices of [0, n). The
+	//! blocks are summed in parallel and their sums added in order
+	template<typename F>
+	double sum(const std::size_t n,const F& f) const
+	{
+		const std::size_t block=Concurrency::s_minimumChunk;
+		const std::size_t blocks=(n+block-1)/block;
+		const std::size_t chunks=std::max<std::size_t>(1,std::min<std::size_t>(m_threads?m_threads:Concurrency::hardwareThreads(),blocks));
+		std::vector<std::size_t> bounds(chunks+1);
+		for(std::size_t chunk=0;chunk<=chunks;++chunk)
+		{
+			bounds[chunk]=blocks/chunks*chunk+std::min(chunk,blocks%chunks);
+		}
+		std::vector<double> partial(blocks);
+		Concurrency::parallelForRanges(bounds,[&f,&partial,n,block](const std::size_t,const std::size_t first,const std::size_t last)
+		{
+			for(std::size_t b=first;b<last;++b)
+			{
+				partial[b]=f(b*block,std::min(n,(b+1)*block));
+			}
+		});
+		double result=0;
+		for(const auto& p:partial)
+		{
+			result+=p;
+		}
+		return result;
+	}
+
+	//! The local moving phase: move every node to the neighboring community with the largest modularity gain, pass
+	//! after pass, until a pass improves modularity by no more than the tolerance. Returns the final modularity
+	double move(const Level& level,Membership& communities,const double total,double quality) const
+	{
+		const NodeId n=level.size();
+		std::vector<double> degrees(level.degrees);
+		std::vector<double> weight(n,-1);
+		std::vector<NodeId> touched;
+		while(true)
+		{
+			bool moved=false;
+			for(NodeId u=0;u<n;++u)
+			{
+				const NodeId current=communities[u];
+				for(std::size_t e=level.offsets[u];e<level.offsets[u+1];++e)
+				{
+					const NodeId c=communities[level.targets[e]];
+					if(weight[c]<0)
+					{
+						weight[c]=0;
+						touched.push_back(c);
+					}
+					weight[c]+=level.weights[e];
+				}
+				const double scale=m_resolution*level.degrees[u]/total;
+				degrees[current]-=level.degrees[u];
+				NodeId best=current;
+				double bestGain=std::max(weight[current],0.0)-degrees[current]*scale;
+				for(const auto& c:touched)
+				{
+					const double gain=weight[c]-degrees[c]*scale;
+					if(gain>bestGain)
+					{
+						best=c;
+						bestGain=gain;
+					}
+				}
+				degrees[best]+=level.degrees[u];
+				if(best!=current)
+				{
+					communities[u]=best;
+					moved=true;
+				}
+				for(const auto& c:touched)
+				{
+					weight[c]=-1;
+				}
+				touched.clear();
+			}
+			if(not moved)
+			{
+				return quality;
+			}
+			const double q=modularity(level,communities,degrees,total);
+			if(q-quality<=m_tolerance)
+			{
+				return q;
+			}
+			quality=q;
+		}
+	}
+
+	//! Number the communities from 0 in the order of their smallest node. Returns the number of communities
+	static NodeId renumber(Membership& communities)
+	{
+		const NodeId n=communities.size();
+		Membership numbers(n,n);
+		NodeId count=0;
+		for(auto& c:communities)
+		{
+			if(numbers[c]==n)
+			{
+				numbers[c]=count++;
+			}
+			c=numbers[c];
+		}
+		return count;
+	}
+
+	//! Merge every community of a level into a single node. The edges between two communities become one edge carrying
+	//! their total weight. The coarse nodes are built in parallel
+	Level coarsen(const Level& level,const Membership& communities,const NodeId count) const
+	{
+		const NodeId n=level.size();
+		std::vector<std::size_t> first(count+1,0);
+		for(NodeId u=0;u<n;++u)
+		{
+			++first[communities[u]+1];
+		}
+		for(NodeId c=0;c<count;++c)
+		{
+			first[c+1]+=first[c];
+		}
+		std::vector<NodeId> members(n);
+		{
+			std::vector<std::size_t> position(first.begin(),first.end()-1);
+			for(NodeId u=0;u<n;++u)
+			{
+				members[position[communities[u]]++]=u;
+			}
+		}
+		Level result;
+		result.loops.resize(count);
+		result.degrees.resize(count);
+		std::vector<std::vector<std::pair<NodeId,double>>> edges(count);
+		Concurrency::parallelFor(0,count,[&](const std::size_t begin,const std::size_t end)
+		{
+			std::vector<double> weight(count,-1);
+			std::vector<NodeId> touched;
+			for(std::size_t c=begin;c<end;++c)
+			{
+				double loop=0;
+				for(std::size_t i=first[c];i<first[c+1];++i)
+				{
+					const NodeId u=members[i];
+					loop+=level.loops[u];
+					for(std::size_t e=level.offsets[u];e<level.offsets[u+1];++e)
+					{
+						const NodeId d=communities[level.targets[e]];
+						if(d==c)
+						{
+							//Seen once from each endpoint
+							loop+=level.weights[e]/2;
+						}
+						else
+						{
+							if(weight[d]<0)
+							{
+								weight[d]=0;
+								touched.push_back(d);
+							}
+							weight[d]+=level.weights[e];
+						}
+					}
+				}
+				std::sort(touched.begin(),touched.end());
+				double degree=2*loop;
+				for(const auto& d:touched)
+				{
+					edges[c].push_back(std::make_pair(d,weight[d]));
+					degree+=weight[d];
+					weight[d]=-1;
+				}
+				touched.clear();
+				result.loops[c]=loop;
+				result.degrees[c]=degree;
+			}
+		},m_threads);
+		result.offsets.resize(count+1);
+		result.offsets[0]=0;
+		for(NodeId c=0;c<count;++c)
+		{
+			result.offsets[c+1]=result.offsets[c]+edges[c].size();
+		}
+		result.targets.resize(result.offsets.back());
+		result.weights.resize(result.offsets.back());
+		Concurrency::parallelFor(0,count,[&](const std::size_t begin,const std::size_t end)
+		{
+			for(std::size_t c=begin;c<end;++c)
+			{
+				std::size_t e=result.offsets[c];
+				for(const auto& m:edges[c])
+				{
+					result.targets[e]=m.first;
+					result.weights[e++]=m.second;
+				}
+			}
+		},m_threads);
+		return result;
+	}
+};
+
+}
+
+#endif // Graph_Louvain_H
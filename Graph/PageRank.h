@@ -0,0 +1,271 @@
+#ifndef Graph_PageRank_H
+#define Graph_PageRank_H
+
+#include <vector>
+#include <deque>
+#include <cmath>
+#include <stdexcept>
+#include <unordered_map>
+#include "CompactGraph.h"
+#include "ParallelFor.h"
+#include "DefaultInitAllocator.h"
+#include "Numa.h"
+
+namespace Graph
+{
+
+//! PageRank and personalized PageRank over a CompactGraph. Edge weights bias the random walk: a walker at node u moves
+//! to neighbor v with probability w(u,v)/W(u), where W(u) is the sum of the weights of u's edges. Isolated nodes
+//! send their rank to the teleport distribution.
+//! The power iterations are pull-based: every node sums the contributions of its neighbors, so each thread writes only
+//! the entries of the contiguous, edge-balanced id range it owns and reads the shared arrays of the previous iteration.
+//! On a graph whose partitions were placed on NUMA nodes, the ranges follow the partitions and every thread runs on the
+//! node that holds its range
+template<typename T>
+class PageRank
+{
+public:
+	using NodeId=typename CompactGraph<T>::NodeId;
+
+	//! One value per node id
+	using Ranks=std::vector<double>;
+
+	//! Node ids with their values, for results that only cover a few nodes
+	using SparseRanks=std::vector<std::pair<NodeId,double>>;
+
+	//! The outcome of a power iteration
+	struct Result
+	{
+		Ranks ranks;
+
+		//! The number of iterations that were run
+		unsigned int iterations;
+
+		//! The L1 distance between the last two iterations
+		double residual;
+	};
+
+	/*!
+	 * \brief PageRank
+	 * \param damping The probability that the walker follows an edge instead of teleporting
+	 * \param tolerance Iteration stops once the L1 distance between two iterations is below this
+	 * \param maxIterations Iteration stops after this many iterations even if it hasn't converged
+	 * \param threads The number of threads. 0 means Concurrency::hardwareThreads()
+	 */
+	PageRank(const CompactGraph<T>& graph,const double damping=0.85,const double tolerance=1e-9,const unsigned int maxIterations=100,const unsigned int threads=0):
+		m_graph(graph),
+		m_damping(damping),
+		m_tolerance(tolerance),
+		m_maxIterations(maxIterations),
+		m_ranges(graph.balancedRanges(threads?threads:Concurrency::hardwareThreads())),
+		m_nodes(graph.rangeNodes(m_ranges)),
+		m_inverseWeight(graph.size())
+	{
+		Concurrency::parallelForRanges(m_ranges,m_nodes,[this](const std::size_t,const NodeId first,const NodeId last)
+		{
+			for(NodeId u=first;u<last;++u)
+			{
+				double w=0;
+				for(const auto& x:m_graph.weights(u))
+				{
+					w+=x;
+				}
+				m_inverseWeight[u]=w>0?1/w:0;
+			}
+		});
+	}
+
+	//! The graph is kept by reference, so it can't be a temporary
+	PageRank(CompactGraph<T>&&,const double=0.85,const double=1e-9,const unsigned int=100,const unsigned int=0)=delete;
+
+	//! Global PageRank, teleporting uniformly to all nodes. The ranks sum to 1
+	Result operator()() const
+	{
+		return iterate(Ranks());
+	}
+
+	/*!
+	 * \brief operator () Personalized PageRank, teleporting uniformly to a set of seed nodes. The ranks sum to 1
+	 * \throw std::out_of_range If seeds is empty or contains an id that is not in the graph
+	 */
+	Result operator()(const std::vector<NodeId>& seeds) const
+	{
+		return iterate(teleport(seeds));
+	}
+
+	/*!
+	 * \brief approximate Approximate personalized PageRank by pushing residual probability from the seeds outwards
+	 * (Andersen, Chung and Lang). Only the nodes that the pushes reach are touched, so the cost depends on epsilon and
+	 * not on the size of the graph. For every node v the result is below its personalized PageRank by at most
+	 * epsilon*W(v)
+	 * \return The nodes with non-zero approximate rank, highest rank first
+	 * \throw std::out_of_range If seeds is empty or contains an id that is not in the graph
+	 */
+	SparseRanks approximate(const std::vector<NodeId>& seeds,const double epsilon) const
+	{
+		check(seeds);
+		const double alpha=1-m_damping;
+		std::unordered_map<NodeId,double> rank,residual;
+		std::deque<NodeId> queue;
+		for(const auto& s:seeds)
+		{
+			double& r=residual[s];
+			if(r==0)
+			{
+				queue.push_back(s);
+			}
+			r+=1.0/seeds.size();
+		}
+		while(not queue.empty())
+		{
+			const NodeId u=queue.front();
+			queue.pop_front();
+			double& r=residual[u];
+			const double ru=r;
+			r=0;
+			if(m_inverseWeight[u]==0)
+			{
+				rank[u]+=ru;
+				continue;
+			}
+			rank[u]+=alpha*ru;
+			const double spread=m_damping*ru*m_inverseWeight[u];
+			const auto weights=m_graph.weights(u);
+			auto w=weights.begin();
+			for(const auto& v:m_graph.neighbors(u))
+			{
+				double& rv=residual[v];
+				const double threshold=epsilon/m_inverseWeight[v];
+				const bool queued=rv>=threshold;
+				rv+=spread**w++;
+				if(not queued and rv>=threshold)
+				{
+					queue.push_back(v);
+				}
+			}
+		}
+		SparseRanks result(rank.begin(),rank.end());
+		std::sort(result.begin(),result.end(),[](const std::pair<NodeId,double>& a,const std::pair<NodeId,double>& b)
+		{
+			return a.second>b.second or (a.second==b.second and a.first<b.first);
+		});
+		return result;
+	}
+private:
+	const CompactGraph<T>& m_graph;
+
+	const double m_damping;
+
+	const double m_tolerance;
+
+	const unsigned int m_maxIterations;
+
+	//! The id range of every thread
+	const std::vector<NodeId> m_ranges;
+
+	//! The NUMA node of every range, or empty
+	const std::vector<unsigned int> m_nodes;
+
+	//! 1/W(u), or 0 for isolated nodes. Written first by the thread of each range
+	Concurrency::UninitializedVector<double> m_inverseWeight;
+
+	void check(const std::vector<NodeId>& seeds) const
+	{
+		if(seeds.empty())
+		{
+			throw std::out_of_range("No seeds");
+		}
+		for(const auto& s:seeds)
+		{
+			if(s>=m_graph.size())
+			{
+				throw std::out_of_range("Seed is not a node id");
+			}
+		}
+	}
+
+	//! The teleport distribution of a seed set
+	Ranks teleport(const std::vector<NodeId>& seeds) const
+	{
+		check(seeds);
+		Ranks result(m_graph.size(),0);
+		for(const auto& s:seeds)
+		{
+			result[s]+=1.0/seeds.size();
+		}
+		return result;
+	}
+
+	//! Power iteration. An empty teleport vector stands for the uniform distribution
+	Result iterate(const Ranks& teleport) const
+	{
+		const NodeId n=m_graph.size();
+		const bool uniform=teleport.empty();
+		Result result{uniform?Ranks(n,n?1.0/n:0):teleport,0,0};
+		if(not n)
+		{
+			return result;
+		}
+		Ranks& rank=result.ranks;
+		Ranks next(n);
+		Concurrency::UninitializedVector<double> scaled(n);
+		const std::size_t parts=m_ranges.size()-1;
+		std::vector<double> partial(parts);
+		while(result.iterations<m_maxIterations)
+		{
+			Concurrency::parallelForRanges(m_ranges,m_nodes,[this,&rank,&scaled,&partial](const std::size_t part,const NodeId first,const NodeId last)
+			{
+				double dangling=0;
+				for(NodeId u=first;u<last;++u)
+				{
+					scaled[u]=m_damping*rank[u]*m_inverseWeight[u];
+					if(m_inverseWeight[u]==0)
+					{
+						dangling+=rank[u];
+					}
+				}
+				partial[part]=dangling;
+			});
+			double dangling=0;
+			for(const auto& p:partial)
+			{
+				dangling+=p;
+			}
+			const double base=1-m_damping+m_damping*dangling;
+			const typename CompactGraph<T>::Offsets& offsets=m_graph.offsets();
+			const typename CompactGraph<T>::Targets& targets=m_graph.targets();
+			const typename CompactGraph<T>::Weights& weights=m_graph.weights();
+			Concurrency::parallelForRanges(m_ranges,m_nodes,[&](const std::size_t part,const NodeId first,const NodeId last)
+			{
+				double distance=0;
+				for(NodeId v=first;v<last;++v)
+				{
+					double sum=base*(uniform?1.0/n:teleport[v]);
+					for(typename CompactGraph<T>::EdgeIndex e=offsets[v];e<offsets[v+1];++e)
+					{
+						sum+=scaled[targets[e]]*weights[e];
+					}
+					next[v]=sum;
+					distance+=std::fabs(sum-rank[v]);
+				}
+				partial[part]=distance;
+			});
+			rank.swap(next);
+			++result.iterations;
+			result.residual=0;
+			for(const auto& p:partial)
+			{
+				result.residual+=p;
+			}
+			if(result.residual<m_tolerance)
+			{
+				break;
+			}
+		}
+		return result;
+	}
+};
+
+}
+
+#endif // Graph_PageRank_H
@@ -0,0 +1,241 @@
+#ifndef Graph_Partitioner_H
+#define Graph_Partitioner_H
+
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include "CompactGraph.h"
+#include "Numa.h"
+
+namespace Graph
+{
+
+//! Splits the nodes of a CompactGraph into a number of partitions, and lays the graph out again with every partition
+//! as a contiguous id range, optionally placed on its own NUMA node.
+//! hash() and range() are cheap and oblivious to the edges. linearDeterministicGreedy() (Stanton and Kliot, "Streaming
+//! Graph Partitioning for Large Distributed Graphs") and fennel() (Tsourakakis et al., "FENNEL: Streaming Graph
+//! Partitioning for Massive Scale Graphs") see every node once, in id order, and put it with most of its already placed
+//! neighbors while keeping the partitions balanced, which cuts far fewer edges
+template<typename T>
+class Partitioner
+{
+public:
+	using NodeId=typename CompactGraph<T>::NodeId;
+
+	using EdgeIndex=typename CompactGraph<T>::EdgeIndex;
+
+	//! The partition of every node id
+	using Assignment=std::vector<unsigned int>;
+
+	//! The partitions as contiguous id ranges
+	struct Layout
+	{
+		//! The new order of the ids: new id i is old id order[i]. Partition by partition, in increasing old id within one
+		std::vector<NodeId> order;
+
+		//! Partition p is the new ids [bounds[p], bounds[p+1])
+		std::vector<NodeId> bounds;
+	};
+
+	/*!
+	 * \brief Partitioner
+	 * \throw std::out_of_range If parts is 0
+	 */
+	Partitioner(const CompactGraph<T>& graph,const unsigned int parts):
+		m_graph(graph),
+		m_parts(parts)
+	{
+		if(not parts)
+		{
+			throw std::out_of_range("No partitions");
+		}
+	}
+
+	//! Assign every node by a hash of its id
+	Assignment hash() const
+	{
+		Assignment result(m_graph.size());
+		for(NodeId n=0;n<result.size();++n)
+		{
+			result[n]=(std::uint64_t(n)*0x9E3779B97F4A7C15ull>>32)%m_parts;
+		}
+		return result;
+	}
+
+	//! Assign contiguous id ranges with about the same number of nodes plus edges each
+	Assignment range() const
+	{
+		const NodeId n=m_graph.size();
+		Assignment result(n);
+		const EdgeIndex total=m_graph.offsets().back()+n;
+		for(NodeId u=0;u<n;++u)
+		{
+			result[u]=std::min<EdgeIndex>(m_parts-1,(m_graph.offsets()[u]+u)*m_parts/total);
+		}
+		return result;
+	}
+
+	/*!
+	 * \brief linearDeterministicGreedy Put every node in the partition with the most of its neighbors, weighted by how
+	 * much room is left in the partition
+	 * \param slack How much larger than n/parts a partition may grow. At least 1
+	 */
+	Assignment linearDeterministicGreedy(const double slack=1.05) const
+	{
+		const double capacity=this->capacity(slack);
+		return stream([capacity](const NodeId neighbors,const NodeId size)
+		{
+			return neighbors*(1-size/capacity);
+		},capacity);
+	}
+
+	/*!
+	 * \brief fennel Put every node in the partition with the most of its neighbors, minus a penalty that grows with the
+	 * size of the partition as alpha*gamma*size^(gamma-1), with alpha=m*parts^(gamma-1)/n^gamma
+	 * \param gamma The exponent of the penalty
+	 * \param slack How much larger than n/parts a partition may grow. At least 1
+	 */
+	Assignment fennel(const double gamma=1.5,const double slack=1.1) const
+	{
+		const double n=m_graph.size();
+		const double alpha=n?m_graph.edgeCount()*std::pow(m_parts,gamma-1)/std::pow(n,gamma):0;
+		return stream([alpha,gamma](const NodeId neighbors,const NodeId size)
+		{
+			return neighbors-alpha*gamma*std::pow(size,gamma-1);
+		},capacity(slack));
+	}
+
+	/*!
+	 * \brief layout The order that makes every partition a contiguous id range
+	 * \throw std::out_of_range If the assignment doesn't fit the graph or the number of partitions
+	 */
+	Layout layout(const Assignment& assignment) const
+	{
+		check(assignment);
+		Layout result{std::vector<NodeId>(assignment.size()),std::vector<NodeId>(m_parts+1,0)};
+		for(const auto& p:assignment)
+		{
+			++result.bounds[p+1];
+		}
+		for(unsigned int p=0;p<m_parts;++p)
+		{
+			result.bounds[p+1]+=result.bounds[p];
+		}
+		std::vector<NodeId> next(result.bounds.begin(),result.bounds.end()-1);
+		for(NodeId n=0;n<assignment.size();++n)
+		{
+			result.order[next[assignment[n]]++]=n;
+		}
+		return result;
+	}
+
+	/*!
+	 * \brief apply The graph laid out by partition, with the arrays of partition p placed on NUMA node placement[p]. The
+	 * labels stay with their nodes
+	 * \param placement The NUMA node of every partition, or empty. Concurrency::numaPlacement() spreads them over all nodes
+	 * \throw std::out_of_range If the assignment doesn't fit the graph or the number of partitions
+	 * \throw std::invalid_argument If there isn't one NUMA node per partition
+	 */
+	CompactGraph<T> apply(const Assignment& assignment,const std::vector<unsigned int>& placement=std::vector<unsigned int>()) const
+	{
+		const Layout l=layout(assignment);
+		return m_graph.permuted(l.order,l.bounds,placement);
+	}
+
+	/*!
+	 * \brief edgeCut The number of edges between different partitions
+	 * \throw std::out_of_range If the assignment doesn't fit the graph or the number of partitions
+	 */
+	EdgeIndex edgeCut(const Assignment& assignment) const
+	{
+		check(assignment);
+		EdgeIndex result=0;
+		for(NodeId u=0;u<assignment.size();++u)
+		{
+			for(const auto& v:m_graph.neighbors(u))
+			{
+				result+=u<v and assignment[u]!=assignment[v];
+			}
+		}
+		return result;
+	}
+private:
+	const CompactGraph<T>& m_graph;
+
+	const unsigned int m_parts;
+
+	void check(const Assignment& assignment) const
+	{
+		if(assignment.size()!=m_graph.size())
+		{
+			throw std::out_of_range("Not one partition per node");
+		}
+		for(const auto& p:assignment)
+		{
+			if(p>=m_parts)
+			{
+				throw std::out_of_range("Not a partition");
+			}
+		}
+	}
+
+	//! The maximum size of a partition. Never less than n/parts rounded up, so all the nodes fit
+	double capacity(const double slack) const
+	{
+		const double even=std::ceil(double(m_graph.size())/m_parts);
+		return std::max(even,std::ceil(slack*m_graph.size()/m_parts));
+	}
+
+	//! One pass over the nodes in id order. Every node goes to the partition that isn't full with the best
+	//! score(neighbors already there, size), the smaller one on ties
+	template<typename S>
+	Assignment stream(const S& score,const double capacity) const
+	{
+		const NodeId n=m_graph.size();
+		const unsigned int none=m_parts;
+		Assignment result(n,none);
+		std::vector<NodeId> sizes(m_parts,0),neighbors(m_parts,0);
+		std::vector<unsigned int> touched;
+		for(NodeId u=0;u<n;++u)
+		{
+			for(const auto& v:m_graph.neighbors(u))
+			{
+				const unsigned int p=result[v];
+				if(p!=none and not neighbors[p]++)
+				{
+					touched.push_back(p);
+				}
+			}
+			unsigned int best=none;
+			double bestScore=-std::numeric_limits<double>::infinity();
+			for(unsigned int p=0;p<m_parts;++p)
+			{
+				if(sizes[p]>=capacity)
+				{
+					continue;
+				}
+				const double s=score(neighbors[p],sizes[p]);
+				if(best==none or s>bestScore or (s==bestScore and sizes[p]<sizes[best]))
+				{
+					best=p;
+					bestScore=s;
+				}
+			}
+			result[u]=best;
+			++sizes[best];
+			for(const auto& p:touched)
+			{
+				neighbors[p]=0;
+			}
+			touched.clear();
+		}
+		return result;
+	}
+};
+
+}
+
+#endif // Graph_Partitioner_H
@@ -0,0 +1,404 @@
+#ifndef Graph_Property_H
+#define Graph_Property_H
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <string>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <limits>
+#include <cmath>
+#include <cctype>
+#include <stdexcept>
+#include <type_traits>
+
+namespace Graph
+{
+
+//! Type-erased column of values indexed by a dense id. This is the interface PropertySet uses to keep columns of
+//! different value types together
+class PropertyColumn
+{
+public:
+	virtual ~PropertyColumn() noexcept=default;
+
+	//! Make room for the ids [0, size). New entries get the default value
+	virtual void resize(const std::size_t size)=0;
+
+	//! Give an entry the default value again. Called when an id is handed out
+	virtual void reset(const std::size_t i)=0;
+
+	//! Write a single value to a stream, so that read() reads it back
+	//! \throw std::invalid_argument If the value can't be written that way
+	virtual void write(std::ostream& o,const std::size_t i) const=0;
+
+	//! Read a single value from a stream
+	virtual void read(std::istream& in,const std::size_t i)=0;
+
+	//! Deep copy
+	virtual std::unique_ptr<PropertyColumn> clone() const=0;
+};
+
+//! How a Property writes its values for UndirectedGraph::save() and reads them back for load(). Values are written
+//! with operator<< and read with operator>>, so the text of a value must be a single non-empty token
+template<typename V,typename Enable=void>
+struct PropertyFormat
+{
+	//! \throw std::invalid_argument If the text of the value is empty or contains whitespace
+	static void write(std::ostream& o,const V& v)
+	{
+		std::ostringstream ss;
+		ss<<v;
+		const std::string text=ss.str();
+		bool token=not text.empty();
+		for(const auto& c:text)
+		{
+			token=token and not std::isspace(static_cast<unsigned char>(c));
+		}
+		if(not token)
+		{
+			throw std::invalid_argument("A property value can't be written as a single token: "+text);
+		}
+		o<<text;
+	}
+
+	static bool read(std::istream& in,V& v)
+	{
+		return bool(in>>v);
+	}
+};
+
+//! Floating-point values are written with as many digits as it takes to read back the same value
+template<typename V>
+struct PropertyFormat<V,typename std::enable_if<std::is_floating_point<V>::value>::type>
+{
+	//! \throw std::invalid_argument If the value is infinite or not a number, which operator>> doesn't read
+	static void write(std::ostream& o,const V& v)
+	{
+		if(not std::isfinite(v))
+		{
+			throw std::invalid_argument("A non-finite property value can't be written");
+		}
+		std::ostringstream ss;
+		ss.precision(std::numeric_limits<V>::max_digits10);
+		ss<<v;
+		o<<ss.str();
+	}
+
+	static bool read(std::istream& in,V& v)
+	{
+		return bool(in>>v);
+	}
+};
+
+//! Strings are written between double quotes, with a backslash before every quote and backslash inside, so that they
+//! can be empty or contain whitespace
+template<>
+struct PropertyFormat<std::string>
+{
+	static void write(std::ostream& o,const std::string& v)
+	{
+		o<<'"';
+		for(const auto& c:v)
+		{
+			if(c=='"' or c=='\\')
+			{
+				o<<'\\';
+			}
+			o<<c;
+		}
+		o<<'"';
+	}
+
+	static bool read(std::istream& in,std::string& v)
+	{
+		char c;
+		if(not (in>>c) or c!='"')
+		{
+			return false;
+		}
+		std::string text;
+		while(in.get(c))
+		{
+			if(c=='"')
+			{
+				v.swap(text);
+				return true;
+			}
+			if(c=='\\' and not in.get(c))
+			{
+				return false;
+			}
+			text.push_back(c);
+		}
+		return false;
+	}
+};
+
+//! A column of values of type V, one per id. Values are stored contiguously, so sweeping over all ids or indexing with the
+//! ids stored in the adjacency lists doesn't involve any hashing.
+//! V needs to be default constructible and copyable. Serialization uses PropertyFormat<V>
+template<typename V>
+class Property:public PropertyColumn
+{
+public:
+	using Value=V;
+	using reference=typename std::vector<V>::reference;
+	using const_reference=typename std::vector<V>::const_reference;
+
+	explicit Property(const V& defaultValue=V()):
+		m_default(defaultValue)
+	{
+	}
+
+	reference operator[](const std::size_t i) noexcept
+	{
+		return m_values[i];
+	}
+
+	const_reference operator[](const std::size_t i) const noexcept
+	{
+		return m_values[i];
+	}
+
+	//! The value that new ids get
+	const V& defaultValue() const noexcept
+	{
+		return m_default;
+	}
+
+	//! The number of entries, which is the size of the id space and not the number of nodes or edges using it
+	std::size_t size() const noexcept
+	{
+		return m_values.size();
+	}
+
+	void resize(const std::size_t size) override
+	{
+		m_values.resize(size,m_default);
+	}
+
+	void reset(const std::size_t i) override
+	{
+		m_values[i]=m_default;
+	}
+
+	void write(std::ostream& o,const std::size_t i) const override
+	{
+		PropertyFormat<V>::write(o,m_values[i]);
+	}
+
+	void read(std::istream& in,const std::size_t i) override
+	{
+		V v;
+		if(not PropertyFormat<V>::read(in,v))
+		{
+			throw std::runtime_error("Malformed property value");
+		}
+		m_values[i]=v;
+	}
+
+	std::unique_ptr<PropertyColumn> clone() const override
+	{
+		return std::unique_ptr<PropertyColumn>(new Property(*this));
+	}
+private:
+	std::vector<V> m_values;
+
+	V m_default;
+};
+
+//! A set of named property columns over the same id space. The columns are resized together as the id space grows
+class PropertySet
+{
+public:
+	//! Thrown when looking up a property that hasn't been added
+	class NoSuchProperty:public std::logic_error
+	{
+	public:
+		using std::logic_error::logic_error;
+	};
+
+	//! Thrown when a property is looked up with a different value type than the one it was added with
+	class PropertyTypeMismatch:public std::logic_error
+	{
+	public:
+		using std::logic_error::logic_error;
+	};
+
+	PropertySet()=default;
+
+	PropertySet(const PropertySet& other):
+		m_size(other.m_size)
+	{
+		for(const auto& c:other.m_columns)
+		{
+			m_columns.insert(std::make_pair(c.first,c.second->clone()));
+		}
+	}
+
+	PropertySet& operator=(const PropertySet& other)
+	{
+		PropertySet copy(other);
+		m_columns.swap(copy.m_columns);
+		m_size=copy.m_size;
+		return *this;
+	}
+
+	PropertySet(PropertySet&&)=default;
+
+	PropertySet& operator=(PropertySet&&)=default;
+
+	/*!
+	 * \brief add Get a property, adding it if it doesn't exist
+	 * \param defaultValue The value of all entries when the property is added, and of all ids handed out later
+	 * \throw PropertyTypeMismatch If the property exists with a different value type
+	 */
+	template<typename V>
+	Property<V>& add(const std::string& name,const V& defaultValue=V())
+	{
+		const Columns::iterator it=m_columns.find(name);
+		if(it!=m_columns.end())
+		{
+			return cast<V>(name,*it->second);
+		}
+		std::unique_ptr<PropertyColumn> column(new Property<V>(defaultValue));
+		column->resize(m_size);
+		return cast<V>(name,*m_columns.insert(std::make_pair(name,std::move(column))).first->second);
+	}
+
+	/*!
+	 * \brief get Get an existing property
+	 * \throw NoSuchProperty If the property doesn't exist
+	 * \throw PropertyTypeMismatch If the property exists with a different value type
+	 */
+	template<typename V>
+	Property<V>& get(const std::string& name)
+	{
+		return cast<V>(name,column(name));
+	}
+
+	//! Const version of get
+	template<typename V>
+	const Property<V>& get(const std::string& name) const
+	{
+		return cast<V>(name,column(name));
+	}
+
+	//! Whether a property exists
+	bool contains(const std::string& name) const noexcept
+	{
+		return m_columns.find(name)!=m_columns.end();
+	}
+
+	/*!
+	 * \brief remove Remove a property and all its values
+	 * \throw NoSuchProperty If the property doesn't exist
+	 */
+	void remove(const std::string& name)
+	{
+		if(not m_columns.erase(name))
+		{
+			throw NoSuchProperty(name);
+		}
+	}
+
+	//! The names of all properties, in lexicographic order
+	std::vector<std::string> names() const
+	{
+		std::vector<std::string> result;
+		for(const auto& c:m_columns)
+		{
+			result.push_back(c.first);
+		}
+		return result;
+	}
+
+	//! Resize all columns to an id space of the given size
+	void resize(const std::size_t size)
+	{
+		for(const auto& c:m_columns)
+		{
+			c.second->resize(size);
+		}
+		m_size=size;
+	}
+
+	//! Reset the entry of an id in all columns to the default value
+	void reset(const std::size_t i)
+	{
+		for(const auto& c:m_columns)
+		{
+			c.second->reset(i);
+		}
+	}
+
+	//! Write the values of an id for a list of properties, each preceded by a space
+	void write(std::ostream& o,const std::vector<std::string>& names,const std::size_t i) const
+	{
+		for(const auto& name:names)
+		{
+			o<<' ';
+			column(name).write(o,i);
+		}
+	}
+
+	//! Read the values of an id for a list of properties
+	void read(std::istream& in,const std::vector<std::string>& names,const std::size_t i)
+	{
+		for(const auto& name:names)
+		{
+			column(name).read(in,i);
+		}
+	}
+private:
+	using Columns=std::map<std::string,std::unique_ptr<PropertyColumn>>;
+
+	Columns m_columns;
+
+	//! The size of the id space, so that columns added later get the right size
+	std::size_t m_size=0;
+
+	PropertyColumn& column(const std::string& name)
+	{
+		return const_cast<PropertyColumn&>(static_cast<const PropertySet&>(*this).column(name));
+	}
+
+	const PropertyColumn& column(const std::string& name) const
+	{
+		const Columns::const_iterator it=m_columns.find(name);
+		if(it==m_columns.end())
+		{
+			throw NoSuchProperty(name);
+		}
+		return *it->second;
+	}
+
+	template<typename V>
+	static Property<V>& cast(const std::string& name,PropertyColumn& column)
+	{
+		Property<V>* const p=dynamic_cast<Property<V>*>(&column);
+		if(not p)
+		{
+			throw PropertyTypeMismatch(name);
+		}
+		return *p;
+	}
+
+	template<typename V>
+	static const Property<V>& cast(const std::string& name,const PropertyColumn& column)
+	{
+		const Property<V>* const p=dynamic_cast<const Property<V>*>(&column);
+		if(not p)
+		{
+			throw PropertyTypeMismatch(name);
+		}
+		return *p;
+	}
+};
+
+}
+
+#endif // Graph_Property_H
@@ -0,0 +1,125 @@
+#ifndef Graph_Range_H
+#define Graph_Range_H
+
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace Graph
+{
+
+//! A non-owning pair of iterators over some storage, usable in range-based for loops and standard algorithms.
+//! The range is invalidated by whatever invalidates its iterators
+template<typename Iterator>
+class Range
+{
+public:
+	using iterator=Iterator;
+	using const_iterator=Iterator;
+	using value_type=typename std::iterator_traits<Iterator>::value_type;
+	using difference_type=typename std::iterator_traits<Iterator>::difference_type;
+	using size_type=std::size_t;
+
+	Range(const Iterator& begin,const Iterator& end) noexcept:
+		m_begin(begin),
+		m_end(end)
+	{
+	}
+
+	Iterator begin() const noexcept
+	{
+		return m_begin;
+	}
+
+	Iterator end() const noexcept
+	{
+		return m_end;
+	}
+
+	bool empty() const noexcept
+	{
+		return m_begin==m_end;
+	}
+
+	//! Linear for iterators that are not random access
+	size_type size() const noexcept
+	{
+		return std::distance(m_begin,m_end);
+	}
+
+	//! Only for random access iterators
+	typename std::iterator_traits<Iterator>::reference operator[](const size_type i) const noexcept
+	{
+		return m_begin[i];
+	}
+private:
+	Iterator m_begin;
+
+	Iterator m_end;
+};
+
+
+//! Iterator adapter that yields a part of the values of another iterator, such as the keys of a map, without copying them.
+//! P is a default constructible function object type that takes a value of Iterator and returns a const reference into it
+template<typename Iterator,typename P>
+class ProjectionIterator
+{
+public:
+	using iterator_category=std::forward_iterator_tag;
+	using value_type=typename std::decay<decltype(P()(*std::declval<Iterator>()))>::type;
+	using difference_type=typename std::iterator_traits<Iterator>::difference_type;
+	using pointer=const value_type*;
+	using reference=const value_type&;
+
+	ProjectionIterator()=default;
+
+	explicit ProjectionIterator(const Iterator& it) noexcept:
+		m_it(it)
+	{
+	}
+
+	reference operator*() const noexcept
+	{
+		return P()(*m_it);
+	}
+
+	pointer operator->() const noexcept
+	{
+		return &P()(*m_it);
+	}
+
+	ProjectionIterator& operator++() noexcept
+	{
+		++m_it;
+		return *this;
+	}
+
+	ProjectionIterator operator++(int) noexcept
+	{
+		const ProjectionIterator result(*this);
+		++m_it;
+		return result;
+	}
+
+	bool operator==(const ProjectionIterator& other) const noexcept
+	{
+		return m_it==other.m_it;
+	}
+
+	bool operator!=(const ProjectionIterator& other) const noexcept
+	{
+		return m_it!=other.m_it;
+	}
+
+	//! The underlying iterator
+	const Iterator& base() const noexcept
+	{
+		return m_it;
+	}
+private:
+	Iterator m_it;
+};
+
+}
+
+#endif // Graph_Range_H
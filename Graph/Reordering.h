@@ -0,0 +1,253 @@
+#ifndef Graph_Reordering_H
+#define Graph_Reordering_H
+
+#include <vector>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include "CompactGraph.h"
+#include "BoundedBreadthFirstSearch.h"
+#include "Louvain.h"
+
+namespace Graph
+{
+
+//! Computes node orders that put neighbors close together in the id space, so that analytics on the reordered graph
+//! touch nearby memory: Reverse Cuthill-McKee, degree-descending, breadth-first and community order. Compute an order
+//! once, then apply() it to get the reordered CompactGraph and run the analytics on that.
+//! Every order also comes with its inverse, to translate results back to the ids of the original graph
+template<typename T>
+class Reordering
+{
+public:
+	using NodeId=typename CompactGraph<T>::NodeId;
+
+	//! A renumbering of the ids
+	struct Permutation
+	{
+		//! New id i is old id order[i]
+		std::vector<NodeId> order;
+
+		//! The new id of every old id: the inverse of order
+		std::vector<NodeId> position;
+	};
+
+	explicit Reordering(const CompactGraph<T>& graph) noexcept:
+		m_graph(graph)
+	{
+	}
+
+	//! Reverse Cuthill-McKee: breadth-first from a pseudo-peripheral node of every component, expanding the neighbors by
+	//! increasing degree, then reversed. Keeps the edges close to the diagonal of the adjacency matrix
+	Permutation reverseCuthillMcKee() const
+	{
+		const NodeId n=m_graph.size();
+		std::vector<NodeId> starts(n);
+		std::iota(starts.begin(),starts.end(),0);
+		std::stable_sort(starts.begin(),starts.end(),byDegree());
+		std::vector<bool> placed(n,false);
+		std::vector<NodeId> order,buffer;
+		order.reserve(n);
+		for(const auto& s:starts)
+		{
+			if(placed[s])
+			{
+				continue;
+			}
+			const NodeId root=peripheral(s);
+			placed[root]=true;
+			order.push_back(root);
+			for(std::size_t next=order.size()-1;next<order.size();++next)
+			{
+				buffer.clear();
+				for(const auto& v:m_graph.neighbors(order[next]))
+				{
+					if(not placed[v])
+					{
+						placed[v]=true;
+						buffer.push_back(v);
+					}
+				}
+				std::stable_sort(buffer.begin(),buffer.end(),byDegree());
+				order.insert(order.end(),buffer.begin(),buffer.end());
+			}
+		}
+		std::reverse(order.begin(),order.end());
+		return permutation(std::move(order));
+	}
+
+	//! The nodes by decreasing degree, ties by id. Packs the hubs, which most edges lead to, at the front
+	Permutation degreeDescending() const
+	{
+		std::vector<NodeId> order(m_graph.size());
+		std::iota(order.begin(),order.end(),0);
+		std::stable_sort(order.begin(),order.end(),[this](const NodeId a,const NodeId b)
+		{
+			return m_graph.degree(a)>m_graph.degree(b);
+		});
+		return permutation(std::move(order));
+	}
+
+	//! Breadth-first order, component by component from the lowest id not placed yet
+	Permutation breadthFirst() const
+	{
+		const NodeId n=m_graph.size();
+		BoundedBreadthFirstSearch& search=BoundedBreadthFirstSearch::local();
+		std::vector<bool> placed(n,false);
+		std::vector<NodeId> order;
+		order.reserve(n);
+		for(NodeId s=0;s<n;++s)
+		{
+			if(not placed[s])
+			{
+				for(const auto& v:search(m_graph,{s},s_unlimited))
+				{
+					placed[v.node]=true;
+					order.push_back(v.node);
+				}
+			}
+		}
+		return permutation(std::move(order));
+	}
+
+	/*!
+	 * \brief community Community order, in the spirit of Rabbit Order: the Louvain communities one after the other, in
+	 * the order of their lowest ids, and the nodes of every community in breadth-first order within it
+	 * \param resolution See Louvain
+	 * \param threads The number of threads of Louvain. 0 means Concurrency::hardwareThreads()
+	 */
+	Permutation community(const double resolution=1,const unsigned int threads=0) const
+	{
+		const NodeId n=m_graph.size();
+		const typename Louvain<T>::Membership membership=Louvain<T>(m_graph,resolution,1e-7,threads).membership();
+		//Group the members of every community, numbering the communities by their lowest id
+		std::vector<NodeId> rank(n,n),bounds(1,0);
+		for(NodeId u=0;u<n;++u)
+		{
+			if(rank[membership[u]]==n)
+			{
+				rank[membership[u]]=bounds.size()-1;
+				bounds.push_back(0);
+			}
+			++bounds[rank[membership[u]]+1];
+		}
+		std::partial_sum(bounds.begin(),bounds.end(),bounds.begin());
+		std::vector<NodeId> members(n),next(bounds.begin(),bounds.end()-1);
+		for(NodeId u=0;u<n;++u)
+		{
+			members[next[rank[membership[u]]]++]=u;
+		}
+		BoundedBreadthFirstSearch& search=BoundedBreadthFirstSearch::local();
+		std::vector<bool> placed(n,false);
+		std::vector<NodeId> order;
+		order.reserve(n);
+		for(const auto& s:members)
+		{
+			if(placed[s])
+			{
+				continue;
+			}
+			const NodeId c=membership[s];
+			for(const auto& v:search(m_graph,{s},s_unlimited,[&membership,c](const NodeId v)
+			{
+				return membership[v]==c;
+			}))
+			{
+				placed[v.node]=true;
+				order.push_back(v.node);
+			}
+		}
+		return permutation(std::move(order));
+	}
+
+	/*!
+	 * \brief apply The graph with its ids renumbered by a permutation. The labels stay with their nodes
+	 * \throw std::invalid_argument If the permutation doesn't fit the graph
+	 */
+	CompactGraph<T> apply(const Permutation& permutation) const
+	{
+		return m_graph.permuted(permutation.order);
+	}
+
+	//! The largest distance between the new ids of two neighbors
+	NodeId bandwidth(const Permutation& permutation) const
+	{
+		NodeId result=0;
+		for(NodeId u=0;u<m_graph.size();++u)
+		{
+			for(const auto& v:m_graph.neighbors(u))
+			{
+				if(permutation.position[u]<permutation.position[v])
+				{
+					result=std::max(result,permutation.position[v]-permutation.position[u]);
+				}
+			}
+		}
+		return result;
+	}
+private:
+	const CompactGraph<T>& m_graph;
+
+	static const unsigned int s_unlimited=std::numeric_limits<unsigned int>::max();
+
+	//! Orders ids by increasing degree
+	struct ByDegree
+	{
+		const CompactGraph<T>& graph;
+
+		bool operator()(const NodeId a,const NodeId b) const noexcept
+		{
+			return graph.degree(a)<graph.degree(b);
+		}
+	};
+
+	ByDegree byDegree() const noexcept
+	{
+		return ByDegree{m_graph};
+	}
+
+	//! A node of the component of start at about the largest distance from the rest, found as George and Liu do: move to
+	//! the lowest degree node of the last breadth-first level for as long as that increases the eccentricity
+	NodeId peripheral(NodeId start) const
+	{
+		BoundedBreadthFirstSearch& search=BoundedBreadthFirstSearch::local();
+		unsigned int eccentricity=0;
+		while(true)
+		{
+			const BoundedBreadthFirstSearch::Visits& visits=search(m_graph,{start},s_unlimited);
+			const unsigned int depth=visits.back().depth;
+			if(depth<=eccentricity)
+			{
+				return start;
+			}
+			eccentricity=depth;
+			NodeId next=visits.back().node;
+			for(auto it=visits.rbegin();it!=visits.rend() and it->depth==depth;++it)
+			{
+				if(m_graph.degree(it->node)<=m_graph.degree(next))
+				{
+					next=it->node;
+				}
+			}
+			start=next;
+		}
+	}
+
+	static Permutation permutation(std::vector<NodeId>&& order)
+	{
+		std::vector<NodeId> position(order.size());
+		for(NodeId i=0;i<order.size();++i)
+		{
+			position[order[i]]=i;
+		}
+		return Permutation{std::move(order),std::move(position)};
+	}
+};
+
+template<typename T>
+const unsigned int Reordering<T>::s_unlimited;
+
+}
+
+#endif // Graph_Reordering_H
@@ -0,0 +1,143 @@
+#ifndef Graph_SemiExternal_H
+#define Graph_SemiExternal_H
+
+#include <vector>
+#include <cstdint>
+#include "EdgeFile.h"
+#include "DisjointSets.h"
+
+namespace Graph
+{
+
+//! Connected components of a graph too large for memory, in the semi-external model: the union-find over the node ids
+//! is kept in memory, while the edges are streamed from an edge file in one sequential pass, joining the endpoints of
+//! every edge. Memory is O(nodes) plus one block, whatever the number of edges
+class SemiExternalComponents
+{
+public:
+	using NodeId=EdgeFile::NodeId;
+
+	using Components=SetOperations::DisjointSets<NodeId>;
+
+	explicit SemiExternalComponents(EdgeFileReader& reader) noexcept:
+		m_reader(reader)
+	{
+	}
+
+	/*!
+	 * \brief operator () The components, over all the ids below the reader's nodeBound()
+	 * \throw std::system_error If reading fails
+	 * \throw std::runtime_error If the file is not a well-formed edge file
+	 */
+	Components operator()() const
+	{
+		Components result;
+		for(NodeId n=0;n<m_reader.nodeBound();++n)
+		{
+			result.add(n);
+		}
+		m_reader.forEachEdge([&result](const NodeId n1,const NodeId n2)
+		{
+			result.join(n1,n2);
+		});
+		return result;
+	}
+private:
+	EdgeFileReader& m_reader;
+};
+
+//! The k-core of a graph too large for memory. Only a degree counter and a state per node are kept in memory. A first
+//! pass over the edge file counts the degrees, then every pass peels the nodes that dropped below k in the previous
+//! one, decrementing the degrees of their remaining neighbors. The number of passes is at most the number of peeling
+//! rounds plus one; see the reader's statistics()
+class SemiExternalKCore
+{
+public:
+	using NodeId=EdgeFile::NodeId;
+
+	SemiExternalKCore(EdgeFileReader& reader,const unsigned int k) noexcept:
+		m_reader(reader),
+		m_k(k)
+	{
+	}
+
+	/*!
+	 * \brief operator () The ids of the nodes in the k-core, in increasing order
+	 * \throw std::system_error If reading fails
+	 * \throw std::runtime_error If the file is not a well-formed edge file
+	 */
+	std::vector<NodeId> operator()() const
+	{
+		const NodeId n=m_reader.nodeBound();
+		std::vector<std::uint32_t> degrees(n,0);
+		m_reader.forEachEdge([&degrees](const NodeId n1,const NodeId n2)
+		{
+			++degrees[n1];
+			++degrees[n2];
+		});
+		std::vector<State> states(n,Alive);
+		bool peeling=mark(degrees,states);
+		while(peeling)
+		{
+			m_reader.forEachEdge([&degrees,&states](const NodeId n1,const NodeId n2)
+			{
+				if(states[n1]==Peeling and states[n2]==Alive)
+				{
+					--degrees[n2];
+				}
+				else if(states[n2]==Peeling and states[n1]==Alive)
+				{
+					--degrees[n1];
+				}
+			});
+			for(auto& s:states)
+			{
+				if(s==Peeling)
+				{
+					s=Removed;
+				}
+			}
+			peeling=mark(degrees,states);
+		}
+		std::vector<NodeId> result;
+		for(NodeId u=0;u<n;++u)
+		{
+			if(states[u]==Alive)
+			{
+				result.push_back(u);
+			}
+		}
+		return result;
+	}
+private:
+	enum State:unsigned char
+	{
+		Alive,
+		//! Dropped below k in the last round; its edges still have to be subtracted
+		Peeling,
+		Removed
+	};
+
+	EdgeFileReader& m_reader;
+
+	const unsigned int m_k;
+
+	//! Mark the live nodes below k for peeling. Returns whether there are any
+	bool mark(const std::vector<std::uint32_t>& degrees,std::vector<State>& states) const noexcept
+	{
+		bool result=false;
+		for(NodeId u=0;u<degrees.size();++u)
+		{
+			if(states[u]==Alive and degrees[u]<m_k)
+			{
+				states[u]=Peeling;
+				result=true;
+			}
+		}
+		return result;
+	}
+};
+
+}
+
+#endif // Graph_SemiExternal_H
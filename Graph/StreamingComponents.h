@@ -0,0 +1,220 @@
+#ifndef Graph_StreamingComponents_H
+#define Graph_StreamingComponents_H
+
+#include <map>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include "UndirectedGraph.h"
+#include "DisjointSets.h"
+
+namespace Graph
+{
+
+//! Connected components of an unbounded stream of edges, without storing the edges. Only the nodes are kept, in
+//! SetOperations::DisjointSets. Edges are buffered in batches of node indices; a batch is deduplicated, so that
+//! repeated edges cost one hash lookup per endpoint and nothing more, then linked by index into the disjoint sets
+//! without any further hashing. Memory is O(nodes) plus one batch.
+//! Queries merge the pending batch first, so they always reflect every edge added
+template<typename T>
+class StreamingComponents
+{
+public:
+	using Node=T;
+
+	using NoSuchNode=typename UndirectedGraph<T>::NoSuchNode;
+
+	//! The number of components of every size, by size
+	using SizeHistogram=std::map<std::size_t,std::size_t>;
+
+	static const std::size_t s_defaultBatchSize=1<<16;
+
+	explicit StreamingComponents(const std::size_t batchSize=s_defaultBatchSize):
+		m_batchSize(std::max<std::size_t>(1,batchSize))
+	{
+		m_batch.reserve(m_batchSize);
+	}
+
+	//! Add a node in a component of its own, unless it is already known
+	void insert(const Node& node)
+	{
+		index(node);
+	}
+
+	//! Add an edge, and its endpoints if they are new. The edge is merged with its batch
+	void edge(const Node& n1,const Node& n2)
+	{
+		const Index i1=index(n1),i2=index(n2);
+		if(i1!=i2)
+		{
+			m_batch.push_back(std::minmax(i1,i2));
+			if(m_batch.size()==m_batchSize)
+			{
+				flush();
+			}
+		}
+	}
+
+	//! The number of nodes seen
+	std::size_t size() const noexcept
+	{
+		return m_components.size();
+	}
+
+	bool contains(const Node& node) const
+	{
+		return m_components.tryIndex(node)<m_components.size();
+	}
+
+	//! The number of components
+	std::size_t componentCount() const
+	{
+		flush();
+		return m_components.setCount();
+	}
+
+	/*!
+	 * \brief sameComponent Whether two nodes are connected
+	 * \throw NoSuchNode If a node has never been seen
+	 */
+	bool sameComponent(const Node& n1,const Node& n2) const
+	{
+		flush();
+		return m_components.root(existingIndex(n1))==m_components.root(existingIndex(n2));
+	}
+
+	/*!
+	 * \brief component The representative of a node's component: the same node for all the members of a component
+	 * until the component grows
+	 * \throw NoSuchNode If the node has never been seen
+	 */
+	const Node& component(const Node& node) const
+	{
+		flush();
+		return m_components.element(m_components.root(existingIndex(node)));
+	}
+
+	/*!
+	 * \brief componentSize The number of nodes in a node's component
+	 * \throw NoSuchNode If the node has never been seen
+	 */
+	std::size_t componentSize(const Node& node) const
+	{
+		flush();
+		return m_components.rootSize(m_components.root(existingIndex(node)));
+	}
+
+	//! The number of components of every size, kept up to date with every merge
+	const SizeHistogram& sizeHistogram() const
+	{
+		flush();
+		return m_histogram;
+	}
+private:
+	//! The disjoint sets of the nodes, reached by index so that the batches are merged without hashing
+	class Components:public SetOperations::DisjointSets<T>
+	{
+		using Base=SetOperations::DisjointSets<T>;
+	public:
+		using typename Base::Index;
+
+		using Base::root;
+
+		using Base::link;
+
+		//! The index of an element, or size() if it's not there
+		Index tryIndex(const T& x) const noexcept
+		{
+			const auto it=Base::m_indices.find(x);
+			return it==Base::m_indices.end()?Base::size():it->second;
+		}
+
+		const T& element(const Index i) const noexcept
+		{
+			return Base::m_values[i];
+		}
+
+		//! The number of elements in the set of a root
+		std::size_t rootSize(const Index r) const noexcept
+		{
+			return Base::m_sizes[r];
+		}
+	};
+
+	using Index=typename Components::Index;
+
+	const std::size_t m_batchSize;
+
+	//! Merging the pending batch doesn't change the components that the queries see, so the const queries do it
+	mutable Components m_components;
+
+	mutable SizeHistogram m_histogram;
+
+	//! The edges not merged yet, as pairs of indices with the smaller index first
+	mutable std::vector<std::pair<Index,Index>> m_batch;
+
+	//! The index of a node, adding it in a component of its own if it's new
+	Index index(const Node& node)
+	{
+		const Index i=m_components.tryIndex(node);
+		if(i<m_components.size())
+		{
+			return i;
+		}
+		m_components.add(node);
+		++m_histogram[1];
+		return i;
+	}
+
+	Index existingIndex(const Node& node) const
+	{
+		const Index i=m_components.tryIndex(node);
+		if(i==m_components.size())
+		{
+			throw NoSuchNode(node);
+		}
+		return i;
+	}
+
+	//! Merge the pending batch into the components
+	void flush() const
+	{
+		std::sort(m_batch.begin(),m_batch.end());
+		m_batch.erase(std::unique(m_batch.begin(),m_batch.end()),m_batch.end());
+		for(const auto& e:m_batch)
+		{
+			join(e.first,e.second);
+		}
+		m_batch.clear();
+	}
+
+	void join(Index x,Index y) const
+	{
+		x=m_components.root(x);
+		y=m_components.root(y);
+		if(x==y)
+		{
+			return;
+		}
+		forget(m_components.rootSize(x));
+		forget(m_components.rootSize(y));
+		++m_histogram[m_components.rootSize(m_components.link(x,y))];
+	}
+
+	//! Remove a component of a size from the histogram
+	void forget(const std::size_t size) const
+	{
+		const typename SizeHistogram::iterator it=m_histogram.find(size);
+		if(not --it->second)
+		{
+			m_histogram.erase(it);
+		}
+	}
+};
+
+template<typename T>
+const std::size_t StreamingComponents<T>::s_defaultBatchSize;
+
+}
+
+#endif // Graph_StreamingComponents_H
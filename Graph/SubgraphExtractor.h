@@ -0,0 +1,247 @@
+#ifndef Graph_SubgraphExtractor_H
+#define Graph_SubgraphExtractor_H
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include "CompactGraph.h"
+#include "BoundedBreadthFirstSearch.h"
+#include "ParallelFor.h"
+
+namespace Graph
+{
+
+//! Extracts subgraphs of a CompactGraph as new CompactGraphs: induced by a node set, by an edge set, or by the
+//! neighborhood of some centers (ego networks). Membership is marked in a bitmap over the parent ids, the output arrays
+//! are sized exactly by a counting pass, and the adjacency of the members is filtered in parallel.
+//! The subgraph numbers its nodes in the order of their parent ids, so neighbor lists stay sorted without sorting them
+template<typename T>
+class SubgraphExtractor
+{
+public:
+	using NodeId=typename CompactGraph<T>::NodeId;
+
+	using Edge=std::pair<NodeId,NodeId>;
+
+	//! An extracted subgraph
+	struct Result
+	{
+		CompactGraph<T> graph;
+
+		//! The id in the parent graph of every node of the subgraph, in increasing order. The labels of the subgraph
+		//! are the labels of the parent nodes
+		std::vector<NodeId> parentIds;
+	};
+
+	//! \param threads The number of threads. 0 means Concurrency::hardwareThreads()
+	explicit SubgraphExtractor(const CompactGraph<T>& graph,const unsigned int threads=0) noexcept:
+		m_graph(graph),
+		m_threads(threads)
+	{
+	}
+
+	/*!
+	 * \brief induced The subgraph induced by a node set: the nodes and all the edges between them. Duplicate ids are ignored
+	 * \throw std::out_of_range If an id is not a node id
+	 */
+	Result induced(std::vector<NodeId> nodes) const
+	{
+		std::sort(nodes.begin(),nodes.end());
+		nodes.erase(std::unique(nodes.begin(),nodes.end()),nodes.end());
+		check(nodes);
+		Bitmap members(m_graph.size());
+		for(const auto& n:nodes)
+		{
+			members.set(n);
+		}
+		return build(std::move(nodes),members);
+	}
+
+	/*!
+	 * \brief edgeInduced The subgraph made of a set of edges and their endpoints. Duplicate edges are ignored
+	 * \throw std::out_of_range If an id is not a node id
+	 * \throw typename UndirectedGraph<T>::NoSuchEdge If an edge doesn't exist
+	 */
+	Result edgeInduced(const std::vector<Edge>& edges) const
+	{
+		std::vector<NodeId> nodes;
+		nodes.reserve(2*edges.size());
+		for(const auto& e:edges)
+		{
+			nodes.push_back(e.first);
+			nodes.push_back(e.second);
+		}
+		std::sort(nodes.begin(),nodes.end());
+		nodes.erase(std::unique(nodes.begin(),nodes.end()),nodes.end());
+		check(nodes);
+		std::vector<Arc> arcs;
+		arcs.reserve(2*edges.size());
+		for(const auto& e:edges)
+		{
+			const typename CompactGraph<T>::EdgeWeight w=m_graph.edgeWeight(e.first,e.second);
+			const NodeId u=std::lower_bound(nodes.begin(),nodes.end(),e.first)-nodes.begin();
+			const NodeId v=std::lower_bound(nodes.begin(),nodes.end(),e.second)-nodes.begin();
+			arcs.push_back(Arc{u,v,w});
+			arcs.push_back(Arc{v,u,w});
+		}
+		std::sort(arcs.begin(),arcs.end());
+		arcs.erase(std::unique(arcs.begin(),arcs.end()),arcs.end());
+		const NodeId k=nodes.size();
+		typename CompactGraph<T>::Offsets offsets(k+1,0);
+		typename CompactGraph<T>::Targets targets(arcs.size());
+		typename CompactGraph<T>::Weights weights(arcs.size());
+		for(std::size_t i=0;i<arcs.size();++i)
+		{
+			++offsets[arcs[i].source+1];
+			targets[i]=arcs[i].target;
+			weights[i]=arcs[i].weight;
+		}
+		for(NodeId i=0;i<k;++i)
+		{
+			offsets[i+1]+=offsets[i];
+		}
+		return Result{CompactGraph<T>(labels(nodes),std::move(offsets),std::move(targets),std::move(weights)),std::move(nodes)};
+	}
+
+	/*!
+	 * \brief ego The subgraph induced by the nodes within a number of hops from a set of centers. The search uses the
+	 * workspace of the calling thread
+	 * \throw std::out_of_range If an id is not a node id
+	 */
+	Result ego(const std::vector<NodeId>& centers,const unsigned int hops) const
+	{
+		const BoundedBreadthFirstSearch::Visits& visits=BoundedBreadthFirstSearch::local()(m_graph,centers,hops);
+		Bitmap members(m_graph.size());
+		std::vector<NodeId> nodes;
+		nodes.reserve(visits.size());
+		for(const auto& v:visits)
+		{
+			members.set(v.node);
+			nodes.push_back(v.node);
+		}
+		std::sort(nodes.begin(),nodes.end());
+		return build(std::move(nodes),members);
+	}
+private:
+	//! One bit per parent node id
+	class Bitmap
+	{
+	public:
+		explicit Bitmap(const std::size_t size):
+			m_words((size+63)/64,0)
+		{
+		}
+
+		void set(const std::size_t i) noexcept
+		{
+			m_words[i/64]|=std::uint64_t(1)<<(i%64);
+		}
+
+		bool test(const std::size_t i) const noexcept
+		{
+			return m_words[i/64]>>(i%64)&1;
+		}
+	private:
+		std::vector<std::uint64_t> m_words;
+	};
+
+	//! An edge as stored at one endpoint, in subgraph ids
+	struct Arc
+	{
+		NodeId source;
+
+		NodeId target;
+
+		typename CompactGraph<T>::EdgeWeight weight;
+
+		bool operator<(const Arc& other) const noexcept
+		{
+			return source<other.source or (source==other.source and target<other.target);
+		}
+
+		bool operator==(const Arc& other) const noexcept
+		{
+			return source==other.source and target==other.target;
+		}
+	};
+
+	const CompactGraph<T>& m_graph;
+
+	const unsigned int m_threads;
+
+	void check(const std::vector<NodeId>& nodes) const
+	{
+		for(const auto& n:nodes)
+		{
+			if(n>=m_graph.size())
+			{
+				throw std::out_of_range("Not a node id");
+			}
+		}
+	}
+
+	std::vector<typename CompactGraph<T>::Label> labels(const std::vector<NodeId>& nodes) const
+	{
+		std::vector<typename CompactGraph<T>::Label> result;
+		result.reserve(nodes.size());
+		for(const auto& n:nodes)
+		{
+			result.push_back(m_graph.label(n));
+		}
+		return result;
+	}
+
+	//! Build the subgraph induced by the sorted nodes, which are exactly the ones set in members. The first parallel pass
+	//! counts the surviving neighbors of every node, the second one copies them into the exactly sized arrays
+	Result build(std::vector<NodeId>&& nodes,const Bitmap& members) const
+	{
+		const NodeId k=nodes.size();
+		typename CompactGraph<T>::Offsets offsets(k+1,0);
+		Concurrency::parallelFor(0,k,[this,&nodes,&members,&offsets](const std::size_t first,const std::size_t last)
+		{
+			for(std::size_t i=first;i<last;++i)
+			{
+				typename CompactGraph<T>::EdgeIndex count=0;
+				for(const auto& v:m_graph.neighbors(nodes[i]))
+				{
+					count+=members.test(v);
+				}
+				offsets[i+1]=count;
+			}
+		},m_threads);
+		for(NodeId i=0;i<k;++i)
+		{
+			offsets[i+1]+=offsets[i];
+		}
+		typename CompactGraph<T>::Targets targets(offsets.back());
+		typename CompactGraph<T>::Weights weights(offsets.back());
+		Concurrency::parallelFor(0,k,[&](const std::size_t first,const std::size_t last)
+		{
+			for(std::size_t i=first;i<last;++i)
+			{
+				typename CompactGraph<T>::EdgeIndex e=offsets[i];
+				//Both the neighbors and the members are sorted, so the search for the next neighbor starts after the last one
+				typename std::vector<NodeId>::const_iterator position=nodes.begin();
+				const auto parentWeights=m_graph.weights(nodes[i]);
+				auto w=parentWeights.begin();
+				for(const auto& v:m_graph.neighbors(nodes[i]))
+				{
+					if(members.test(v))
+					{
+						position=std::lower_bound(position,nodes.cend(),v);
+						targets[e]=position-nodes.begin();
+						weights[e++]=*w;
+					}
+					++w;
+				}
+			}
+		},m_threads);
+		return Result{CompactGraph<T>(labels(nodes),std::move(offsets),std::move(targets),std::move(weights)),std::move(nodes)};
+	}
+};
+
+}
+
+#endif // Graph_SubgraphExtractor_H
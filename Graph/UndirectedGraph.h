@@ -6,29 +6,51 @@
 #include <sstream>
 #include <functional>
 #include <set>
-#include "BreadthFirstVisitor.h"
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "GraphObserver.h"
+#include "Property.h"
+#include "Range.h"
+#include "ParallelFor.h"
 
 namespace Graph
 {
 
-//! Undirected graph data template. All sets in the API are unordered
+//! The types of UndirectedGraph that don't depend on its observers, so that they are shared by the graphs of a node
+//! type whatever their observers: an exception thrown by any of them can be caught as UndirectedGraph<T>::NoSuchNode
 template<typename T>
-class UndirectedGraph
+class GraphTypes
 {
 public:
 	using Node=T;
 
 	using EdgeWeight=unsigned int;
-private:	
-	//! The default edge weight. It is used by the interface that inserts edges without weight
-	static const EdgeWeight s_defaultEdgeWeight=1;
+
+	//! Every node gets a dense id when it's inserted. Ids of removed nodes are handed out again,
+	//! so the ids stay within [0, nodeIdBound()) and can index contiguous arrays such as node properties
+	using NodeId=unsigned int;
+
+	//! Every edge gets a dense slot when it's inserted, shared by both endpoints. Slots of removed edges are handed out again,
+	//! so they stay within [0, edgeIdBound()) and can index contiguous arrays such as edge properties
+	using EdgeId=std::size_t;
 
 	//! Holds a node and weight pair, representing an entry in the adjacency list
 	struct Neighbor
 	{
 		Node node;
 
-		EdgeWeight weight;
+		//! Mutable, because the hash and equality of a Neighbor depend only on the node. This lets the weight of an edge be
+		//! changed in place inside the adjacency lists
+		mutable EdgeWeight weight;
+
+		//! The slot of the edge. It's the same at both endpoints. Only meaningful in adjacency lists owned by a graph
+		EdgeId edge;
+
+		//! The id of the neighbor node, so that its node properties can be reached without hashing.
+		//! Only meaningful in adjacency lists owned by a graph
+		NodeId id;
 
 		operator const Node&() const noexcept
 		{
@@ -45,11 +67,14 @@ private:
 			return node<other.node;
 		}
 
-		friend std::ostream& operator<<(std::ostream& o,const typename Graph::UndirectedGraph<T>::Neighbor& n) noexcept
+		friend std::ostream& operator<<(std::ostream& o,const Neighbor& n) noexcept
 		{
 			return o<<'('<<n.node<<" w = "<<n.weight<<')';
 		}
 	};
+protected:
+	//! The default edge weight. It is used by the interface that inserts edges without weight
+	static const EdgeWeight s_defaultEdgeWeight=1;
 
 	//! Hashing struct for Neighbor. It is not declared as a specialization of std::hash because it is syntatically impossible
 	//! to do in C++ with templates
@@ -60,6 +85,15 @@ private:
 			return std::hash<Node>()(n.node);
 		}
 	};
+
+	//! Projects an adjacency list entry to its node, for views of the neighbors without the weights
+	struct NeighborNode
+	{
+		const Node& operator()(const Neighbor& n) const noexcept
+		{
+			return n.node;
+		}
+	};
 public:
 	using NodeSet=std::unordered_set<Node>;
 
@@ -82,7 +116,8 @@ public:
 			}
 		}
 
-		operator NodeSet() const noexcept
+		//! Copy the neighbor nodes into a set. Use nodesView() to iterate over them without copying
+		explicit operator NodeSet() const noexcept
 		{
 			NodeSet ret;
 			for(const auto& n:*this)
@@ -108,6 +143,14 @@ public:
 
 		using size_type=typename std::unordered_set<Neighbor,NeighborHash>::size_type;
 
+		using NodeView=Range<ProjectionIterator<const_iterator,NeighborNode>>;
+
+		//! The neighbor nodes without the weights, iterating over the list itself
+		NodeView nodesView() const noexcept
+		{
+			return NodeView(typename NodeView::iterator(this->begin()),typename NodeView::iterator(this->end()));
+		}
+
 		size_type erase(const Node& n) noexcept
 		{
 			return std::unordered_set<Neighbor,NeighborHash>::erase({n,0});
@@ -125,7 +168,7 @@ public:
 
 		using std::unordered_set<Neighbor,NeighborHash>::insert;
 
-		friend std::ostream& operator<<(std::ostream& o,const typename Graph::UndirectedGraph<T>::AdjacencyList& nodes) noexcept
+		friend std::ostream& operator<<(std::ostream& o,const AdjacencyList& nodes) noexcept
 		{
 			return prettyPrintNodeList(o,nodes);
 		}
@@ -133,25 +176,91 @@ public:
 
 	//! Alias for size_t in most systems
 	using NodeDegree=typename AdjacencyList::size_type;
-private:
-	//! The internal data structure for the graph is a hashmap
-	using Container=std::unordered_map<Node,AdjacencyList>;
-public:
-	//! Alias for size_t in most systems
-	using GraphSize=typename Container::size_type;
-private:
+
+	//! The nodes of a batch, see UndirectedGraph::insertEdges()
+	using NodeList=std::vector<Node>;
+
+	//! An edge of a batch, see UndirectedGraph::insertEdges()
+	struct Edge
+	{
+		Edge(const Node& n1,const Node& n2,const EdgeWeight weight=s_defaultEdgeWeight):
+			n1(n1),
+			n2(n2),
+			weight(weight)
+		{
+		}
+
+		Node n1;
+
+		Node n2;
+
+		EdgeWeight weight;
+	};
+
+	using EdgeList=std::vector<Edge>;
+
+	//! A change of the weight of an edge, as given to the observers of a graph
+	struct WeightChange
+	{
+		Node n1;
+
+		Node n2;
+
+		EdgeWeight oldWeight;
+
+		EdgeWeight newWeight;
+	};
+
+	using WeightChangeList=std::vector<WeightChange>;
+protected:
+	//! The message of a NodeException or EdgeException, formatted by the first call to what() rather than when the
+	//! exception is thrown, so that exceptions that are caught without being printed cost no formatting. Threads that
+	//! share the exception through an std::exception_ptr may format it concurrently, but only the first text is kept
+	class LazyMessage
+	{
+	public:
+		LazyMessage()=default;
+
+		//! The copy shares the text if it has been formatted already
+		LazyMessage(const LazyMessage& other) noexcept:
+			m_text(std::atomic_load(&other.m_text))
+		{
+		}
+
+		LazyMessage& operator=(const LazyMessage&)=delete;
+
+		//! The message that f writes to a stream, or a generic one if formatting fails
+		template<typename F>
+		const char* get(const F& f) const noexcept
+		{
+			std::shared_ptr<const std::string> text=std::atomic_load(&m_text);
+			if(not text)
+			{
+				try
+				{
+					std::stringstream ss;
+					f(ss);
+					std::shared_ptr<const std::string> formatted=std::make_shared<const std::string>(ss.str());
+					text=std::atomic_compare_exchange_strong(&m_text,&text,formatted)?formatted:text;
+				}
+				catch(...)
+				{
+					return "Graph exception";
+				}
+			}
+			return text->empty()?"Graph exception":text->c_str();
+		}
+	private:
+		mutable std::shared_ptr<const std::string> m_text;
+	};
+
 	//! Base class for all exceptions involving nodes.
 	//! You can get the node that caused the exception with the node() method
 	class NodeException:public std::logic_error
 	{
 	public:
 		NodeException(const Node& node) noexcept:
-			std::logic_error([&node]()
-			{
-				std::stringstream ss;
-				ss<<node;
-				return ss.str();
-			}()),
+			std::logic_error(std::string()),
 			m_node(node)
 		{
 		}
@@ -160,8 +269,19 @@ private:
 		{
 			return m_node;
 		}
+
+		//! The node, formatted on the first call (see LazyMessage)
+		const char* what() const noexcept override
+		{
+			return m_what.get([this](std::ostream& o)
+			{
+				o<<m_node;
+			});
+		}
 	private:
 		const Node m_node;
+
+		LazyMessage m_what;
 	};
 
 	//! Base class for all exceptions involving edges (except TrivialEdge, which is treated as a node exception).
@@ -170,12 +290,7 @@ private:
 	{
 	public:
 		EdgeException(const Node& n1,const Node& n2) noexcept:
-			std::logic_error([&n1,&n2]()
-			{
-				std::stringstream ss;
-				ss<<'('<<n1<<", "<<n2<<')';
-				return ss.str();
-			}()),
+			std::logic_error(std::string()),
 			m_edge(std::make_pair(n1,n2))
 			{
 			}
@@ -186,8 +301,19 @@ private:
 		{
 			return m_edge;
 		}
+
+		//! The edge, formatted on the first call (see LazyMessage)
+		const char* what() const noexcept override
+		{
+			return m_what.get([this](std::ostream& o)
+			{
+				o<<'('<<m_edge.first<<", "<<m_edge.second<<')';
+			});
+		}
 	private:
 		const Edge m_edge;
+
+		LazyMessage m_what;
 	};
 public:
 	//! This exception is thrown by methods that take a node as argument when the node is not part of the graph
@@ -234,6 +360,142 @@ public:
 		using EdgeException::EdgeException;
 	};
 
+	//! Thrown by load() when the input cannot be parsed
+	class MalformedInput:public std::runtime_error
+	{
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+	//! Thrown when a graph with observers is mutated or assigned through a reference to UndirectedGraph<T>, which would
+	//! bypass its observers
+	class UnobservedMutation:public std::logic_error
+	{
+	public:
+		using std::logic_error::logic_error;
+	};
+};
+
+//! Undirected graph data template, with observers O of its mutations (see GraphObserver). Defined below
+template<typename T,typename... O>
+class UndirectedGraph;
+
+//! Undirected graph data template. All sets in the API are unordered
+template<typename T>
+class UndirectedGraph<T>:public GraphTypes<T>
+{
+	using Types=GraphTypes<T>;
+
+	template<typename,typename...>
+	friend class UndirectedGraph;
+public:
+	using typename Types::Node;
+
+	using typename Types::EdgeWeight;
+
+	using typename Types::NodeId;
+
+	using typename Types::EdgeId;
+
+	using typename Types::NodeSet;
+
+	using typename Types::Neighbor;
+
+	using typename Types::AdjacencyList;
+
+	using typename Types::NodeDegree;
+
+	using typename Types::NodeList;
+
+	using typename Types::Edge;
+
+	using typename Types::EdgeList;
+
+	using typename Types::WeightChange;
+
+	using typename Types::WeightChangeList;
+
+	using typename Types::NoSuchNode;
+
+	using typename Types::CorruptedGraph;
+
+	using typename Types::EdgeExists;
+
+	using typename Types::NoSuchEdge;
+
+	using typename Types::TrivialEdge;
+
+	using typename Types::ZeroWeightEdge;
+
+	using typename Types::MalformedInput;
+
+	using typename Types::UnobservedMutation;
+private:
+	//! The adjacency list of a node, along with the node's id
+	struct Vertex:public AdjacencyList
+	{
+		NodeId id;
+	};
+
+	//! The internal data structure for the graph is a hashmap
+	using Container=std::unordered_map<Node,Vertex>;
+
+	//! Projects a graph entry to its node, for views of the nodes
+	struct EntryNode
+	{
+		const Node& operator()(const typename Container::value_type& entry) const noexcept
+		{
+			return entry.first;
+		}
+	};
+public:
+	//! Alias for size_t in most systems
+	using GraphSize=typename Container::size_type;
+
+	//! Non-owning view of all nodes. See nodesView()
+	using NodeView=Range<ProjectionIterator<typename Container::const_iterator,EntryNode>>;
+
+	//! Non-owning view of the neighbors of a node. See neighborNodesView()
+	using NeighborNodeView=typename AdjacencyList::NodeView;
+private:
+	using Types::s_defaultEdgeWeight;
+public:
+	UndirectedGraph()=default;
+
+	UndirectedGraph(const UndirectedGraph& other):
+		m_graph(other.m_graph),
+		m_index(other.m_index.size(),nullptr),
+		m_freeNodes(other.m_freeNodes),
+		m_edgeIdBound(other.m_edgeIdBound),
+		m_freeEdges(other.m_freeEdges),
+		m_nodeProperties(other.m_nodeProperties),
+		m_edgeProperties(other.m_edgeProperties)
+	{
+		for(auto& n:m_graph)
+		{
+			m_index[n.second.id]=&n;
+		}
+	}
+
+	UndirectedGraph(UndirectedGraph&&)=default;
+
+	UndirectedGraph& operator=(const UndirectedGraph& other)
+	{
+		UndirectedGraph copy(other);
+		return *this=std::move(copy);
+	}
+
+	/*!
+	 * \brief operator= Move assignment
+	 * \throw UnobservedMutation If this is an UndirectedGraph<T,O...>
+	 */
+	UndirectedGraph& operator=(UndirectedGraph&& other)
+	{
+		checkUnobserved();
+		assign(std::move(other));
+		return *this;
+	}
+
 	/*!
 	 * \brief size Get the number of nodes in the graph
 	 */
@@ -259,16 +521,79 @@ public:
 	}
 
 	/*!
-	 * \brief nodes Get a set with all the nodes in the graph
+	 * \brief nodes Get a copy of the set of all the nodes in the graph. Use nodesView() to iterate over the nodes without copying them
 	 */
 	NodeSet nodes() const noexcept
 	{
-		NodeSet result;
-		for(const auto& n:m_graph)
+		return NodeSet(nodesView().begin(),nodesView().end());
+	}
+
+	//! All the nodes, iterating over the graph's own storage without allocating. Inserting or removing nodes invalidates the view
+	NodeView nodesView() const noexcept
+	{
+		return NodeView(typename NodeView::iterator(m_graph.begin()),typename NodeView::iterator(m_graph.end()));
+	}
+
+	/*!
+	 * \brief nodeId Get the dense id of a node
+	 * \throw NoSuchNode If the node doesn't belong to the graph
+	 */
+	NodeId nodeId(const Node& node) const
+	{
+		return find(node)->second.id;
+	}
+
+	//! Get the node with a dense id. The id must belong to a node of the graph
+	const Node& node(const NodeId id) const noexcept
+	{
+		return m_index[id]->first;
+	}
+
+	//! Get the neighbors of the node with a dense id, without hashing. The id must belong to a node of the graph
+	const AdjacencyList& adjacencyList(const NodeId id) const noexcept
+	{
+		return m_index[id]->second;
+	}
+
+	//! Whether an id belongs to a node of the graph, rather than to a removed node whose id hasn't been handed out again
+	bool isNodeId(const NodeId id) const noexcept
+	{
+		return id<m_index.size() and m_index[id];
+	}
+
+	//! All node ids are smaller than this
+	NodeId nodeIdBound() const noexcept
+	{
+		return m_index.size();
+	}
+
+	/*!
+	 * \brief edgeId Get the slot of an edge
+	 * \throw NoSuchNode If one of the nodes doesn't belong to the graph
+	 * \throw NoSuchEdge If the edge doesn't exist
+	 */
+	EdgeId edgeId(const Node& n1,const Node& n2) const
+	{
+		const AdjacencyList& l=find(n1)->second;
+		find(n2);
+		const typename AdjacencyList::const_iterator it=l.find(n2);
+		if(it==l.end())
 		{
-			result.insert(n.first);
+			throw NoSuchEdge(n1,n2);
 		}
-		return result;
+		return it->edge;
+	}
+
+	//! All edge slots are smaller than this
+	EdgeId edgeIdBound() const noexcept
+	{
+		return m_edgeIdBound;
+	}
+
+	//! The number of edges
+	EdgeId edgeCount() const noexcept
+	{
+		return m_edgeIdBound-m_freeEdges.size();
 	}
 
 	/*!
@@ -277,14 +602,12 @@ public:
 	 */
 	NodeDegree degree(const Node& node) const
 	{
-		try
-		{
-			return m_graph.at(node).size();
-		}
-		catch(std::out_of_range&)
+		NodeDegree result;
+		if(not tryDegree(node,result))
 		{
 			throw NoSuchNode(node);
 		}
+		return result;
 	}
 
 	/*!
@@ -293,13 +616,14 @@ public:
 	 */
 	bool isEdge(const Node& n1, const Node& n2) const
 	{
-		const std::function<bool(const Node,const Node)> lambda=[this](const Node& n,const Node& m)
+		const AdjacencyList& l1=find(n1)->second;
+		const AdjacencyList& l2=find(n2)->second;
+		const bool b1=l1.find(n2)!=l1.end();
+		if(not s_consistencyChecks)
 		{
-			const AdjacencyList& l=find(n)->second;
-			return l.find(m)!=l.end();
-		};
-		const bool b1=lambda(n1,n2);
-		const bool b2=lambda(n2,n1);
+			return b1;
+		}
+		const bool b2=l2.find(n1)!=l2.end();
 		if(b1==b2)
 		{
 			return b1;
@@ -329,8 +653,64 @@ public:
 		return find(n)->second;
 	}
 
+	/*!
+	 * \brief neighborNodesView The neighbors of a node without the weights, iterating over its adjacency list without allocating.
+	 * Inserting or removing edges of the node invalidates the view
+	 * \throw NoSuchNode If the node doesn't belong to the graph
+	 */
+	NeighborNodeView neighborNodesView(const Node& n) const
+	{
+		return find(n)->second.nodesView();
+	}
+
+	//! Get the degree of a node into degree. Returns false, leaving degree alone, if the node doesn't belong to the graph:
+	//! unlike degree(), a missing node costs no exception
+	bool tryDegree(const Node& n,NodeDegree& degree) const noexcept
+	{
+		const typename Container::const_iterator it=m_graph.find(n);
+		if(it==m_graph.end())
+		{
+			return false;
+		}
+		degree=it->second.size();
+		return true;
+	}
+
+	//! Get the dense id of a node into id. Returns false, leaving id alone, if the node doesn't belong to the graph
+	bool tryNodeId(const Node& n,NodeId& id) const noexcept
+	{
+		const typename Container::const_iterator it=m_graph.find(n);
+		if(it==m_graph.end())
+		{
+			return false;
+		}
+		id=it->second.id;
+		return true;
+	}
+
+	//! The neighbors of a node, or nullptr if the node doesn't belong to the graph
+	const AdjacencyList* tryNeighbors(const Node& n) const noexcept
+	{
+		const typename Container::const_iterator it=m_graph.find(n);
+		return it==m_graph.end()?nullptr:&it->second;
+	}
+
+	//! The entry of n2 in the adjacency list of n1, with the weight, slot and neighbor id of the edge, or nullptr if the
+	//! edge or n1 doesn't exist. Only the endpoint n1 is looked up, even with consistency checks. Inserting or removing
+	//! edges of n1 invalidates the pointer
+	const Neighbor* findEdge(const Node& n1,const Node& n2) const noexcept
+	{
+		const AdjacencyList* l=tryNeighbors(n1);
+		if(not l)
+		{
+			return nullptr;
+		}
+		const typename AdjacencyList::const_iterator it=l->find(n2);
+		return it==l->end()?nullptr:&*it;
+	}
+
 	//! Convenience method for inserting a node without neighbors
-	virtual void insert(const Node& node)
+	void insert(const Node& node)
 	{
 		insert(node,AdjacencyList());
 	}
@@ -341,54 +721,774 @@ public:
 	/*!
 	 * \throw TrivialEdge If node is in neighbors
 	 */
-	virtual void insert(const Node& node,const AdjacencyList& neighbors)
+	void insert(const Node& node,const AdjacencyList& neighbors)
 	{
-		if(neighbors.find(node)!=neighbors.end())
-		{
-			throw TrivialEdge(node);
-		}
-		m_graph[node].insert(neighbors.begin(),neighbors.end());
-		for(const auto& n:neighbors)
-		{
-			m_graph[n].insert({node,n.weight});
-		}
+		checkUnobserved();
+		NoNotifier notify;
+		insertInternal(node,neighbors,notify);
+	}
+
+	/*!
+	 * \brief insertEdges Insert a batch of edges, along with the endpoints that are not in the graph yet. Edges that
+	 * exist already, in the graph or earlier in the batch, are skipped like in insert(). The observers are notified
+	 * once for the whole batch: first of the new nodes, then of the new edges
+	 * \throw TrivialEdge If an edge is a loop, before anything is inserted
+	 * \throw ZeroWeightEdge If an edge has weight 0, before anything is inserted
+	 */
+	void insertEdges(const EdgeList& edges)
+	{
+		checkUnobserved();
+		NoNotifier notify;
+		insertEdgesInternal(edges,notify);
 	}
 
 	/*!
 	 * \brief remove Remove a node and its edges from a graph
 	 * \throw NoSuchNode If the node doesn't belong to the graph
 	 */
-	virtual void remove(const Node& node)
+	void remove(const Node& node)
 	{
-		const typename Container::iterator it=find(node);
-		const AdjacencyList& l=it->second;
-		const std::function<bool(const Node)> undo=[this,&l,&node](const Node& n)
-		{
-			bool result=true;
-			for(const auto& m:l)
-			{
-				if(&m.node==&n)
-				{
-					return result;
-				}
-				try
-				{
-					if(not m_graph.at(m).insert({node,m.weight}).second)
-					{
-						result=false;
-					}
-				}
-				catch(std::out_of_range&)
-				{
-					result=false;
-				}
-			}
-			return result;
-		};
-		for(const auto& n:l)
-		{
-			try
-			{
+		checkUnobserved();
+		NoNotifier notify;
+		removeInternal(node,notify);
+	}
+
+	/*!
+	 * \brief edge Add a new edge between two existing nodes with the default weight
+	 * \throw TrivialEdge If n1==n2
+	 * \throw EdgeExists If there is already an edge between n1 and n2
+	 */
+	void edge(const Node& n1,const Node& n2)
+	{
+		return edge(n1,n2,s_defaultEdgeWeight);
+	}
+
+	/*!
+	 * \brief edge Add a new edge between two existing nodes
+	 * \throw TrivialEdge If n1==n2
+	 * \throw ZeroWeightEdge If th weight is 0
+	 * \throw EdgeExists If there is already an edge between n1 and n2
+	 */
+	void edge(const Node& n1,const Node& n2,const EdgeWeight weight)
+	{
+		checkUnobserved();
+		NoNotifier notify;
+		edgeInternal(n1,n2,weight,notify);
+	}
+
+	/*!
+	 * \brief setWeight Set the weight of an existing edge
+	 * \throw TrivialEdge If n1==n2
+	 * \throw ZeroWeightEdge If th weight is 0
+	 * \throw NoSuchEdge If there is already no such edge
+	 */
+	void setWeight(const Node& n1,const Node& n2,const EdgeWeight weight)
+	{
+		checkUnobserved();
+		NoNotifier notify;
+		setWeightInternal(n1,n2,weight,notify);
+	}
+
+	/*!
+	 * \brief transformWeights Replace the weight of every edge with fn(n1,n2,weight) in one sweep, split across all
+	 * hardware threads. The weights are changed in place, nothing is reinserted. fn is called exactly once per edge,
+	 * always with n1<n2, from the thread that owns n1, so it must be safe to call concurrently. Edges for which fn
+	 * returns 0 keep their weight
+	 * \throw ZeroWeightEdge After the sweep, if fn returned 0 for some edge
+	 */
+	template<typename F>
+	void transformWeights(const F& fn)
+	{
+		checkUnobserved();
+		NoNotifier notify;
+		transformWeightsInternal(fn,notify);
+	}
+
+	/*!
+	 * \brief remove Remove an existing edge
+	 * \throw TrivialEdge If n1==n2
+	 * \throw NoSuchEdge If there is no edge between n1 and n2
+	 */
+	void remove(const Node& n1,const Node& n2)
+	{
+		checkUnobserved();
+		NoNotifier notify;
+		removeInternal(n1,n2,notify);
+	}
+
+	/*!
+	 * \brief validate Check the consistency of the whole graph in one pass, split across all hardware threads.
+	 * Every edge must be stored at both endpoints with the same non-zero weight, every neighbor must be a node of the graph
+	 * and there must be no loop edges. This is the counterpart of the per-operation checks that
+	 * GRAPH_NO_CONSISTENCY_CHECKS compiles out: call it after a batch of mutations instead
+	 * \throw CorruptedGraph On the first inconsistency found
+	 */
+	void validate() const
+	{
+		Concurrency::parallelFor(0,m_graph.bucket_count(),[this](const std::size_t first,const std::size_t last)
+		{
+			for(std::size_t b=first;b<last;++b)
+			{
+				for(auto it=m_graph.begin(b);it!=m_graph.end(b);++it)
+				{
+					validate(it->first,it->second);
+				}
+			}
+		});
+		if(m_index.size()-m_freeNodes.size()!=size())
+		{
+			throw CorruptedGraph("The node ids in use don't match the number of nodes");
+		}
+	}
+
+	//! brief induced Get the induced subgraph defined by a node set.
+	//! No exception is thrown if the node set is not a strict subset of the graph nodes.
+	//! The subgraph is built directly: its nodes are inserted first and every edge is then created once, from the endpoint
+	//! with the larger id. See SubgraphExtractor for extracting many subgraphs of a CompactGraph.
+	//! The subgraph has no observers
+	UndirectedGraph<T> induced(const NodeSet& nodeSet) const noexcept
+	{
+		UndirectedGraph<T> result;
+		result.m_graph.reserve(nodeSet.size());
+		result.m_index.reserve(nodeSet.size());
+		for(const auto& n:nodeSet)
+		{
+			result.insertNode(n);
+		}
+		for(auto& v:result.m_graph)
+		{
+			const typename Container::const_iterator it=m_graph.find(v.first);
+			if(it==m_graph.end())
+			{
+				continue;
+			}
+			for(const auto& m:it->second)
+			{
+				if(m.id<it->second.id)
+				{
+					const auto other=result.m_graph.find(m.node);
+					if(other!=result.m_graph.end())
+					{
+						const EdgeId e=result.allocateEdge();
+						v.second.insert({m.node,m.weight,e,other->second.id});
+						other->second.insert({v.first,m.weight,e,v.second.id});
+					}
+				}
+			}
+		}
+		return result;
+	}
+
+	using ConnectedComponent=NodeSet;
+	using ConnectedComponentSet=std::vector<ConnectedComponent>;
+
+	//! The connected components, by breadth-first search over the node ids
+	ConnectedComponentSet connectedComponents() const noexcept
+	{
+		ConnectedComponentSet result;
+		std::vector<bool> visited(m_index.size(),false);
+		std::vector<const typename Container::value_type*> queue;
+		for(NodeId u=0;u<m_index.size();++u)
+		{
+			if(not m_index[u] or visited[u])
+			{
+				continue;
+			}
+			visited[u]=true;
+			queue.assign(1,m_index[u]);
+			result.emplace_back();
+			for(std::size_t next=0;next<queue.size();++next)
+			{
+				result.back().insert(queue[next]->first);
+				for(const auto& n:queue[next]->second)
+				{
+					if(not visited[n.id])
+					{
+						visited[n.id]=true;
+						queue.push_back(m_index[n.id]);
+					}
+				}
+			}
+		}
+		return result;
+	}
+
+	/*!
+	 * \brief nodeProperty Get a node property, adding it if it doesn't exist. The property is indexed by node id
+	 * (see nodeId() and Neighbor::id), so iterating over an adjacency list and reading the properties of the neighbors
+	 * doesn't involve any hashing. Ids of inserted nodes start with the default value
+	 * \throw PropertySet::PropertyTypeMismatch If the property exists with a different value type
+	 */
+	template<typename V>
+	Property<V>& nodeProperty(const std::string& name,const V& defaultValue=V())
+	{
+		return m_nodeProperties.add(name,defaultValue);
+	}
+
+	/*!
+	 * \brief nodeProperty Get an existing node property
+	 * \throw PropertySet::NoSuchProperty If the property doesn't exist
+	 * \throw PropertySet::PropertyTypeMismatch If the property exists with a different value type
+	 */
+	template<typename V>
+	const Property<V>& nodeProperty(const std::string& name) const
+	{
+		return m_nodeProperties.get<V>(name);
+	}
+
+	/*!
+	 * \brief edgeProperty Get an edge property, adding it if it doesn't exist. The property is indexed by edge slot
+	 * (see edgeId() and Neighbor::edge). Slots of inserted edges start with the default value
+	 * \throw PropertySet::PropertyTypeMismatch If the property exists with a different value type
+	 */
+	template<typename V>
+	Property<V>& edgeProperty(const std::string& name,const V& defaultValue=V())
+	{
+		return m_edgeProperties.add(name,defaultValue);
+	}
+
+	/*!
+	 * \brief edgeProperty Get an existing edge property
+	 * \throw PropertySet::NoSuchProperty If the property doesn't exist
+	 * \throw PropertySet::PropertyTypeMismatch If the property exists with a different value type
+	 */
+	template<typename V>
+	const Property<V>& edgeProperty(const std::string& name) const
+	{
+		return m_edgeProperties.get<V>(name);
+	}
+
+	//! All node properties, for removing them or listing their names
+	PropertySet& nodeProperties() noexcept
+	{
+		return m_nodeProperties;
+	}
+
+	//! Const version of nodeProperties
+	const PropertySet& nodeProperties() const noexcept
+	{
+		return m_nodeProperties;
+	}
+
+	//! All edge properties, for removing them or listing their names
+	PropertySet& edgeProperties() noexcept
+	{
+		return m_edgeProperties;
+	}
+
+	//! Const version of edgeProperties
+	const PropertySet& edgeProperties() const noexcept
+	{
+		return m_edgeProperties;
+	}
+
+	/*!
+	 * \brief save Write the nodes, edges, weights and all properties to a stream, in a whitespace separated text format
+	 * that load() reads back. Nodes are written with operator<<, so they must not contain whitespace, and property values
+	 * with PropertyFormat. Property names must not contain whitespace either
+	 * \throw std::invalid_argument If a property value can't be written so that load() reads it back. The stream holds
+	 * a partial graph then
+	 */
+	void save(std::ostream& o) const
+	{
+		const std::vector<std::string> nodePropertyNames=m_nodeProperties.names();
+		const std::vector<std::string> edgePropertyNames=m_edgeProperties.names();
+		o<<"nodes "<<size()<<' '<<nodePropertyNames.size();
+		for(const auto& name:nodePropertyNames)
+		{
+			o<<' '<<name;
+		}
+		o<<'\n';
+		for(const auto& n:m_graph)
+		{
+			o<<n.first;
+			m_nodeProperties.write(o,nodePropertyNames,n.second.id);
+			o<<'\n';
+		}
+		o<<"edges "<<edgeCount()<<' '<<edgePropertyNames.size();
+		for(const auto& name:edgePropertyNames)
+		{
+			o<<' '<<name;
+		}
+		o<<'\n';
+		for(const auto& n:m_graph)
+		{
+			for(const auto& m:n.second)
+			{
+				if(n.first<m.node)
+				{
+					o<<n.first<<' '<<m.node<<' '<<m.weight;
+					m_edgeProperties.write(o,edgePropertyNames,m.edge);
+					o<<'\n';
+				}
+			}
+		}
+	}
+
+	/*!
+	 * \brief load Read a graph written by save() into this graph, which must be empty. The properties in the input
+	 * must have been added to this graph beforehand with nodeProperty() and edgeProperty(), so that their value types
+	 * are known. Properties of this graph that are not in the input keep their default values.
+	 * Reading nodes uses operator>>, and property values PropertyFormat
+	 * \throw MalformedInput If the graph is not empty, or the input is malformed or names an unknown property
+	 */
+	void load(std::istream& in)
+	{
+		checkUnobserved();
+		NoNotifier notify;
+		loadInternal(in,notify);
+	}
+private:
+	//! A hashmap from nodes to their neighbors. Edges are stored at both endpoints to make search operations faster
+	Container m_graph;
+
+	//! The entry of the hashmap for every node id. References to hashmap entries survive rehashing.
+	//! Entries of ids that are not in use are null
+	std::vector<typename Container::value_type*> m_index;
+
+	//! Node ids that were released by removals and will be handed out before growing the id space
+	std::vector<NodeId> m_freeNodes;
+
+	//! The size of the edge slot space
+	EdgeId m_edgeIdBound=0;
+
+	//! Edge slots that were released by removals and will be handed out before growing the slot space
+	std::vector<EdgeId> m_freeEdges;
+
+	//! Columns of values indexed by node id
+	PropertySet m_nodeProperties;
+
+	//! Columns of values indexed by edge slot
+	PropertySet m_edgeProperties;
+
+	//! Whether the graph is the base of an UndirectedGraph<T,O...>, whose observers the mutators of this class would
+	//! bypass. It belongs to the object rather than to its contents, so copies and moves of the graph don't take it along
+	struct ObservedFlag
+	{
+		ObservedFlag()=default;
+
+		ObservedFlag(const ObservedFlag&) noexcept
+		{
+		}
+
+		ObservedFlag& operator=(const ObservedFlag&) noexcept
+		{
+			return *this;
+		}
+
+		bool value=false;
+	};
+
+	ObservedFlag m_observed;
+
+	//! Called by the public mutators, which don't notify any observer
+	void checkUnobserved() const
+	{
+		if(m_observed.value)
+		{
+			throw UnobservedMutation("A graph with observers must be mutated through its own type");
+		}
+	}
+
+	//! Take the contents of another graph
+	void assign(UndirectedGraph&& other) noexcept
+	{
+		m_graph=std::move(other.m_graph);
+		m_index=std::move(other.m_index);
+		m_freeNodes=std::move(other.m_freeNodes);
+		m_edgeIdBound=other.m_edgeIdBound;
+		m_freeEdges=std::move(other.m_freeEdges);
+		m_nodeProperties=std::move(other.m_nodeProperties);
+		m_edgeProperties=std::move(other.m_edgeProperties);
+	}
+
+	//! A string attached to CorruptedGraph exceptions when the operations that fails cannot be rolled back
+	static const std::string s_undoFailedString;
+
+	//! Whether the mutators and isEdge() look at both endpoints of an edge and throw CorruptedGraph when they disagree.
+	//! Defining GRAPH_NO_CONSISTENCY_CHECKS turns this off, so that only one endpoint is looked up and remove(node) doesn't
+	//! carry undo information. validate() checks the whole graph regardless
+#ifdef GRAPH_NO_CONSISTENCY_CHECKS
+	static const bool s_consistencyChecks=false;
+#else
+	static const bool s_consistencyChecks=true;
+#endif
+
+	//! Check the adjacency list of a single node against the adjacency lists of its neighbors
+	void validate(const Node& node,const Vertex& l) const
+	{
+		if(l.id>=m_index.size() or not m_index[l.id] or not (m_index[l.id]->first==node))
+		{
+			std::stringstream ss;
+			ss<<"Node "<<node<<" has an id that doesn't map back to it";
+			throw CorruptedGraph(ss.str());
+		}
+		for(const auto& n:l)
+		{
+			if(n.node==node)
+			{
+				std::stringstream ss;
+				ss<<"Node "<<node<<" has a loop edge";
+				throw CorruptedGraph(ss.str());
+			}
+			if(not n.weight)
+			{
+				std::stringstream ss;
+				ss<<"Edge ("<<node<<", "<<n.node<<") has zero weight";
+				throw CorruptedGraph(ss.str());
+			}
+			const typename Container::const_iterator it=m_graph.find(n);
+			if(it==m_graph.end())
+			{
+				std::stringstream ss;
+				ss<<"The adjacency list of node "<<node<<" contains non-existent node "<<n;
+				throw CorruptedGraph(ss.str());
+			}
+			const typename AdjacencyList::const_iterator back=it->second.find(node);
+			if(back==it->second.end())
+			{
+				throwCorruptedGraph(n,node);
+			}
+			if(back->weight!=n.weight)
+			{
+				std::stringstream ss;
+				ss<<"Edge ("<<node<<", "<<n.node<<") has weight "<<n.weight<<" at "<<node<<" but weight "<<back->weight<<" at "<<n.node;
+				throw CorruptedGraph(ss.str());
+			}
+			if(back->edge!=n.edge or n.edge>=m_edgeIdBound or n.id!=it->second.id or back->id!=l.id)
+			{
+				std::stringstream ss;
+				ss<<"Edge ("<<node<<", "<<n.node<<") has inconsistent ids at its endpoints";
+				throw CorruptedGraph(ss.str());
+			}
+		}
+	}
+
+	//! Get the entry of a node, inserting it with a fresh id if it doesn't exist
+	typename Container::value_type& insertNode(const Node& node)
+	{
+		const std::pair<typename Container::iterator,bool> r=m_graph.insert(std::make_pair(node,Vertex()));
+		typename Container::value_type& v=*r.first;
+		if(r.second)
+		{
+			if(m_freeNodes.empty())
+			{
+				v.second.id=m_index.size();
+				m_index.push_back(&v);
+				m_nodeProperties.resize(m_index.size());
+			}
+			else
+			{
+				v.second.id=m_freeNodes.back();
+				m_freeNodes.pop_back();
+				m_index[v.second.id]=&v;
+				m_nodeProperties.reset(v.second.id);
+			}
+		}
+		return v;
+	}
+
+	//! Give back the id of a removed node
+	void releaseNode(const NodeId id)
+	{
+		m_index[id]=nullptr;
+		m_freeNodes.push_back(id);
+	}
+
+	//! Erase the entry of a node whose edges have been taken out of its neighbors' adjacency lists. If the notifier is
+	//! active, the node is isolated first and it's told about the edges and the node while the node still has its id
+	template<typename N>
+	void eraseNode(const typename Container::iterator it,N& notify)
+	{
+		if(N::s_active)
+		{
+			AdjacencyList removed;
+			removed.swap(it->second);
+			for(const auto& n:removed)
+			{
+				notify.edgeRemoved(it->first,n.node,n.weight);
+			}
+			notify.nodeRemoved(it->first);
+		}
+		releaseNode(it->second.id);
+		m_graph.erase(it);
+	}
+
+	//! The notifier of the mutators of a graph without observers. The mutators are templates on the notifier, so that
+	//! UndirectedGraph<T,O...> reuses them with one that calls its observers, and here the calls compile to nothing.
+	//! An inactive notifier isn't given the removed edges of a node nor the batches of insertEdges()
+	struct NoNotifier
+	{
+		static const bool s_active=false;
+
+		void nodeInserted(const Node&) noexcept
+		{
+		}
+
+		void edgeInserted(const Node&,const Node&,const EdgeWeight) noexcept
+		{
+		}
+
+		void edgeRemoved(const Node&,const Node&,const EdgeWeight) noexcept
+		{
+		}
+
+		void nodeRemoved(const Node&) noexcept
+		{
+		}
+
+		void batchInserted(const NodeList&,const EdgeList&) noexcept
+		{
+		}
+
+		void weightChanged(const Node&,const Node&,const EdgeWeight,const EdgeWeight) noexcept
+		{
+		}
+
+		void weightsChanged(const WeightChangeList&) noexcept
+		{
+		}
+	};
+
+	template<typename N>
+	void insertInternal(const Node& node,const AdjacencyList& neighbors,N& notify)
+	{
+		if(neighbors.find(node)!=neighbors.end())
+		{
+			throw TrivialEdge(node);
+		}
+		GraphSize oldSize=size();
+		typename Container::value_type& v=insertNode(node);
+		if(size()!=oldSize)
+		{
+			notify.nodeInserted(node);
+		}
+		for(const auto& n:neighbors)
+		{
+			oldSize=size();
+			typename Container::value_type& vN=insertNode(n);
+			if(size()!=oldSize)
+			{
+				notify.nodeInserted(n.node);
+			}
+			if(v.second.find(n)==v.second.end())
+			{
+				const EdgeId e=allocateEdge();
+				v.second.insert({n.node,n.weight,e,vN.second.id});
+				vN.second.insert({node,n.weight,e,v.second.id});
+				notify.edgeInserted(node,n.node,n.weight);
+			}
+		}
+	}
+
+	template<typename N>
+	void insertEdgesInternal(const EdgeList& edges,N& notify)
+	{
+		for(const auto& e:edges)
+		{
+			if(e.n1==e.n2)
+			{
+				throw TrivialEdge(e.n1);
+			}
+			if(not e.weight)
+			{
+				throw ZeroWeightEdge(e.n1,e.n2);
+			}
+		}
+		NodeList newNodes;
+		EdgeList newEdges;
+		for(const auto& e:edges)
+		{
+			GraphSize oldSize=size();
+			typename Container::value_type& v1=insertNode(e.n1);
+			if(N::s_active and size()!=oldSize)
+			{
+				newNodes.push_back(e.n1);
+			}
+			oldSize=size();
+			typename Container::value_type& v2=insertNode(e.n2);
+			if(N::s_active and size()!=oldSize)
+			{
+				newNodes.push_back(e.n2);
+			}
+			if(v1.second.find(e.n2)==v1.second.end())
+			{
+				const EdgeId id=allocateEdge();
+				v1.second.insert({e.n2,e.weight,id,v2.second.id});
+				v2.second.insert({e.n1,e.weight,id,v1.second.id});
+				if(N::s_active)
+				{
+					newEdges.push_back(e);
+				}
+			}
+		}
+		notify.batchInserted(newNodes,newEdges);
+	}
+
+	template<typename N>
+	void setWeightInternal(const Node& n1,const Node& n2,const EdgeWeight weight,N& notify)
+	{
+		if(n1==n2)
+		{
+			throw TrivialEdge(n1);
+		}
+		if(not weight)
+		{
+			throw ZeroWeightEdge(n1,n2);
+		}
+		AdjacencyList& l1=find(n1)->second;
+		AdjacencyList& l2=find(n2)->second;
+		const auto it1=l1.find(n2);
+		const auto it2=l2.find(n1);
+		const bool n1HasN2=it1!=l1.end();
+		const bool n2HasN1=it2!=l2.end();
+		if(n1HasN2 and n2HasN1)
+		{
+			const EdgeWeight oldWeight=it1->weight;
+			it1->weight=it2->weight=weight;
+			if(oldWeight!=weight)
+			{
+				notify.weightChanged(n1,n2,oldWeight,weight);
+			}
+		}
+		else if(not n1HasN2 and not n2HasN1)
+		{
+			throw NoSuchEdge(n1,n2);
+		}
+		else
+		{
+			if(n2HasN1)
+			{
+				throwCorruptedGraph(n1,n2);
+			}
+			else
+			{
+				throwCorruptedGraph(n2,n1);
+			}
+		}
+	}
+
+	//! Every thread collects the edges whose weight it changes, and the notifier gets them all as one batch, also when
+	//! the sweep throws
+	template<typename F,typename N>
+	void transformWeightsInternal(const F& fn,N& notify)
+	{
+		WeightChangeList changes;
+		std::mutex changesMutex;
+		try
+		{
+			Concurrency::parallelFor(0,m_graph.bucket_count(),[this,&fn,&changes,&changesMutex](const std::size_t first,const std::size_t last)
+			{
+				WeightChangeList local;
+				try
+				{
+					transformWeightsRange(fn,first,last,N::s_active?&local:nullptr);
+				}
+				catch(...)
+				{
+					const std::lock_guard<std::mutex> lock(changesMutex);
+					changes.insert(changes.end(),local.begin(),local.end());
+					throw;
+				}
+				const std::lock_guard<std::mutex> lock(changesMutex);
+				changes.insert(changes.end(),local.begin(),local.end());
+			});
+		}
+		catch(...)
+		{
+			notify.weightsChanged(changes);
+			throw;
+		}
+		notify.weightsChanged(changes);
+	}
+
+	//! The sweep of transformWeights() over a range of buckets. The changed edges are added to changes unless it's null
+	//! \throw ZeroWeightEdge After the sweep, if fn returned 0 for some edge
+	template<typename F>
+	void transformWeightsRange(const F& fn,const std::size_t first,const std::size_t last,WeightChangeList* const changes)
+	{
+		const Neighbor* zero=nullptr;
+		const Node* zeroNode=nullptr;
+		for(std::size_t b=first;b<last;++b)
+		{
+			for(auto it=m_graph.begin(b);it!=m_graph.end(b);++it)
+			{
+				const Node& node=it->first;
+				for(const auto& n:it->second)
+				{
+					if(not (node<n.node))
+					{
+						continue;
+					}
+					const EdgeWeight weight=fn(node,n.node,n.weight);
+					if(not weight)
+					{
+						if(not zero)
+						{
+							zero=&n;
+							zeroNode=&node;
+						}
+					}
+					else if(weight!=n.weight)
+					{
+						if(changes)
+						{
+							changes->push_back({node,n.node,n.weight,weight});
+						}
+						n.weight=adjacencyList(n.id).find(node)->weight=weight;
+					}
+				}
+			}
+		}
+		if(zero)
+		{
+			throw ZeroWeightEdge(*zeroNode,zero->node);
+		}
+	}
+
+	template<typename N>
+	void removeInternal(const Node& node,N& notify)
+	{
+		const typename Container::iterator it=find(node);
+		const AdjacencyList& l=it->second;
+		const NodeId id=it->second.id;
+		if(not s_consistencyChecks)
+		{
+			for(const auto& n:l)
+			{
+				m_index[n.id]->second.erase(node);
+				releaseEdge(n.edge);
+			}
+			eraseNode(it,notify);
+			return;
+		}
+		const std::function<bool(const Node)> undo=[this,&l,&node,id](const Node& n)
+		{
+			bool result=true;
+			for(const auto& m:l)
+			{
+				if(&m.node==&n)
+				{
+					return result;
+				}
+				try
+				{
+					if(not m_graph.at(m).insert({node,m.weight,m.edge,id}).second)
+					{
+						result=false;
+					}
+				}
+				catch(std::out_of_range&)
+				{
+					result=false;
+				}
+			}
+			return result;
+		};
+		for(const auto& n:l)
+		{
+			try
+			{
 				if(m_graph.at(n).erase(node)!=1)
 				{
 					const bool undoSuccess=undo(n);
@@ -413,26 +1513,15 @@ public:
 				throw CorruptedGraph(ss.str());
 			}
 		}
-		m_graph.erase(it);
-	}
-
-	/*!
-	 * \brief edge Add a new edge between two existing nodes with the default weight
-	 * \throw TrivialEdge If n1==n2
-	 * \throw EdgeExists If there is already an edge between n1 and n2
-	 */
-	virtual void edge(const Node& n1,const Node& n2)
-	{
-		return edge(n1,n2,s_defaultEdgeWeight);
+		for(const auto& n:l)
+		{
+			releaseEdge(n.edge);
+		}
+		eraseNode(it,notify);
 	}
 
-	/*!
-	 * \brief edge Add a new edge between two existing nodes
-	 * \throw TrivialEdge If n1==n2
-	 * \throw ZeroWeightEdge If th weight is 0
-	 * \throw EdgeExists If there is already an edge between n1 and n2
-	 */
-	virtual void edge(const Node& n1,const Node& n2,const EdgeWeight weight)
+	template<typename N>
+	void edgeInternal(const Node& n1,const Node& n2,const EdgeWeight weight,N& notify)
 	{
 		if(n1==n2)
 		{
@@ -442,8 +1531,20 @@ public:
 		{
 			throw ZeroWeightEdge(n1,n2);
 		}
-		AdjacencyList& l1=find(n1)->second;
-		AdjacencyList& l2=find(n2)->second;
+		Vertex& l1=find(n1)->second;
+		Vertex& l2=find(n2)->second;
+		if(not s_consistencyChecks)
+		{
+			const EdgeId e=allocateEdge();
+			if(not l1.insert({n2, weight, e, l2.id}).second)
+			{
+				releaseEdge(e);
+				throw EdgeExists(n1,n2);
+			}
+			l2.insert({n1, weight, e, l1.id});
+			notify.edgeInserted(n1,n2,weight);
+			return;
+		}
 		const bool n1HasN2=l1.find(n2)!=l1.end();
 		const bool n2HasN1=l2.find(n1)!=l2.end();
 		if(n1HasN2 and n2HasN1)
@@ -452,8 +1553,10 @@ public:
 		}
 		else if(not n1HasN2 and not n2HasN1)
 		{
-			l1.insert({n2, weight});
-			l2.insert({n1, weight});
+			const EdgeId e=allocateEdge();
+			l1.insert({n2, weight, e, l2.id});
+			l2.insert({n1, weight, e, l1.id});
+			notify.edgeInserted(n1,n2,weight);
 		}
 		else
 		{
@@ -468,77 +1571,40 @@ public:
 		}
 	}
 
-	/*!
-	 * \brief setWeight Set the weight of an existing edge
-	 * \throw TrivialEdge If n1==n2
-	 * \throw ZeroWeightEdge If th weight is 0
-	 * \throw NoSuchEdge If there is already no such edge
-	 */
-	void setWeight(const Node& n1,const Node& n2,const EdgeWeight weight)
+	template<typename N>
+	void removeInternal(const Node& n1,const Node& n2,N& notify)
 	{
 		if(n1==n2)
 		{
 			throw TrivialEdge(n1);
 		}
-		if(not weight)
-		{
-			throw ZeroWeightEdge(n1,n2);
-		}
 		AdjacencyList& l1=find(n1)->second;
 		AdjacencyList& l2=find(n2)->second;
-		const auto it1=l1.find(n2);
-		const auto it2=l2.find(n1);
-		const bool n1HasN2=it1!=l1.end();
-		const bool n2HasN1=it2!=l2.end();
-		if(n1HasN2 and n2HasN1)
-		{
-			Neighbor neighbor1=*it1;
-			Neighbor neighbor2=*it2;
-			neighbor1.weight=neighbor2.weight=weight;
-			l1.erase(it1);
-			l2.erase(it2);
-			l1.insert(neighbor1);
-			l2.insert(neighbor2);
-		}
-		else if(not n1HasN2 and not n2HasN1)
-		{
-			throw NoSuchEdge(n1,n2);
-		}
-		else
+		if(not s_consistencyChecks)
 		{
-			if(n2HasN1)
-			{
-				throwCorruptedGraph(n1,n2);
-			}
-			else
+			const typename AdjacencyList::iterator it1=l1.find(n2);
+			if(it1==l1.end())
 			{
-				throwCorruptedGraph(n2,n1);
+				throw NoSuchEdge(n1,n2);
 			}
+			const EdgeWeight weight=it1->weight;
+			releaseEdge(it1->edge);
+			l1.erase(it1);
+			l2.erase(n1);
+			notify.edgeRemoved(n1,n2,weight);
+			return;
 		}
-
-	}
-
-	/*!
-	 * \brief remove Remove an existing edge
-	 * \throw TrivialEdge If n1==n2
-	 * \throw NoSuchEdge If there is no edge between n1 and n2
-	 */
-	virtual void remove(const Node& n1,const Node& n2)
-	{
-		if(n1==n2)
-		{
-			throw TrivialEdge(n1);
-		}
-		AdjacencyList& l1=find(n1)->second;
-		AdjacencyList& l2=find(n2)->second;
 		const typename AdjacencyList::iterator it1=l1.find(n2);
 		const typename AdjacencyList::iterator it2=l2.find(n1);
 		const bool n1HasN2=it1!=l1.end();
 		const bool n2HasN1=it2!=l2.end();
 		if(n1HasN2 and n2HasN1)
 		{
+			const EdgeWeight weight=it1->weight;
+			releaseEdge(it1->edge);
 			l1.erase(it1);
 			l2.erase(it2);
+			notify.edgeRemoved(n1,n2,weight);
 		}
 		else if(not n1HasN2 and not n2HasN1)
 		{
@@ -557,56 +1623,94 @@ public:
 		}
 	}
 
-	//! brief induced Get the induced subgraph defined by a node set.
-	//! No exception is thrown if the node set is not a strict subset of the graph nodes
-	UndirectedGraph induced(const NodeSet& nodeSet) const noexcept
+	template<typename N>
+	void loadInternal(std::istream& in,N& notify)
 	{
-		UndirectedGraph result;
-		for(const auto& n:nodeSet)
+		if(not empty())
 		{
-			AdjacencyList l;
-			try
+			throw MalformedInput("Can only load into an empty graph");
+		}
+		try
+		{
+			GraphSize nodeCount;
+			const std::vector<std::string> nodePropertyNames=readHeader(in,"nodes",m_nodeProperties,nodeCount);
+			for(GraphSize i=0;i<nodeCount;++i)
 			{
-				const AdjacencyList& l1=find(n)->second;
-				for(const auto& n:l1)
+				Node n;
+				if(not (in>>n))
 				{
-					if(nodeSet.find(n)!=nodeSet.end())
-					{
-						l.insert(n);
-					}
+					throw MalformedInput("Malformed node");
 				}
+				insertInternal(n,AdjacencyList(),notify);
+				m_nodeProperties.read(in,nodePropertyNames,nodeId(n));
 			}
-			catch(const NoSuchNode&)
+			EdgeId edgeCount;
+			const std::vector<std::string> edgePropertyNames=readHeader(in,"edges",m_edgeProperties,edgeCount);
+			for(GraphSize i=0;i<edgeCount;++i)
 			{
+				Node n1,n2;
+				EdgeWeight w;
+				if(not (in>>n1>>n2>>w))
+				{
+					throw MalformedInput("Malformed edge");
+				}
+				edgeInternal(n1,n2,w,notify);
+				m_edgeProperties.read(in,edgePropertyNames,edgeId(n1,n2));
 			}
-			result.insert(n,l);
 		}
-		return result;
+		catch(const MalformedInput&)
+		{
+			throw;
+		}
+		catch(const std::exception& e)
+		{
+			throw MalformedInput(e.what());
+		}
 	}
 
-	using ConnectedComponent=NodeSet;
-	using ConnectedComponentSet=std::vector<ConnectedComponent>;
+	//! Hand out an edge slot
+	EdgeId allocateEdge()
+	{
+		if(m_freeEdges.empty())
+		{
+			m_edgeProperties.resize(m_edgeIdBound+1);
+			return m_edgeIdBound++;
+		}
+		const EdgeId e=m_freeEdges.back();
+		m_freeEdges.pop_back();
+		m_edgeProperties.reset(e);
+		return e;
+	}
 
-	virtual ConnectedComponentSet connectedComponents() const noexcept
+	//! Give back the slot of a removed edge
+	void releaseEdge(const EdgeId e)
 	{
-		ConnectedComponentSet result;
-		BreadthFirstVisitor<Node,UndirectedGraph> visitor(*this);
-		for(auto it=visitor.next();it!=visitor.end();it=visitor.next())
+		m_freeEdges.push_back(e);
+	}
+
+	//! Read a "nodes" or "edges" header line of the save() format and return the property names in it
+	static std::vector<std::string> readHeader(std::istream& in,const std::string& expected,const PropertySet& properties,std::size_t& count)
+	{
+		std::string tag;
+		std::size_t propertyCount;
+		if(not (in>>tag>>count>>propertyCount) or tag!=expected)
+		{
+			throw MalformedInput("Expected "+expected+" header");
+		}
+		std::vector<std::string> names(propertyCount);
+		for(auto& name:names)
 		{
-			if(it.second)
+			if(not (in>>name))
+			{
+				throw MalformedInput("Malformed property name");
+			}
+			if(not properties.contains(name))
 			{
-				result.resize(result.size()+1);
+				throw MalformedInput("Unknown property "+name);
 			}
-			(*result.rbegin()).insert(*it.first);
 		}
-		return result;
+		return names;
 	}
-private:
-	//! A hashmap from nodes to their neighbors. Edges are stored at both endpoints to make search operations faster
-	Container m_graph;
-
-	//! A string attached to CorruptedGraph exceptions when the operations that fails cannot be rolled back
-	static const std::string s_undoFailedString;
 
 	//! Find a node or throw a NoSuchNode exception when it cannot be found
 	typename Container::iterator find(const Node& n)
@@ -666,6 +1770,200 @@ private:
 	}
 };
 
+//! An UndirectedGraph<T> whose mutations are seen by the observers O (see GraphObserver). The mutators of
+//! UndirectedGraph<T> call their hooks statically through a notifier, so nothing is virtual and a graph without
+//! observers pays nothing. The observed graph is an UndirectedGraph<T>, so the read-only API and everything that takes an
+//! UndirectedGraph<T> work on it unchanged. It must be mutated through its own type: the mutators and assignments
+//! reached through an UndirectedGraph<T>& would bypass the observers, so they throw UnobservedMutation
+template<typename T,typename... O>
+class UndirectedGraph:public UndirectedGraph<T>,private ObserverSet<O...>
+{
+	using Base=UndirectedGraph<T>;
+
+	using Observers=ObserverSet<O...>;
+public:
+	using typename Base::Node;
+
+	using typename Base::EdgeWeight;
+
+	using typename Base::AdjacencyList;
+
+	using typename Base::NodeList;
+
+	using typename Base::EdgeList;
+
+	using typename Base::WeightChangeList;
+
+	UndirectedGraph()
+	{
+		Base::m_observed.value=true;
+	}
+
+	UndirectedGraph(const UndirectedGraph& other):
+		Base(other),
+		Observers(other)
+	{
+		Base::m_observed.value=true;
+	}
+
+	UndirectedGraph(UndirectedGraph&& other):
+		Base(std::move(other)),
+		Observers(std::move(other))
+	{
+		Base::m_observed.value=true;
+	}
+
+	UndirectedGraph& operator=(const UndirectedGraph& other)
+	{
+		UndirectedGraph copy(other);
+		return *this=std::move(copy);
+	}
+
+	UndirectedGraph& operator=(UndirectedGraph&& other)
+	{
+		Base::assign(std::move(other));
+		Observers::operator=(std::move(other));
+		return *this;
+	}
+
+	//! See UndirectedGraph<T>::insert()
+	void insert(const Node& node)
+	{
+		insert(node,AdjacencyList());
+	}
+
+	//! See UndirectedGraph<T>::insert()
+	void insert(const Node& node,const AdjacencyList& neighbors)
+	{
+		Notifier notify{*this};
+		Base::insertInternal(node,neighbors,notify);
+	}
+
+	//! See UndirectedGraph<T>::insertEdges(). The observers get the whole batch at once
+	void insertEdges(const EdgeList& edges)
+	{
+		Notifier notify{*this};
+		Base::insertEdgesInternal(edges,notify);
+	}
+
+	//! See UndirectedGraph<T>::remove(). Doesn't compile if an observer can't follow removals
+	void remove(const Node& node)
+	{
+		static_assert(Observers::removable(),"An observer of this graph can't follow removals");
+		Notifier notify{*this};
+		Base::removeInternal(node,notify);
+	}
+
+	//! See UndirectedGraph<T>::edge()
+	void edge(const Node& n1,const Node& n2)
+	{
+		edge(n1,n2,Base::s_defaultEdgeWeight);
+	}
+
+	//! See UndirectedGraph<T>::edge()
+	void edge(const Node& n1,const Node& n2,const EdgeWeight weight)
+	{
+		Notifier notify{*this};
+		Base::edgeInternal(n1,n2,weight,notify);
+	}
+
+	//! See UndirectedGraph<T>::remove(). Doesn't compile if an observer can't follow removals
+	void remove(const Node& n1,const Node& n2)
+	{
+		static_assert(Observers::removable(),"An observer of this graph can't follow removals");
+		Notifier notify{*this};
+		Base::removeInternal(n1,n2,notify);
+	}
+
+	//! See UndirectedGraph<T>::setWeight()
+	void setWeight(const Node& n1,const Node& n2,const EdgeWeight weight)
+	{
+		Notifier notify{*this};
+		Base::setWeightInternal(n1,n2,weight,notify);
+	}
+
+	//! See UndirectedGraph<T>::transformWeights(). The observers get the changed edges at once, in no particular order
+	template<typename F>
+	void transformWeights(const F& fn)
+	{
+		Notifier notify{*this};
+		Base::transformWeightsInternal(fn,notify);
+	}
+
+	//! See UndirectedGraph<T>::load(). The observers see the loaded nodes and edges
+	void load(std::istream& in)
+	{
+		Notifier notify{*this};
+		Base::loadInternal(in,notify);
+	}
+
+	//! See UndirectedGraph<T>::validate(). The observers are validated against the graph afterwards
+	void validate() const
+	{
+		Base::validate();
+		using Expand=int[];
+		(void)Expand{0,(static_cast<const O&>(*this).validate(*this),0)...};
+	}
+
+	//! The observer of type P, which must be one of the observers of the graph
+	template<typename P>
+	const P& observer() const noexcept
+	{
+		return static_cast<const P&>(*this);
+	}
+private:
+	//! Forwards the mutations of UndirectedGraph<T> to the hooks of every observer
+	struct Notifier
+	{
+		static const bool s_active=true;
+
+		UndirectedGraph& graph;
+
+		void nodeInserted(const Node& node)
+		{
+			using Expand=int[];
+			(void)Expand{0,(static_cast<O&>(graph).nodeInserted(graph,node),0)...};
+		}
+
+		void edgeInserted(const Node& n1,const Node& n2,const EdgeWeight weight)
+		{
+			using Expand=int[];
+			(void)Expand{0,(static_cast<O&>(graph).edgeInserted(graph,n1,n2,weight),0)...};
+		}
+
+		void edgeRemoved(const Node& n1,const Node& n2,const EdgeWeight weight)
+		{
+			using Expand=int[];
+			(void)Expand{0,(static_cast<O&>(graph).edgeRemoved(graph,n1,n2,weight),0)...};
+		}
+
+		void nodeRemoved(const Node& node)
+		{
+			using Expand=int[];
+			(void)Expand{0,(static_cast<O&>(graph).nodeRemoved(graph,node),0)...};
+		}
+
+		void batchInserted(const NodeList& nodes,const EdgeList& edges)
+		{
+			using Expand=int[];
+			(void)Expand{0,(static_cast<O&>(graph).nodesInserted(graph,nodes),0)...};
+			(void)Expand{0,(static_cast<O&>(graph).edgesInserted(graph,edges),0)...};
+		}
+
+		void weightChanged(const Node& n1,const Node& n2,const EdgeWeight oldWeight,const EdgeWeight newWeight)
+		{
+			using Expand=int[];
+			(void)Expand{0,(static_cast<O&>(graph).edgeWeightChanged(graph,n1,n2,oldWeight,newWeight),0)...};
+		}
+
+		void weightsChanged(const WeightChangeList& changes)
+		{
+			using Expand=int[];
+			(void)Expand{0,(static_cast<O&>(graph).edgeWeightsChanged(graph,changes),0)...};
+		}
+	};
+};
+
 template <typename T>
 std::ostream& prettyPrintNodeList(std::ostream& o,const T& nodes) noexcept
 {
@@ -698,10 +1996,10 @@ std::ostream& operator<<(std::ostream& o,const typename Graph::UndirectedGraph<T
 template<typename T>
 std::ostream& operator<<(std::ostream& o,const Graph::UndirectedGraph<T>& g) noexcept
 {
-	const typename Graph::UndirectedGraph<T>::NodeSet& nodeSet=g.nodes();
+	const typename Graph::UndirectedGraph<T>::NodeView nodes=g.nodesView();
 	using Node=typename Graph::UndirectedGraph<T>::Node;
 	using OrderedNodeSet=std::set<Node>;
-	const OrderedNodeSet orderedNodeSet(nodeSet.begin(),nodeSet.end());
+	const OrderedNodeSet orderedNodeSet(nodes.begin(),nodes.end());
 	for(typename OrderedNodeSet::const_iterator it=orderedNodeSet.begin();it!=orderedNodeSet.end();)
 	{
 		const Node& n=*it++;
@@ -0,0 +1,592 @@
+#ifndef Graph_VersionedGraph_H
+#define Graph_VersionedGraph_H
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+#include "UndirectedGraph.h"
+#include "Range.h"
+
+namespace Graph
+{
+
+//! Undirected graph with versioned snapshots, for one writer and any number of concurrent readers.
+//! The writer changes a private draft and publishes it as a new version; readers take a Snapshot of the latest
+//! published version in O(1) and without locks, and a snapshot stays consistent for as long as it is held, no matter
+//! what the writer does afterwards.
+//! Versions share their storage: the adjacency list of every node is immutable and shared, nodes are grouped in blocks
+//! of pointers to adjacency lists, and the node index is split in shards. The first change of a node after a publication
+//! copies its adjacency list, its block and its index shard; further changes before the next publication are made in
+//! place. Everything else is shared with the earlier versions.
+//! All mutators and publish() must be called from the same thread (or under the same lock); snapshot() and Snapshot
+//! can be used from any thread
+template<typename T>
+class VersionedGraph
+{
+public:
+	using Node=T;
+
+	using EdgeWeight=typename UndirectedGraph<T>::EdgeWeight;
+
+	//! Nodes get dense ids like in UndirectedGraph. The ids of removed nodes are handed out again
+	using NodeId=typename UndirectedGraph<T>::NodeId;
+
+	using GraphSize=std::size_t;
+
+	using EdgeCount=std::size_t;
+
+	//! Published versions are numbered from 0, which is the empty graph
+	using VersionNumber=std::uint64_t;
+
+	using NoSuchNode=typename UndirectedGraph<T>::NoSuchNode;
+
+	using NoSuchEdge=typename UndirectedGraph<T>::NoSuchEdge;
+
+	using EdgeExists=typename UndirectedGraph<T>::EdgeExists;
+
+	using TrivialEdge=typename UndirectedGraph<T>::TrivialEdge;
+
+	using ZeroWeightEdge=typename UndirectedGraph<T>::ZeroWeightEdge;
+
+	//! An entry of an adjacency list
+	struct Neighbor
+	{
+		NodeId id;
+
+		EdgeWeight weight;
+
+		bool operator<(const Neighbor& other) const noexcept
+		{
+			return id<other.id;
+		}
+	};
+
+	using NeighborRange=Range<typename std::vector<Neighbor>::const_iterator>;
+private:
+	//! The number of nodes in a block
+	static const std::size_t s_blockSize=64;
+
+	static const EdgeWeight s_defaultEdgeWeight=1;
+
+	//! A node and its neighbors, sorted by id. Never changed once it's part of a published version
+	struct Vertex
+	{
+		Node node;
+
+		std::vector<Neighbor> neighbors;
+	};
+
+	using Block=std::array<std::shared_ptr<const Vertex>,s_blockSize>;
+
+	using IndexShard=std::unordered_map<Node,NodeId>;
+
+	//! A published version
+	struct Version
+	{
+		std::vector<std::shared_ptr<const Block>> blocks;
+
+		std::vector<std::shared_ptr<const IndexShard>> index;
+
+		GraphSize size;
+
+		EdgeCount edges;
+
+		NodeId idBound;
+
+		VersionNumber number;
+	};
+public:
+	//! A published version of the graph. Copying a snapshot is O(1), and it keeps its version alive
+	class Snapshot
+	{
+	public:
+		//! The number of the version
+		VersionNumber version() const noexcept
+		{
+			return m_version->number;
+		}
+
+		//! The number of nodes
+		GraphSize size() const noexcept
+		{
+			return m_version->size;
+		}
+
+		bool empty() const noexcept
+		{
+			return not m_version->size;
+		}
+
+		//! The number of edges
+		EdgeCount edgeCount() const noexcept
+		{
+			return m_version->edges;
+		}
+
+		//! All node ids are smaller than this
+		NodeId nodeIdBound() const noexcept
+		{
+			return m_version->idBound;
+		}
+
+		//! Whether an id belongs to a node of this version
+		bool isNodeId(const NodeId id) const noexcept
+		{
+			return id<m_version->idBound and vertex(id);
+		}
+
+		//! Whether a node is in this version
+		bool contains(const Node& node) const noexcept
+		{
+			const IndexShard& shard=*m_version->index[shardOf(node,m_version->index.size())];
+			return shard.find(node)!=shard.end();
+		}
+
+		/*!
+		 * \brief id Get the id of a node
+		 * \throw NoSuchNode If the node is not in this version
+		 */
+		NodeId id(const Node& node) const
+		{
+			const IndexShard& shard=*m_version->index[shardOf(node,m_version->index.size())];
+			const typename IndexShard::const_iterator it=shard.find(node);
+			if(it==shard.end())
+			{
+				throw NoSuchNode(node);
+			}
+			return it->second;
+		}
+
+		//! The node with an id. The id must belong to a node of this version
+		const Node& node(const NodeId id) const noexcept
+		{
+			return vertex(id)->node;
+		}
+
+		/*!
+		 * \brief degree Get the degree of a node
+		 * \throw NoSuchNode If the node is not in this version
+		 */
+		std::size_t degree(const Node& node) const
+		{
+			return vertex(id(node))->neighbors.size();
+		}
+
+		/*!
+		 * \brief neighbors Get the neighbors of a node, sorted by id
+		 * \throw NoSuchNode If the node is not in this version
+		 */
+		NeighborRange neighbors(const Node& node) const
+		{
+			return neighbors(id(node));
+		}
+
+		//! The neighbors of the node with an id, sorted by id. The id must belong to a node of this version
+		NeighborRange neighbors(const NodeId id) const noexcept
+		{
+			const std::vector<Neighbor>& l=vertex(id)->neighbors;
+			return NeighborRange(l.begin(),l.end());
+		}
+
+		/*!
+		 * \brief isEdge Test whether an edge exists
+		 * \throw NoSuchNode If one of the nodes is not in this version
+		 */
+		bool isEdge(const Node& n1,const Node& n2) const
+		{
+			return find(id(n1),id(n2));
+		}
+
+		/*!
+		 * \brief edgeWeight Get the weight of an edge
+		 * \throw NoSuchNode If one of the nodes is not in this version
+		 * \throw NoSuchEdge If the edge doesn't exist
+		 */
+		EdgeWeight edgeWeight(const Node& n1,const Node& n2) const
+		{
+			const Neighbor* const n=find(id(n1),id(n2));
+			if(not n)
+			{
+				throw NoSuchEdge(n1,n2);
+			}
+			return n->weight;
+		}
+	private:
+		friend class VersionedGraph;
+
+		std::shared_ptr<const Version> m_version;
+
+		explicit Snapshot(const std::shared_ptr<const Version>& version) noexcept:
+			m_version(version)
+		{
+		}
+
+		const Vertex* vertex(const NodeId id) const noexcept
+		{
+			return (*m_version->blocks[id/s_blockSize])[id%s_blockSize].get();
+		}
+
+		const Neighbor* find(const NodeId n1,const NodeId n2) const noexcept
+		{
+			return VersionedGraph::find(vertex(n1)->neighbors,n2);
+		}
+	};
+
+	//! \param indexShards The number of shards of the node index. Changing a node copies the shard it's in once per
+	//! publication, so more shards make the first change after a publication cheaper and publications a bit more expensive
+	explicit VersionedGraph(const std::size_t indexShards=256):
+		m_published(std::make_shared<const Version>(Version{{},std::vector<std::shared_ptr<const IndexShard>>(std::max<std::size_t>(indexShards,1),std::make_shared<const IndexShard>()),0,0,0,0})),
+		m_index(m_published->index.size()),
+		m_ownedIndex(m_index.size(),false),
+		m_size(0),
+		m_edges(0),
+		m_number(0)
+	{
+		for(std::size_t i=0;i<m_index.size();++i)
+		{
+			m_index[i]=std::const_pointer_cast<IndexShard>(m_published->index[i]);
+		}
+	}
+
+	VersionedGraph(const VersionedGraph&)=delete;
+
+	VersionedGraph& operator=(const VersionedGraph&)=delete;
+
+	//! The latest published version. Lock-free and callable from any thread
+	Snapshot snapshot() const noexcept
+	{
+		return Snapshot(std::atomic_load(&m_published));
+	}
+
+	//! Make the changes since the last publication visible to snapshot(), all at once. Returns the number of the new version
+	VersionNumber publish()
+	{
+		const std::shared_ptr<const Version> version=std::make_shared<const Version>(Version{
+			std::vector<std::shared_ptr<const Block>>(m_blocks.begin(),m_blocks.end()),
+			std::vector<std::shared_ptr<const IndexShard>>(m_index.begin(),m_index.end()),
+			m_size,m_edges,static_cast<NodeId>(m_blocks.size()*s_blockSize),++m_number});
+		std::fill(m_ownedBlocks.begin(),m_ownedBlocks.end(),false);
+		std::fill(m_ownedVertices.begin(),m_ownedVertices.end(),false);
+		std::fill(m_ownedIndex.begin(),m_ownedIndex.end(),false);
+		std::atomic_store(&m_published,version);
+		return m_number;
+	}
+
+	//! The number of nodes in the draft
+	GraphSize size() const noexcept
+	{
+		return m_size;
+	}
+
+	//! The number of edges in the draft
+	EdgeCount edgeCount() const noexcept
+	{
+		return m_edges;
+	}
+
+	//! Whether a node is in the draft
+	bool contains(const Node& node) const noexcept
+	{
+		const IndexShard& shard=*m_index[shardOf(node,m_index.size())];
+		return shard.find(node)!=shard.end();
+	}
+
+	//! Insert a node without neighbors. Nothing happens if it exists
+	void insert(const Node& node)
+	{
+		insertNode(node);
+	}
+
+	/*!
+	 * \brief insert Insert a node with a set of neighbors, like UndirectedGraph::insert(). If the node exists, the new
+	 * neighbors are merged with the existing ones and existing edges keep their weight. Missing neighbors are added
+	 * \throw TrivialEdge If node is in neighbors
+	 * \throw ZeroWeightEdge If a new edge has weight 0
+	 */
+	void insert(const Node& node,const typename UndirectedGraph<T>::AdjacencyList& neighbors)
+	{
+		if(neighbors.find(node)!=neighbors.end())
+		{
+			throw TrivialEdge(node);
+		}
+		for(const auto& n:neighbors)
+		{
+			if(not n.weight)
+			{
+				throw ZeroWeightEdge(node,n.node);
+			}
+		}
+		const NodeId id=insertNode(node);
+		std::vector<Neighbor> added;
+		for(const auto& n:neighbors)
+		{
+			const NodeId other=insertNode(n.node);
+			if(not find(vertex(id).neighbors,other))
+			{
+				added.push_back(Neighbor{other,n.weight});
+				link(other,Neighbor{id,n.weight});
+			}
+		}
+		if(not added.empty())
+		{
+			std::vector<Neighbor>& l=writableVertex(id).neighbors;
+			l.insert(l.end(),added.begin(),added.end());
+			std::sort(l.begin(),l.end());
+			m_edges+=added.size();
+		}
+	}
+
+	/*!
+	 * \brief edge Add a new edge between two existing nodes
+	 * \throw TrivialEdge If n1==n2
+	 * \throw ZeroWeightEdge If the weight is 0
+	 * \throw NoSuchNode If one of the nodes doesn't exist
+	 * \throw EdgeExists If the edge exists
+	 */
+	void edge(const Node& n1,const Node& n2,const EdgeWeight weight=s_defaultEdgeWeight)
+	{
+		if(n1==n2)
+		{
+			throw TrivialEdge(n1);
+		}
+		if(not weight)
+		{
+			throw ZeroWeightEdge(n1,n2);
+		}
+		const NodeId id1=id(n1),id2=id(n2);
+		if(find(vertex(id1).neighbors,id2))
+		{
+			throw EdgeExists(n1,n2);
+		}
+		link(id1,Neighbor{id2,weight});
+		link(id2,Neighbor{id1,weight});
+		++m_edges;
+	}
+
+	/*!
+	 * \brief setWeight Set the weight of an existing edge
+	 * \throw TrivialEdge If n1==n2
+	 * \throw ZeroWeightEdge If the weight is 0
+	 * \throw NoSuchNode If one of the nodes doesn't exist
+	 * \throw NoSuchEdge If the edge doesn't exist
+	 */
+	void setWeight(const Node& n1,const Node& n2,const EdgeWeight weight)
+	{
+		if(n1==n2)
+		{
+			throw TrivialEdge(n1);
+		}
+		if(not weight)
+		{
+			throw ZeroWeightEdge(n1,n2);
+		}
+		const NodeId id1=id(n1),id2=id(n2);
+		if(not find(vertex(id1).neighbors,id2))
+		{
+			throw NoSuchEdge(n1,n2);
+		}
+		link(id1,Neighbor{id2,weight});
+		link(id2,Neighbor{id1,weight});
+	}
+
+	/*!
+	 * \brief remove Remove a node and its edges
+	 * \throw NoSuchNode If the node doesn't exist
+	 */
+	void remove(const Node& node)
+	{
+		const NodeId n=id(node);
+		const std::shared_ptr<const Vertex> v=vertexPointer(n);
+		for(const auto& m:v->neighbors)
+		{
+			unlink(m.id,n);
+		}
+		m_edges-=v->neighbors.size();
+		setVertex(n,nullptr);
+		m_ownedVertices[n]=false;
+		writableShard(node).erase(node);
+		m_freeIds.push_back(n);
+		--m_size;
+	}
+
+	/*!
+	 * \brief remove Remove an existing edge
+	 * \throw TrivialEdge If n1==n2
+	 * \throw NoSuchNode If one of the nodes doesn't exist
+	 * \throw NoSuchEdge If the edge doesn't exist
+	 */
+	void remove(const Node& n1,const Node& n2)
+	{
+		if(n1==n2)
+		{
+			throw TrivialEdge(n1);
+		}
+		const NodeId id1=id(n1),id2=id(n2);
+		if(not find(vertex(id1).neighbors,id2))
+		{
+			throw NoSuchEdge(n1,n2);
+		}
+		unlink(id1,id2);
+		unlink(id2,id1);
+		--m_edges;
+	}
+private:
+	//! The latest published version. Only accessed through std::atomic_load and std::atomic_store
+	std::shared_ptr<const Version> m_published;
+
+	//! The blocks of the draft
+	std::vector<std::shared_ptr<Block>> m_blocks;
+
+	//! Whether a block of the draft has been copied since the last publication, so that it can be changed in place
+	std::vector<bool> m_ownedBlocks;
+
+	//! Whether the vertex of an id has been created since the last publication, so that it can be changed in place
+	std::vector<bool> m_ownedVertices;
+
+	//! The index shards of the draft
+	std::vector<std::shared_ptr<IndexShard>> m_index;
+
+	//! Whether an index shard of the draft has been copied since the last publication
+	std::vector<bool> m_ownedIndex;
+
+	//! Ids of removed nodes, handed out before new ones
+	std::vector<NodeId> m_freeIds;
+
+	GraphSize m_size;
+
+	EdgeCount m_edges;
+
+	VersionNumber m_number;
+
+	static std::size_t shardOf(const Node& node,const std::size_t shards) noexcept
+	{
+		return std::hash<Node>()(node)%shards;
+	}
+
+	//! Binary search for a neighbor
+	static const Neighbor* find(const std::vector<Neighbor>& neighbors,const NodeId id) noexcept
+	{
+		const typename std::vector<Neighbor>::const_iterator it=std::lower_bound(neighbors.begin(),neighbors.end(),Neighbor{id,0});
+		return it!=neighbors.end() and it->id==id?&*it:nullptr;
+	}
+
+	NodeId id(const Node& node) const
+	{
+		const IndexShard& shard=*m_index[shardOf(node,m_index.size())];
+		const typename IndexShard::const_iterator it=shard.find(node);
+		if(it==shard.end())
+		{
+			throw NoSuchNode(node);
+		}
+		return it->second;
+	}
+
+	const std::shared_ptr<const Vertex>& vertexPointer(const NodeId id) const noexcept
+	{
+		return (*m_blocks[id/s_blockSize])[id%s_blockSize];
+	}
+
+	const Vertex& vertex(const NodeId id) const noexcept
+	{
+		return *vertexPointer(id);
+	}
+
+	//! Replace the vertex of an id, copying its block first if a published version shares it
+	void setVertex(const NodeId id,std::shared_ptr<const Vertex> v)
+	{
+		const std::size_t b=id/s_blockSize;
+		if(not m_ownedBlocks[b])
+		{
+			m_blocks[b]=std::make_shared<Block>(*m_blocks[b]);
+			m_ownedBlocks[b]=true;
+		}
+		(*m_blocks[b])[id%s_blockSize]=std::move(v);
+	}
+
+	//! The vertex of an id, copied first if a published version shares it. The id must belong to a node of the draft
+	Vertex& writableVertex(const NodeId id)
+	{
+		if(not m_ownedVertices[id])
+		{
+			setVertex(id,std::make_shared<Vertex>(vertex(id)));
+			m_ownedVertices[id]=true;
+		}
+		return const_cast<Vertex&>(vertex(id));
+	}
+
+	//! The index shard of a node, copied first if a published version shares it
+	IndexShard& writableShard(const Node& node)
+	{
+		const std::size_t s=shardOf(node,m_index.size());
+		if(not m_ownedIndex[s])
+		{
+			m_index[s]=std::make_shared<IndexShard>(*m_index[s]);
+			m_ownedIndex[s]=true;
+		}
+		return *m_index[s];
+	}
+
+	//! Get the id of a node, inserting it if it doesn't exist
+	NodeId insertNode(const Node& node)
+	{
+		const IndexShard& shard=*m_index[shardOf(node,m_index.size())];
+		const typename IndexShard::const_iterator it=shard.find(node);
+		if(it!=shard.end())
+		{
+			return it->second;
+		}
+		NodeId id;
+		if(m_freeIds.empty())
+		{
+			id=m_size;
+			if(id==m_blocks.size()*s_blockSize)
+			{
+				m_blocks.push_back(std::make_shared<Block>());
+				m_ownedBlocks.push_back(true);
+				m_ownedVertices.resize(m_blocks.size()*s_blockSize,false);
+			}
+		}
+		else
+		{
+			id=m_freeIds.back();
+			m_freeIds.pop_back();
+		}
+		setVertex(id,std::make_shared<Vertex>(Vertex{node,{}}));
+		m_ownedVertices[id]=true;
+		writableShard(node).insert(std::make_pair(node,id));
+		++m_size;
+		return id;
+	}
+
+	//! Add a neighbor to a node, or update its weight if it's there
+	void link(const NodeId id,const Neighbor& neighbor)
+	{
+		std::vector<Neighbor>& l=writableVertex(id).neighbors;
+		const typename std::vector<Neighbor>::iterator it=std::lower_bound(l.begin(),l.end(),neighbor);
+		if(it!=l.end() and it->id==neighbor.id)
+		{
+			it->weight=neighbor.weight;
+		}
+		else
+		{
+			l.insert(it,neighbor);
+		}
+	}
+
+	//! Remove a neighbor from a node
+	void unlink(const NodeId id,const NodeId neighbor)
+	{
+		std::vector<Neighbor>& l=writableVertex(id).neighbors;
+		l.erase(std::lower_bound(l.begin(),l.end(),Neighbor{neighbor,0}));
+	}
+};
+
+template<typename T>
+const std::size_t VersionedGraph<T>::s_blockSize;
+
+}
+
+#endif // Graph_VersionedGraph_H
@@ -9,7 +9,7 @@ QT       += testlib
 QT       -= gui
 
 TARGET = tst_GraphUnitTest
-CONFIG   += console
+CONFIG   += console thread
 CONFIG   -= app_bundle
 
 TEMPLATE = app
@@ -31,3 +31,6 @@ else:unix: LIBS += -L$$OUT_PWD/../SetOperations/ -lSetOperations
 
 INCLUDEPATH += $$PWD/../SetOperations
 DEPENDPATH += $$PWD/../SetOperations
+
+INCLUDEPATH += $$PWD/../Concurrency
+DEPENDPATH += $$PWD/../Concurrency
@@ -3,6 +3,28 @@
 #include "DepthFirstVisitor.h"
 #include "BreadthFirstVisitor.h"
 #include "IncreasingUndirectedGraph.h"
+#include "CompactGraph.h"
+#include "PageRank.h"
+#include "Louvain.h"
+#include "SubgraphExtractor.h"
+#include "BoundedBreadthFirstSearch.h"
+#include "BatchBreadthFirstSearch.h"
+#include "VersionedGraph.h"
+#include "ConcurrentUndirectedGraph.h"
+#include "Partitioner.h"
+#include "Reordering.h"
+#include "CompressedGraph.h"
+#if defined(__unix__) || defined(__APPLE__)
+#include "SemiExternal.h"
+#endif
+#include "StreamingComponents.h"
+#include "KCore.h"
+#include "ConnectedComponents.h"
+#include "DegreeBuckets.h"
+#include <thread>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
 
 class Node
 {
@@ -52,6 +74,61 @@ struct hash<Node>
 
 }
 
+//! Counts the mutations of the graph it observes
+class CountingObserver:public Graph::GraphObserver<CountingObserver>
+{
+public:
+	template<typename G>
+	void nodeInserted(const G& graph,const Node& node) noexcept
+	{
+		m_nodes+=graph.nodeId(node)<graph.nodeIdBound();
+	}
+
+	template<typename G>
+	void edgeInserted(const G& graph,const Node& n1,const Node& n2,const typename G::EdgeWeight weight) noexcept
+	{
+		m_edges+=graph.edgeWeight(n1,n2)==weight;
+		m_weight+=weight;
+	}
+
+	template<typename G>
+	void edgeRemoved(const G&,const Node&,const Node&,const typename G::EdgeWeight weight) noexcept
+	{
+		--m_edges;
+		m_weight-=weight;
+	}
+
+	template<typename G>
+	void nodeRemoved(const G& graph,const Node& node) noexcept
+	{
+		m_nodes-=graph.degree(node)==0;
+	}
+
+	template<typename G>
+	void edgeWeightChanged(const G& graph,const Node& n1,const Node& n2,const typename G::EdgeWeight oldWeight,const typename G::EdgeWeight newWeight) noexcept
+	{
+		m_weight+=graph.edgeWeight(n1,n2)==newWeight?newWeight-oldWeight:0;
+		++m_weightChanges;
+	}
+
+	template<typename G>
+	void validate(const G& graph) const
+	{
+		if(m_nodes!=graph.size() or m_edges!=graph.edgeCount())
+		{
+			throw typename G::CorruptedGraph("The observer missed a mutation");
+		}
+	}
+
+	std::size_t m_nodes=0;
+
+	std::size_t m_edges=0;
+
+	unsigned int m_weight=0;
+
+	std::size_t m_weightChanges=0;
+};
+
 class GraphUnitTest:public QObject
 {
 	Q_OBJECT	
@@ -60,8 +137,20 @@ public:
 private:
 	using UndirectedGraph=Graph::UndirectedGraph<Node>;
 	using IncreasingUndirectedGraph=Graph::IncreasingUndirectedGraph<Node>;
-	using DepthFirstVisitor=Graph::DepthFirstVisitor<Node,Graph::UndirectedGraph>;
-	using BreadthFirstVisitor=Graph::BreadthFirstVisitor<Node,Graph::UndirectedGraph>;
+	using DepthFirstVisitor=Graph::DepthFirstVisitor<Node>;
+	using BreadthFirstVisitor=Graph::BreadthFirstVisitor<Node>;
+	using CompactGraph=Graph::CompactGraph<Node>;
+	using PageRank=Graph::PageRank<Node>;
+	using Louvain=Graph::Louvain<Node>;
+	using SubgraphExtractor=Graph::SubgraphExtractor<Node>;
+	using BoundedBreadthFirstSearch=Graph::BoundedBreadthFirstSearch;
+	using BatchBreadthFirstSearch=Graph::BatchBreadthFirstSearch<Node>;
+	using VersionedGraph=Graph::VersionedGraph<Node>;
+	using ConcurrentUndirectedGraph=Graph::ConcurrentUndirectedGraph<Node>;
+	using Partitioner=Graph::Partitioner<Node>;
+	using Reordering=Graph::Reordering<Node>;
+	using CompressedGraph=Graph::CompressedGraph<Node>;
+	using StreamingComponents=Graph::StreamingComponents<Node>;
 private Q_SLOTS:
 	void graphEmpty();
 	void increasingGraphEmpty();
@@ -85,12 +174,42 @@ private Q_SLOTS:
 	void increasingGraphEdge();
 	void graphSetWeight();
 	void increasingGraphSetWeight();
+	void graphTransformWeights();
+	void increasingGraphTransformWeights();
 	void graphRemove();
 	void graphRemoveEdge();
 	void graphConnectedComponents();
 	void increasingGraphConnectedComponents();
+	void graphValidate();
+	void increasingGraphValidate();
+	void graphObservers();
+	void degreeBuckets();
+	void graphTryLookups();
+	void graphIds();
+	void graphViews();
+	void graphProperties();
+	void graphSaveLoad();
+	void compactGraph();
+	void compressedGraph();
+#if defined(__unix__) || defined(__APPLE__)
+	void semiExternal();
+#endif
+	void streamingComponents();
+	void subgraphExtractor();
+	void boundedBreadthFirstSearch();
+	void batchBreadthFirstSearch();
+	void versionedGraph();
+	void versionedGraphConcurrency();
+	void concurrentGraph();
+	void partitioner();
+	void reordering();
+	void pageRank();
+	void personalizedPageRank();
+	void louvain();
 	void depthFirstVisitor();
 	void breadthFirstVisitor();
+	void genericAlgorithms();
+	void genericAlgorithmsOnIncreasingGraph();
 private:
 	template<class T>
 	static T buildDepthFirstTree() noexcept;
@@ -136,6 +255,12 @@ private:
 
 	template<class T>
 	void graphSetWeight();
+
+	template<class T>
+	void graphValidate();
+
+	template<class T>
+	void graphTransformWeights();
 };
 
 template<typename T>
@@ -636,6 +761,52 @@ void GraphUnitTest::increasingGraphSetWeight()
 	graphSetWeight<IncreasingUndirectedGraph>();
 }
 
+template<class T>
+void GraphUnitTest::graphTransformWeights()
+{
+	T graph=buildBreadthFirstSegmented<T>();
+	graph.setWeight(1,2,4);
+	graph.transformWeights([](const Node& n1,const Node& n2,const typename T::EdgeWeight w)
+	{
+		return n1.value()<n2.value()?w*n1.value()+n2.value():0;
+	});
+	QVERIFY(graph.edgeWeight(1,2)==6 and graph.edgeWeight(2,1)==6);
+	QVERIFY(graph.edgeWeight(5,6)==11);
+	QVERIFY(graph.edgeWeight(7,9)==16);
+	graph.validate();
+	try
+	{
+		graph.transformWeights([](const Node& n1,const Node&,const typename T::EdgeWeight w)
+		{
+			return n1.value()==7?0:w+1;
+		});
+		QVERIFY(false);
+	}
+	catch(const typename T::ZeroWeightEdge& e)
+	{
+		QVERIFY(e.edge().first==7);
+	}
+	QVERIFY(graph.edgeWeight(7,9)==16 and graph.edgeWeight(1,2)==7);
+	graph.validate();
+	std::atomic<typename T::EdgeWeight> calls(0);
+	graph.transformWeights([&calls](const Node&,const Node&,const typename T::EdgeWeight w)
+	{
+		return w+calls++;
+	});
+	QVERIFY(calls==graph.edgeCount());
+	graph.validate();
+}
+
+void GraphUnitTest::graphTransformWeights()
+{
+	graphTransformWeights<UndirectedGraph>();
+}
+
+void GraphUnitTest::increasingGraphTransformWeights()
+{
+	graphTransformWeights<IncreasingUndirectedGraph>();
+}
+
 void GraphUnitTest::graphRemove()
 {
 	UndirectedGraph graph;
@@ -829,20 +1000,130 @@ void GraphUnitTest::breadthFirstVisitor()
 	QVERIFY(std::is_sorted(bft.begin(),bft.end()));
 }
 
+void GraphUnitTest::genericAlgorithms()
+{
+	UndirectedGraph graph=buildDepthFirstSegmented<UndirectedGraph>();
+	for(int i=10;i<14;++i)
+	{
+		graph.insert(i);
+	}
+	graph.edge(10,11);
+	graph.edge(11,12);
+	graph.edge(12,10);
+	graph.edge(12,13);
+	graph.remove(8);
+	const CompactGraph compact(graph);
+	const CompressedGraph compressed(compact);
+	const UndirectedGraph::ConnectedComponentSet expected=graph.connectedComponents();
+	QVERIFY(equal(Graph::ConnectedComponents<Node>(graph)(),expected));
+	QVERIFY(equal(Graph::ConnectedComponents<Node,CompactGraph>(compact)(),expected));
+	QVERIFY(equal(Graph::ConnectedComponents<Node,CompressedGraph>(compressed)(),expected));
+	Graph::ConnectedComponents<Node>::NodeId count=0;
+	const std::vector<Graph::ConnectedComponents<Node>::NodeId> membership=Graph::ConnectedComponents<Node>(graph).membership(count);
+	QVERIFY(count==expected.size() and membership.size()==graph.nodeIdBound());
+	QVERIFY(membership[graph.nodeId(10)]==membership[graph.nodeId(13)] and membership[graph.nodeId(10)]!=membership[graph.nodeId(1)]);
+	Graph::BreadthFirstVisitor<Node,CompactGraph> breadthFirst(compact);
+	std::vector<bool> seen(compact.size(),false);
+	std::size_t components=0;
+	for(auto it=breadthFirst.next();it!=breadthFirst.end();it=breadthFirst.next())
+	{
+		QVERIFY(not seen[*it.first]);
+		seen[*it.first]=true;
+		components+=it.second;
+	}
+	QVERIFY(components==expected.size() and std::count(seen.begin(),seen.end(),true)==std::ptrdiff_t(compact.size()));
+	Graph::DepthFirstVisitor<Node,Graph::CompressedGraph<Node>> depthFirst(compressed);
+	std::vector<Node> order;
+	for(auto it=depthFirst.next();it!=depthFirst.end();it=depthFirst.next())
+	{
+		if(not order.empty() and not it.second)
+		{
+			QVERIFY(std::any_of(order.begin(),order.end(),[&compressed,&it](const Node& n)
+			{
+				return compressed.isEdge(compressed.id(n),*it.first);
+			}));
+		}
+		order.push_back(compressed.label(*it.first));
+	}
+	QVERIFY(order.size()==graph.size());
+	const Graph::KCore<Node>::NodeSet core={1,2,3,4,5,6,10,11,12};
+	QVERIFY((Graph::KCore<Node>(graph,2)()==core));
+	QVERIFY((Graph::KCore<Node,CompactGraph>(compact,2)()==core));
+	QVERIFY((Graph::KCore<Node,CompressedGraph>(compressed,2)()==core));
+	QVERIFY(Graph::KCore<Node>(graph,1)().size()==graph.size() and Graph::KCore<Node>(graph,3)().empty());
+}
+
+void GraphUnitTest::genericAlgorithmsOnIncreasingGraph()
+{
+	const IncreasingUndirectedGraph graph=buildDepthFirstSegmented<IncreasingUndirectedGraph>();
+	const UndirectedGraph& plain=graph;
+	const IncreasingUndirectedGraph::ConnectedComponentSet expected=graph.connectedComponents();
+	QVERIFY(equal(Graph::ConnectedComponents<Node>(graph)(),expected));
+	QVERIFY(equal(Graph::ConnectedComponents<Node,IncreasingUndirectedGraph>(graph)(),expected));
+	const Graph::KCore<Node>::NodeSet core=Graph::KCore<Node>(plain,2)();
+	QVERIFY(not core.empty());
+	QVERIFY((Graph::KCore<Node>(graph,2)()==core));
+	QVERIFY((Graph::KCore<Node,IncreasingUndirectedGraph>(graph,2)()==core));
+	QVERIFY((Graph::KCore<Node,IncreasingUndirectedGraph>(graph,2).coreNumbers()==Graph::KCore<Node>(plain,2).coreNumbers()));
+	std::vector<Node> expectedOrder;
+	for(DepthFirstVisitor visitor(plain);;)
+	{
+		const auto it=visitor.next();
+		if(it==visitor.end())
+		{
+			break;
+		}
+		expectedOrder.push_back(*it.first);
+	}
+	std::vector<Node> order;
+	Graph::DepthFirstVisitor<Node,IncreasingUndirectedGraph> depthFirst(graph);
+	for(auto it=depthFirst.next();it!=depthFirst.end();it=depthFirst.next())
+	{
+		order.push_back(*it.first);
+	}
+	QVERIFY(order==expectedOrder);
+	order.clear();
+	BreadthFirstVisitor breadthFirst(graph);
+	std::size_t components=0;
+	for(auto it=breadthFirst.next();it!=breadthFirst.end();it=breadthFirst.next())
+	{
+		order.push_back(*it.first);
+		components+=it.second;
+	}
+	QVERIFY(order.size()==graph.size() and components==graph.componentCount());
+	order.clear();
+	Graph::BreadthFirstVisitor<Node,IncreasingUndirectedGraph> typedBreadthFirst(graph);
+	for(auto it=typedBreadthFirst.next();it!=typedBreadthFirst.end();it=typedBreadthFirst.next())
+	{
+		order.push_back(*it.first);
+	}
+	QVERIFY(order.size()==graph.size());
+}
+
 void GraphUnitTest::increasingGraphConnectedComponents()
 {
 	const IncreasingUndirectedGraph graph=buildDepthFirstSegmented<IncreasingUndirectedGraph>();
-	const IncreasingUndirectedGraph::ConnectedComponentSet expected=graph.UndirectedGraph::connectedComponents();
+	const IncreasingUndirectedGraph::ConnectedComponentSet expected=buildDepthFirstSegmented<UndirectedGraph>().connectedComponents();
 	const IncreasingUndirectedGraph::ConnectedComponentSet actual=graph.connectedComponents();
 	QVERIFY(equal(actual,expected));
+	QVERIFY(graph.componentCount()==expected.size());
+	std::size_t largest=0;
+	for(const auto& l:expected)
+	{
+		largest=std::max(largest,l.size());
+	}
+	const std::vector<IncreasingUndirectedGraph::ComponentSize> top=graph.largestComponents(1);
+	QVERIFY(top.size()==1 and top.front().second==largest and graph.componentSize(top.front().first)==largest);
 	for(const auto& l:actual)
 	{
 		QVERIFY(not l.empty());
 		const auto& first=*l.begin();
-		const IncreasingUndirectedGraph::ConnectedComponent& component=graph.component(first);
+		QVERIFY(graph.componentSize(first)==l.size());
+		const IncreasingUndirectedGraph::ConnectedComponent component=graph.component(first);
+		QVERIFY(component.size()==l.size());
 		for(const auto& m:l)
 		{
-			QVERIFY(&graph.component(m)==&component);
+			QVERIFY(graph.component(m)==component);
 			QVERIFY(graph.sameComponent(first,m));
 		}
 		for(const auto& g:actual)
@@ -857,6 +1138,1625 @@ void GraphUnitTest::increasingGraphConnectedComponents()
 
 }
 
+template<class T>
+void GraphUnitTest::graphValidate()
+{
+	T graph;
+	graph.validate();
+	graph=buildBreadthFirstSegmented<T>();
+	graph.validate();
+	graph.edge(1,6,3);
+	graph.setWeight(1,2,2);
+	graph.insert(10);
+	graph.validate();
+	for(int i=11;i<5000;++i)
+	{
+		graph.insert(i,{i-1});
+	}
+	graph.validate();
+}
+
+void GraphUnitTest::graphValidate()
+{
+	graphValidate<UndirectedGraph>();
+	UndirectedGraph graph=buildBreadthFirstSegmented<UndirectedGraph>();
+	graph.remove(3);
+	graph.remove(5,6);
+	graph.validate();
+}
+
+void GraphUnitTest::increasingGraphValidate()
+{
+	graphValidate<IncreasingUndirectedGraph>();
+}
+
+void GraphUnitTest::graphObservers()
+{
+	using ObservedGraph=Graph::UndirectedGraph<Node,CountingObserver>;
+	ObservedGraph graph=buildBreadthFirstSegmented<ObservedGraph>();
+	const CountingObserver& counts=graph.observer<CountingObserver>();
+	QVERIFY(counts.m_nodes==graph.size() and counts.m_edges==graph.edgeCount() and counts.m_weight==graph.edgeCount());
+	graph.edge(1,9,3);
+	graph.insert(10,{1});
+	QVERIFY(counts.m_nodes==graph.size() and counts.m_edges==graph.edgeCount() and counts.m_weight==graph.edgeCount()+2);
+	graph.remove(1);
+	graph.remove(4,6);
+	QVERIFY(counts.m_nodes==graph.size() and counts.m_edges==graph.edgeCount() and counts.m_weight==graph.edgeCount());
+	graph.validate();
+	const ObservedGraph copy(graph);
+	QVERIFY(copy.observer<CountingObserver>().m_nodes==graph.size());
+	const UndirectedGraph induced=graph.induced(graph.nodes());
+	QVERIFY(induced.edgeCount()==graph.edgeCount());
+	graph.insertEdges({{2,4,4},{2,11},{11,12},{4,2},{3,2}});
+	QVERIFY(counts.m_nodes==graph.size() and counts.m_edges==graph.edgeCount() and counts.m_weight==graph.edgeCount()+3);
+	graph.validate();
+	try
+	{
+		graph.insertEdges({{13,14},{15,15}});
+		QVERIFY(false);
+	}
+	catch(const UndirectedGraph::TrivialEdge&)
+	{
+	}
+	QVERIFY(not graph.nodes().count(13) and counts.m_nodes==graph.size());
+	graph.setWeight(2,4,9);
+	graph.setWeight(2,11,1);
+	QVERIFY(counts.m_weight==graph.edgeCount()+8 and counts.m_weightChanges==1);
+	graph.transformWeights([](const Node&,const Node&,const ObservedGraph::EdgeWeight w)
+	{
+		return 2*w;
+	});
+	QVERIFY(counts.m_weight==2*(graph.edgeCount()+8) and counts.m_weightChanges==1+graph.edgeCount());
+	try
+	{
+		graph.transformWeights([](const Node& n1,const Node&,const ObservedGraph::EdgeWeight w)
+		{
+			return n1==2?0:w+1;
+		});
+		QVERIFY(false);
+	}
+	catch(const UndirectedGraph::ZeroWeightEdge&)
+	{
+	}
+	unsigned int total=0;
+	for(const auto& n:graph.nodesView())
+	{
+		for(const auto& m:graph.neighbors(n))
+		{
+			total+=m.weight;
+		}
+	}
+	QVERIFY(counts.m_weight==total/2);
+	graph.validate();
+	IncreasingUndirectedGraph increasing;
+	increasing.insertEdges({{1,2},{3,4},{2,3},{5,6},{2,4}});
+	increasing.insertEdges({});
+	QVERIFY(increasing.componentCount()==2 and increasing.componentSize(1)==4 and increasing.sameComponent(5,6));
+	increasing.validate();
+	IncreasingUndirectedGraph::EdgeList path;
+	for(int n=10;n<3010;++n)
+	{
+		path.push_back(IncreasingUndirectedGraph::Edge(n,n+1));
+	}
+	increasing.insertEdges(path);
+	QVERIFY(increasing.componentCount()==3 and increasing.componentSize(10)==3001);
+	increasing.insertEdges({{6,10},{1,3010}});
+	QVERIFY(increasing.componentCount()==1 and increasing.componentSize(5)==increasing.size());
+	increasing.validate();
+	UndirectedGraph& unobserved=increasing;
+	try
+	{
+		unobserved.remove(1,2);
+		QVERIFY(false);
+	}
+	catch(const UndirectedGraph::UnobservedMutation&)
+	{
+	}
+	try
+	{
+		unobserved.edge(1,5);
+		QVERIFY(false);
+	}
+	catch(const UndirectedGraph::UnobservedMutation&)
+	{
+	}
+	try
+	{
+		unobserved=UndirectedGraph();
+		QVERIFY(false);
+	}
+	catch(const UndirectedGraph::UnobservedMutation&)
+	{
+	}
+	QVERIFY(increasing.isEdge(1,2) and not increasing.isEdge(1,5));
+	increasing.validate();
+	UndirectedGraph plain(increasing);
+	plain.remove(1,2);
+	UndirectedGraph moved(std::move(plain));
+	moved.remove(1);
+	IncreasingUndirectedGraph assigned;
+	assigned=increasing;
+	assigned.insertEdges({{1,5000}});
+	QVERIFY(assigned.componentSize(5000)==increasing.size()+1 and increasing.componentCount()==1);
+	assigned.validate();
+	struct NullObserver:Graph::GraphObserver<NullObserver>
+	{
+	};
+	QVERIFY(sizeof(UndirectedGraph)==sizeof(Graph::UndirectedGraph<Node,NullObserver>));
+}
+
+void GraphUnitTest::degreeBuckets()
+{
+	using DegreeBuckets=Graph::DegreeBuckets<Node>;
+	using BucketedGraph=Graph::UndirectedGraph<Node,DegreeBuckets>;
+	BucketedGraph graph;
+	QVERIFY(graph.observer<DegreeBuckets>().histogram().empty() and graph.observer<DegreeBuckets>().topKByDegree(3).empty());
+	graph=buildBreadthFirstSegmented<BucketedGraph>();
+	const DegreeBuckets& buckets=graph.observer<DegreeBuckets>();
+	QVERIFY(buckets.maxDegree()==4 and buckets.minDegree()==1);
+	QVERIFY(buckets.histogram()==DegreeBuckets::Histogram({0,2,2,4,1}));
+	QVERIFY(buckets.nodesWithDegree(3)==UndirectedGraph::NodeSet({1,2,3,4}) and buckets.nodesWithDegree(7).empty());
+	const std::vector<Node> top=buckets.topKByDegree(2);
+	QVERIFY(top.size()==2 and top.front()==5 and graph.degree(top.back())==3);
+	QVERIFY(buckets.topKByDegree(20).size()==graph.size());
+	graph.validate();
+	graph.remove(5);
+	QVERIFY(buckets.maxDegree()==3 and buckets.histogram()==DegreeBuckets::Histogram({0,3,4,1}));
+	graph.remove(7);
+	QVERIFY(buckets.minDegree()==0 and buckets.nodesWithDegree(0)==UndirectedGraph::NodeSet({8,9}));
+	graph.remove(8);
+	graph.remove(9);
+	QVERIFY(buckets.minDegree()==1);
+	graph.insertEdges({{6,10},{10,11},{6,1}});
+	QVERIFY(buckets.nodesWithDegree(3)==UndirectedGraph::NodeSet({6}) and buckets.maxDegree()==4 and buckets.topKByDegree(1).front()==1);
+	graph.validate();
+	graph.remove(1,6);
+	graph.remove(1,2);
+	QVERIFY(buckets.maxDegree()==2 and buckets.nodesWithDegree(1)==UndirectedGraph::NodeSet({2,11}));
+	graph.validate();
+	try
+	{
+		static_cast<UndirectedGraph&>(graph).remove(2);
+		QVERIFY(false);
+	}
+	catch(const UndirectedGraph::UnobservedMutation&)
+	{
+	}
+	QVERIFY(graph.nodes().count(2) and buckets.nodesWithDegree(1)==UndirectedGraph::NodeSet({2,11}));
+	graph.validate();
+}
+
+void GraphUnitTest::graphTryLookups()
+{
+	UndirectedGraph graph=buildBreadthFirstSegmented<UndirectedGraph>();
+	graph.setWeight(5,6,3);
+	UndirectedGraph::NodeDegree degree=0;
+	QVERIFY(graph.tryDegree(5,degree) and degree==4);
+	QVERIFY(not graph.tryDegree(42,degree) and degree==4);
+	UndirectedGraph::NodeId id=0;
+	QVERIFY(graph.tryNodeId(6,id) and id==graph.nodeId(6) and not graph.tryNodeId(42,id));
+	QVERIFY(graph.tryNeighbors(7)==&graph.neighbors(7) and not graph.tryNeighbors(42));
+	const UndirectedGraph::Neighbor* e=graph.findEdge(5,6);
+	QVERIFY(e and e->weight==3 and e->edge==graph.edgeId(5,6) and e->id==graph.nodeId(6));
+	QVERIFY(not graph.findEdge(5,7) and not graph.findEdge(42,5) and not graph.findEdge(5,42));
+	const CompactGraph compact(graph);
+	CompactGraph::NodeId compactId=0;
+	QVERIFY(compact.tryId(7,compactId) and compactId==compact.id(7) and not compact.tryId(42,compactId));
+	try
+	{
+		graph.degree(42);
+		QVERIFY(false);
+	}
+	catch(const UndirectedGraph::NoSuchNode& e)
+	{
+		QVERIFY(e.node()==42 and std::string(e.what())=="42" and std::string(e.what())=="42");
+	}
+	try
+	{
+		graph.edgeWeight(5,7);
+		QVERIFY(false);
+	}
+	catch(const UndirectedGraph::NoSuchEdge& e)
+	{
+		QVERIFY(std::string(e.what())=="(5, 7)");
+	}
+	std::exception_ptr shared;
+	try
+	{
+		graph.nodeId(1234);
+	}
+	catch(...)
+	{
+		shared=std::current_exception();
+	}
+	std::vector<std::string> messages(4);
+	std::vector<std::thread> threads;
+	for(std::size_t t=0;t<messages.size();++t)
+	{
+		threads.emplace_back([&shared,&messages,t]()
+		{
+			try
+			{
+				std::rethrow_exception(shared);
+			}
+			catch(const std::exception& e)
+			{
+				messages[t]=e.what();
+			}
+		});
+	}
+	for(auto& t:threads)
+	{
+		t.join();
+	}
+	QVERIFY(std::count(messages.begin(),messages.end(),"1234")==std::ptrdiff_t(messages.size()));
+	const std::string longName(1000,'x');
+	try
+	{
+		Graph::UndirectedGraph<std::string>().degree(longName);
+		QVERIFY(false);
+	}
+	catch(const Graph::UndirectedGraph<std::string>::NoSuchNode& e)
+	{
+		const Graph::UndirectedGraph<std::string>::NoSuchNode copy(e);
+		QVERIFY(e.what()==longName and copy.what()==longName);
+	}
+}
+
+void GraphUnitTest::graphIds()
+{
+	UndirectedGraph graph=buildBreadthFirstSegmented<UndirectedGraph>();
+	QVERIFY(graph.nodeIdBound()==graph.size());
+	QVERIFY(graph.edgeCount()==11 and graph.edgeIdBound()==11);
+	std::vector<bool> seen(graph.nodeIdBound(),false);
+	for(const auto& n:graph.nodes())
+	{
+		const UndirectedGraph::NodeId id=graph.nodeId(n);
+		QVERIFY(graph.node(id)==n);
+		QVERIFY(not seen[id]);
+		seen[id]=true;
+		for(const auto& m:graph.neighbors(n))
+		{
+			QVERIFY(m.id==graph.nodeId(m));
+			QVERIFY(m.edge==graph.edgeId(m,n) and m.edge==graph.edgeId(n,m));
+		}
+	}
+	const UndirectedGraph::NodeId removed=graph.nodeId(3);
+	const UndirectedGraph::EdgeId removedEdge=graph.edgeId(4,6);
+	graph.remove(3);
+	graph.remove(4,6);
+	QVERIFY(graph.edgeCount()==7 and graph.edgeIdBound()==11);
+	graph.insert(10,{1});
+	QVERIFY(graph.nodeId(10)==removed);
+	QVERIFY(graph.nodeIdBound()==9);
+	QVERIFY(graph.edgeId(1,10)==removedEdge and graph.edgeCount()==8);
+	const UndirectedGraph copy(graph);
+	for(const auto& n:graph.nodes())
+	{
+		QVERIFY(copy.node(graph.nodeId(n))==n);
+	}
+	copy.validate();
+	graph.validate();
+	try
+	{
+		graph.edgeId(1,5);
+		QVERIFY(false);
+	}
+	catch(const UndirectedGraph::NoSuchEdge& e)
+	{
+		QVERIFY(e.edge()==std::make_pair(Node(1),Node(5)));
+	}
+}
+
+void GraphUnitTest::graphViews()
+{
+	UndirectedGraph graph=buildBreadthFirstSegmented<UndirectedGraph>();
+	const UndirectedGraph::NodeView nodes=graph.nodesView();
+	QVERIFY(nodes.size()==graph.size() and not nodes.empty());
+	QVERIFY(UndirectedGraph::NodeSet(nodes.begin(),nodes.end())==graph.nodes());
+	QVERIFY(std::count_if(nodes.begin(),nodes.end(),[](const Node& n)
+	{
+		return n.value()>6;
+	})==3);
+	QVERIFY(std::find(nodes.begin(),nodes.end(),Node(10))==nodes.end());
+	const UndirectedGraph::NeighborNodeView neighbors=graph.neighborNodesView(5);
+	QVERIFY(UndirectedGraph::NodeSet(neighbors.begin(),neighbors.end())==UndirectedGraph::NodeSet({2,3,4,6}));
+	QVERIFY(UndirectedGraph::NodeSet(graph.neighbors(5))==UndirectedGraph::NodeSet({2,3,4,6}));
+	int sum=0;
+	for(const auto& n:graph.neighborNodesView(7))
+	{
+		sum+=n.value();
+	}
+	QVERIFY(sum==17);
+	try
+	{
+		graph.neighborNodesView(10);
+		QVERIFY(false);
+	}
+	catch(const UndirectedGraph::NoSuchNode& e)
+	{
+		QVERIFY(e.node()==10);
+	}
+	const UndirectedGraph::NodeId removed=graph.nodeId(1);
+	graph.remove(1);
+	QVERIFY(not graph.isNodeId(removed) and not graph.isNodeId(graph.nodeIdBound()));
+	QVERIFY(graph.isNodeId(graph.nodeId(2)));
+	QVERIFY(graph.nodesView().size()==graph.size());
+	QVERIFY(graph.connectedComponents().size()==2);
+	QVERIFY(UndirectedGraph().nodesView().empty());
+}
+
+void GraphUnitTest::graphProperties()
+{
+	UndirectedGraph graph=buildBreadthFirstSegmented<UndirectedGraph>();
+	Graph::Property<double>& score=graph.nodeProperty<double>("score",0.5);
+	Graph::Property<std::string>& label=graph.edgeProperty<std::string>("label");
+	QVERIFY(&graph.nodeProperty<double>("score")==&score);
+	for(const auto& n:graph.nodes())
+	{
+		QVERIFY(score[graph.nodeId(n)]==0.5);
+		score[graph.nodeId(n)]=n.value();
+	}
+	label[graph.edgeId(1,2)]="a";
+	graph.insert(11,{1});
+	QVERIFY(score[graph.nodeId(11)]==0.5);
+	QVERIFY(label[graph.edgeId(1,11)].empty());
+	double sum=0;
+	for(const auto& m:graph.neighbors(1))
+	{
+		sum+=score[m.id];
+		QVERIFY(label[m.edge]==(m.node==2?"a":""));
+	}
+	QVERIFY(sum==2+3+4+0.5);
+	const UndirectedGraph copy(graph);
+	QVERIFY(copy.nodeProperty<double>("score")[copy.nodeId(5)]==5);
+	score[graph.nodeId(5)]=-1;
+	QVERIFY(copy.nodeProperty<double>("score")[copy.nodeId(5)]==5);
+	graph.remove(5);
+	graph.insert(12);
+	QVERIFY(score[graph.nodeId(12)]==0.5);
+	try
+	{
+		graph.nodeProperty<int>("score");
+		QVERIFY(false);
+	}
+	catch(const Graph::PropertySet::PropertyTypeMismatch&)
+	{
+	}
+	try
+	{
+		copy.nodeProperty<int>("score");
+		QVERIFY(false);
+	}
+	catch(const Graph::PropertySet::PropertyTypeMismatch&)
+	{
+	}
+	try
+	{
+		copy.edgeProperty<int>("weight");
+		QVERIFY(false);
+	}
+	catch(const Graph::PropertySet::NoSuchProperty&)
+	{
+	}
+	graph.edgeProperties().remove("label");
+	QVERIFY(not graph.edgeProperties().contains("label") and copy.edgeProperties().contains("label"));
+}
+
+void GraphUnitTest::graphSaveLoad()
+{
+	using IntGraph=Graph::UndirectedGraph<int>;
+	IntGraph graph;
+	graph.insert(1,{2,3,4});
+	graph.insert(5,{2});
+	graph.insert(6);
+	graph.setWeight(1,3,7);
+	graph.nodeProperty<int>("rank")[graph.nodeId(5)]=3;
+	graph.edgeProperty<double>("time",1.5)[graph.edgeId(2,5)]=2.25;
+	std::stringstream ss;
+	graph.save(ss);
+	IntGraph loaded;
+	loaded.nodeProperty<int>("rank");
+	loaded.edgeProperty<double>("time");
+	loaded.load(ss);
+	QVERIFY(loaded==graph);
+	QVERIFY(loaded.edgeWeight(3,1)==7);
+	QVERIFY(loaded.nodeProperty<int>("rank")[loaded.nodeId(5)]==3);
+	QVERIFY(loaded.nodeProperty<int>("rank")[loaded.nodeId(1)]==0);
+	QVERIFY(loaded.edgeProperty<double>("time")[loaded.edgeId(5,2)]==2.25);
+	QVERIFY(loaded.edgeProperty<double>("time")[loaded.edgeId(1,4)]==1.5);
+	loaded.validate();
+	std::stringstream again;
+	graph.save(again);
+	IntGraph unknown;
+	try
+	{
+		unknown.load(again);
+		QVERIFY(false);
+	}
+	catch(const IntGraph::MalformedInput&)
+	{
+	}
+	graph.nodeProperty<double>("score")[graph.nodeId(1)]=0.1234567891;
+	graph.nodeProperty<double>("score")[graph.nodeId(2)]=1.0/3;
+	graph.edgeProperty<std::string>("label","none")[graph.edgeId(1,2)]="";
+	graph.edgeProperty<std::string>("label")[graph.edgeId(1,3)]="two words, \"quoted\" \\";
+	std::stringstream exact;
+	exact<<std::fixed<<std::setprecision(2);
+	graph.save(exact);
+	IntGraph reloaded;
+	reloaded.nodeProperty<int>("rank");
+	reloaded.nodeProperty<double>("score");
+	reloaded.edgeProperty<double>("time");
+	reloaded.edgeProperty<std::string>("label");
+	reloaded.load(exact);
+	QVERIFY(reloaded.nodeProperty<double>("score")[reloaded.nodeId(1)]==0.1234567891);
+	QVERIFY(reloaded.nodeProperty<double>("score")[reloaded.nodeId(2)]==1.0/3);
+	QVERIFY(reloaded.edgeProperty<std::string>("label")[reloaded.edgeId(2,1)].empty());
+	QVERIFY(reloaded.edgeProperty<std::string>("label")[reloaded.edgeId(3,1)]=="two words, \"quoted\" \\");
+	QVERIFY(reloaded.edgeProperty<std::string>("label")[reloaded.edgeId(1,4)]=="none");
+	graph.nodeProperty<double>("score")[graph.nodeId(6)]=std::numeric_limits<double>::quiet_NaN();
+	try
+	{
+		std::stringstream nan;
+		graph.save(nan);
+		QVERIFY(false);
+	}
+	catch(const std::invalid_argument&)
+	{
+	}
+	graph.nodeProperty<double>("score")[graph.nodeId(6)]=0;
+	graph.nodeProperty<char>("initial",'x')[graph.nodeId(6)]=' ';
+	try
+	{
+		std::stringstream spaced;
+		graph.save(spaced);
+		QVERIFY(false);
+	}
+	catch(const std::invalid_argument&)
+	{
+	}
+	std::stringstream truncated("nodes 2 0\n1\n");
+	IntGraph broken;
+	try
+	{
+		broken.load(truncated);
+		QVERIFY(false);
+	}
+	catch(const IntGraph::MalformedInput&)
+	{
+	}
+}
+
+void GraphUnitTest::compactGraph()
+{
+	UndirectedGraph graph=buildBreadthFirstSegmented<UndirectedGraph>();
+	graph.setWeight(1,3,5);
+	graph.insert(10);
+	const CompactGraph compact(graph);
+	QVERIFY(compact.size()==graph.size());
+	QVERIFY(compact.edgeCount()==graph.edgeCount());
+	for(CompactGraph::NodeId i=0;i<compact.size();++i)
+	{
+		const Node& n=compact.label(i);
+		QVERIFY(compact.id(n)==i);
+		QVERIFY(compact.degree(i)==graph.degree(n));
+		QVERIFY(std::is_sorted(compact.neighbors(i).begin(),compact.neighbors(i).end()));
+		auto w=compact.weights(i).begin();
+		for(const auto& m:compact.neighbors(i))
+		{
+			QVERIFY(graph.edgeWeight(n,compact.label(m))==*w++);
+			QVERIFY(compact.isEdge(m,i));
+		}
+	}
+	QVERIFY(compact.edgeWeight(compact.id(3),compact.id(1))==5);
+	QVERIFY(not compact.isEdge(compact.id(1),compact.id(5)));
+	try
+	{
+		compact.id(11);
+		QVERIFY(false);
+	}
+	catch(const CompactGraph::NoSuchNode& e)
+	{
+		QVERIFY(e.node()==11);
+	}
+	for(unsigned int parts=1;parts<16;++parts)
+	{
+		const std::vector<CompactGraph::NodeId> ranges=compact.balancedRanges(parts);
+		QVERIFY(ranges.front()==0 and ranges.back()==compact.size());
+		QVERIFY(ranges.size()>=2 and ranges.size()<=parts+1);
+		QVERIFY(std::adjacent_find(ranges.begin(),ranges.end(),std::greater_equal<CompactGraph::NodeId>())==ranges.end());
+	}
+	QVERIFY(CompactGraph(UndirectedGraph()).balancedRanges(4).size()==1);
+}
+
+void GraphUnitTest::compressedGraph()
+{
+	UndirectedGraph graph;
+	for(int i=0;i<500;++i)
+	{
+		graph.insert(i);
+	}
+	for(int i=0;i<500;++i)
+	{
+		for(const int j:{i+1,i+2,i+7,i+250})
+		{
+			if(j<500)
+			{
+				graph.edge(i,j);
+			}
+		}
+	}
+	graph.insert(1000);
+	const CompactGraph compact(graph);
+	const CompressedGraph compressed(compact);
+	QVERIFY(compressed.size()==compact.size() and compressed.edgeCount()==compact.edgeCount());
+	QVERIFY(compressed.bytes()<(compact.targets().size()+compact.weights().size())*sizeof(CompactGraph::NodeId));
+	for(CompactGraph::NodeId u=0;u<compact.size();++u)
+	{
+		QVERIFY(compressed.label(u)==compact.label(u) and compressed.id(compact.label(u))==u);
+		QVERIFY(compressed.degree(u)==compact.degree(u));
+		QVERIFY(std::equal(compact.neighbors(u).begin(),compact.neighbors(u).end(),compressed.neighbors(u).begin()));
+		QVERIFY(compressed.neighbors(u).size()==compact.degree(u));
+		for(const auto& v:compact.neighbors(u))
+		{
+			QVERIFY(compressed.isEdge(u,v) and compressed.edgeWeight(u,v)==1);
+		}
+	}
+	QVERIFY(not compressed.isEdge(compact.id(0),compact.id(3)));
+	try
+	{
+		compressed.edgeWeight(compact.id(0),compact.id(1000));
+		QVERIFY(false);
+	}
+	catch(const UndirectedGraph::NoSuchEdge& e)
+	{
+		QVERIFY(e.edge()==std::make_pair(Node(0),Node(1000)));
+	}
+	try
+	{
+		compressed.id(2000);
+		QVERIFY(false);
+	}
+	catch(const CompressedGraph::NoSuchNode& e)
+	{
+		QVERIFY(e.node()==2000);
+	}
+	graph.setWeight(3,4,300);
+	graph.setWeight(3,253,5);
+	const CompressedGraph weighted(graph);
+	for(CompactGraph::NodeId u=0;u<weighted.size();++u)
+	{
+		for(auto it=weighted.neighbors(u).begin();it!=weighted.neighbors(u).end();++it)
+		{
+			QVERIFY(it.weight()==graph.edgeWeight(weighted.label(u),weighted.label(*it)));
+		}
+	}
+	QVERIFY(weighted.edgeWeight(weighted.id(4),weighted.id(3))==300);
+	BoundedBreadthFirstSearch compactSearch,compressedSearch;
+	const BoundedBreadthFirstSearch::Visits& expected=compactSearch(compact,{0,5},3);
+	const BoundedBreadthFirstSearch::Visits& actual=compressedSearch(compressed,{0,5},3);
+	QVERIFY(expected.size()==actual.size());
+	for(std::size_t i=0;i<expected.size();++i)
+	{
+		QVERIFY(expected[i].node==actual[i].node and expected[i].depth==actual[i].depth);
+	}
+	QVERIFY(CompressedGraph().empty() and CompressedGraph(UndirectedGraph()).bytes()==sizeof(CompactGraph::EdgeIndex));
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+void GraphUnitTest::semiExternal()
+{
+	UndirectedGraph graph;
+	for(int r=0;r<30;++r)
+	{
+		for(int c=0;c<30;++c)
+		{
+			graph.insert(30*r+c);
+			if(c)
+			{
+				graph.edge(30*r+c,30*r+c-1);
+			}
+			if(r)
+			{
+				graph.edge(30*r+c,30*(r-1)+c);
+			}
+		}
+	}
+	for(int i=0;i<6;++i)
+	{
+		graph.insert(1000+i);
+		for(int j=0;j<i;++j)
+		{
+			graph.edge(1000+i,1000+j);
+		}
+	}
+	graph.insert(2000,{2001});
+	graph.edge(0,2000);
+	graph.insert(3000);
+	const CompactGraph compact(graph);
+	char path[]="/tmp/tst_GraphUnitTestXXXXXX";
+	const int fd=mkstemp(path);
+	QVERIFY(fd>=0);
+	::close(fd);
+	Graph::EdgeFileWriter::save(compact,path);
+	Graph::EdgeFileReader reader(path,false,4096);
+	QVERIFY(reader.nodeBound()==compact.size() and reader.edgeCount()==compact.edgeCount());
+	const Graph::SemiExternalComponents::Components components=Graph::SemiExternalComponents(reader)();
+	QVERIFY(components.size()==compact.size());
+	std::set<CompactGraph::NodeId> roots;
+	for(CompactGraph::NodeId u=0;u<compact.size();++u)
+	{
+		roots.insert(components.find(u));
+	}
+	QVERIFY(roots.size()==graph.connectedComponents().size());
+	for(CompactGraph::NodeId u=0;u<compact.size();++u)
+	{
+		for(const auto& v:compact.neighbors(u))
+		{
+			QVERIFY(components.find(u)==components.find(v));
+		}
+	}
+	QVERIFY(not(components.find(compact.id(0))==components.find(compact.id(1000))));
+	const std::uint64_t fileSize=Graph::EdgeFile::s_headerSize+compact.edgeCount()*sizeof(Graph::EdgeFile::Edge);
+	QVERIFY(reader.statistics().passes==1 and reader.statistics().bytesRead==fileSize+Graph::EdgeFile::s_headerSize);
+	QVERIFY(reader.statistics().reads>=fileSize/4096);
+	for(unsigned int k=0;k<7;++k)
+	{
+		const std::vector<Graph::EdgeFileReader::NodeId> core=Graph::SemiExternalKCore(reader,k)();
+		Graph::KCore<Node,CompactGraph>::NodeSet labels;
+		for(const auto& u:core)
+		{
+			labels.insert(compact.label(u));
+		}
+		QVERIFY((labels==Graph::KCore<Node,CompactGraph>(compact,k)()));
+		QVERIFY(std::is_sorted(core.begin(),core.end()));
+	}
+	QVERIFY(reader.statistics().passes>8);
+	Graph::EdgeFileReader direct(path,true);
+	const Graph::SemiExternalComponents::Components directComponents=Graph::SemiExternalComponents(direct)();
+	for(CompactGraph::NodeId u=0;u<compact.size();++u)
+	{
+		QVERIFY(directComponents.find(u)==components.find(u));
+	}
+	QVERIFY(direct.statistics().bytesRead==fileSize+Graph::EdgeFile::s_headerSize);
+	QVERIFY(truncate(path,fileSize-8)==0);
+	try
+	{
+		Graph::EdgeFileReader truncated(path);
+		QVERIFY(false);
+	}
+	catch(const std::runtime_error&)
+	{
+	}
+	{
+		Graph::EdgeFileWriter writer(path,5);
+		writer.add(1,2);
+	}
+	Graph::EdgeFileReader small(path);
+	QVERIFY(small.nodeBound()==5 and small.edgeCount()==1);
+	const Graph::SemiExternalComponents::Components smallComponents=Graph::SemiExternalComponents(small)();
+	QVERIFY(smallComponents.size()==5 and smallComponents.find(1)==smallComponents.find(2));
+	QVERIFY(not(smallComponents.find(0)==smallComponents.find(2)));
+	{
+		std::fstream header(path,std::ios::in|std::ios::out|std::ios::binary);
+		const std::uint64_t bound=2;
+		header.seekp(8);
+		header.write(reinterpret_cast<const char*>(&bound),sizeof(bound));
+	}
+	Graph::EdgeFileReader malformed(path);
+	QVERIFY(malformed.nodeBound()==2);
+	try
+	{
+		Graph::SemiExternalKCore(malformed,1)();
+		QVERIFY(false);
+	}
+	catch(const std::runtime_error& e)
+	{
+		QVERIFY(std::string(e.what()).find("well-formed")!=std::string::npos);
+	}
+	try
+	{
+		const Graph::SemiExternalComponents malformedComponents(malformed);
+		malformedComponents();
+		QVERIFY(false);
+	}
+	catch(const std::runtime_error& e)
+	{
+		QVERIFY(std::string(e.what()).find("well-formed")!=std::string::npos);
+	}
+	std::remove(path);
+	try
+	{
+		Graph::EdgeFileReader missing(path);
+		QVERIFY(false);
+	}
+	catch(const std::system_error&)
+	{
+	}
+}
+#endif
+
+void GraphUnitTest::streamingComponents()
+{
+	UndirectedGraph graph;
+	StreamingComponents stream(7);
+	std::set<int> seen;
+	std::srand(5);
+	for(int i=0;i<2000;++i)
+	{
+		const int n1=std::rand()%400,n2=n1%4+4*(std::rand()%100);
+		for(const int n:{n1,n2})
+		{
+			if(seen.insert(n).second)
+			{
+				graph.insert(n);
+			}
+		}
+		if(n1!=n2 and not graph.isEdge(n1,n2))
+		{
+			graph.edge(n1,n2);
+		}
+		stream.edge(n1,n2);
+		stream.edge(n2,n1);
+	}
+	graph.insert(1000);
+	stream.insert(1000);
+	stream.insert(1000);
+	const UndirectedGraph::ConnectedComponentSet components=graph.connectedComponents();
+	QVERIFY(stream.size()==graph.size() and stream.componentCount()==components.size());
+	StreamingComponents::SizeHistogram histogram;
+	for(const auto& c:components)
+	{
+		++histogram[c.size()];
+		for(const auto& n:c)
+		{
+			QVERIFY(stream.componentSize(n)==c.size());
+			QVERIFY(stream.sameComponent(n,*c.begin()));
+			QVERIFY(stream.component(n)==stream.component(*c.begin()));
+		}
+	}
+	QVERIFY(stream.sizeHistogram()==histogram);
+	QVERIFY(not stream.sameComponent(1000,0) and stream.componentSize(1000)==1);
+	QVERIFY(stream.contains(1000) and not stream.contains(1001));
+	try
+	{
+		stream.componentSize(1001);
+		QVERIFY(false);
+	}
+	catch(const StreamingComponents::NoSuchNode& e)
+	{
+		QVERIFY(e.node()==1001);
+	}
+	StreamingComponents empty;
+	QVERIFY(empty.componentCount()==0 and empty.sizeHistogram().empty());
+	empty.edge(1,2);
+	const StreamingComponents& pending=empty;
+	QVERIFY(pending.componentCount()==1 and pending.componentSize(2)==2 and pending.component(1)==pending.component(2));
+	QVERIFY(pending.sizeHistogram()==StreamingComponents::SizeHistogram({{2,1}}));
+}
+
+void GraphUnitTest::subgraphExtractor()
+{
+	UndirectedGraph graph=buildBreadthFirstSegmented<UndirectedGraph>();
+	graph.setWeight(2,5,4);
+	graph.setWeight(7,8,2);
+	const CompactGraph compact(graph);
+	const UndirectedGraph::NodeSet nodes={1,2,3,5,7,8};
+	const UndirectedGraph induced=graph.induced(nodes);
+	induced.validate();
+	QVERIFY(induced.edgeWeight(2,5)==4 and induced.edgeCount()==6);
+	std::vector<CompactGraph::NodeId> ids;
+	for(const auto& n:nodes)
+	{
+		ids.push_back(compact.id(n));
+	}
+	ids.push_back(ids.front());
+	for(unsigned int threads=1;threads<=3;++threads)
+	{
+		const SubgraphExtractor::Result subgraph=SubgraphExtractor(compact,threads).induced(ids);
+		const CompactGraph& g=subgraph.graph;
+		QVERIFY(g.size()==nodes.size() and g.edgeCount()==induced.edgeCount());
+		QVERIFY(std::is_sorted(subgraph.parentIds.begin(),subgraph.parentIds.end()));
+		for(CompactGraph::NodeId i=0;i<g.size();++i)
+		{
+			QVERIFY(g.label(i)==compact.label(subgraph.parentIds[i]));
+			QVERIFY(g.degree(i)==induced.degree(g.label(i)));
+			QVERIFY(std::is_sorted(g.neighbors(i).begin(),g.neighbors(i).end()));
+			auto w=g.weights(i).begin();
+			for(const auto& m:g.neighbors(i))
+			{
+				QVERIFY(induced.edgeWeight(g.label(i),g.label(m))==*w++);
+			}
+		}
+	}
+	const SubgraphExtractor extractor(compact);
+	const SubgraphExtractor::Result edges=extractor.edgeInduced({{compact.id(2),compact.id(5)},{compact.id(5),compact.id(6)},{compact.id(6),compact.id(5)}});
+	QVERIFY(edges.graph.size()==3 and edges.graph.edgeCount()==2);
+	QVERIFY(edges.graph.edgeWeight(edges.graph.id(5),edges.graph.id(2))==4);
+	QVERIFY(not edges.graph.isEdge(edges.graph.id(2),edges.graph.id(6)));
+	try
+	{
+		extractor.edgeInduced({{compact.id(1),compact.id(5)}});
+		QVERIFY(false);
+	}
+	catch(const UndirectedGraph::NoSuchEdge&)
+	{
+	}
+	const std::vector<UndirectedGraph::NodeSet> balls={{1},{1,2,3,4},{1,2,3,4,5,6},{1,2,3,4,5,6}};
+	for(unsigned int hops=0;hops<balls.size();++hops)
+	{
+		const SubgraphExtractor::Result ego=extractor.ego({compact.id(1)},hops);
+		QVERIFY(UndirectedGraph::NodeSet(ego.graph.labels().begin(),ego.graph.labels().end())==balls[hops]);
+		QVERIFY(ego.graph.edgeCount()==graph.induced(balls[hops]).edgeCount());
+	}
+	QVERIFY(extractor.ego({compact.id(1),compact.id(7)},1).graph.size()==7);
+	QVERIFY(extractor.induced({}).graph.empty());
+	try
+	{
+		extractor.induced({compact.size()});
+		QVERIFY(false);
+	}
+	catch(const std::out_of_range&)
+	{
+	}
+}
+
+void GraphUnitTest::boundedBreadthFirstSearch()
+{
+	UndirectedGraph graph=buildBreadthFirstSegmented<UndirectedGraph>();
+	const CompactGraph compact(graph);
+	BoundedBreadthFirstSearch search;
+	const auto labels=[&compact](const BoundedBreadthFirstSearch::Visits& visits)
+	{
+		UndirectedGraph::NodeSet result;
+		for(const auto& v:visits)
+		{
+			result.insert(compact.label(v.node));
+		}
+		return result;
+	};
+	const BoundedBreadthFirstSearch::Visits& one=search(compact,{compact.id(1)},1);
+	QVERIFY(one.size()==4 and one.front().node==compact.id(1) and one.front().depth==0);
+	QVERIFY(labels(one)==UndirectedGraph::NodeSet({1,2,3,4}));
+	for(const auto& v:one)
+	{
+		QVERIFY(v.depth==(v.node==compact.id(1)?0:1));
+	}
+	const CompactGraph::NodeId excluded=compact.id(3);
+	const BoundedBreadthFirstSearch::Visits& filtered=search(compact,{compact.id(1),excluded},2,[excluded](const CompactGraph::NodeId n)
+	{
+		return n!=excluded;
+	});
+	QVERIFY(labels(filtered)==UndirectedGraph::NodeSet({1,2,4,5,6}));
+	QVERIFY(not search.visited(excluded) and search.visited(compact.id(5)));
+	for(std::size_t i=1;i<filtered.size();++i)
+	{
+		QVERIFY(filtered[i-1].depth<=filtered[i].depth);
+	}
+	QVERIFY(search(compact,{compact.id(1),compact.id(7)},0).size()==2);
+	QVERIFY(search(compact,{compact.id(8)},5).size()==3);
+	QVERIFY(search(compact,{},5).empty());
+	graph.remove(2);
+	const BoundedBreadthFirstSearch::Visits& reused=search(graph,{graph.nodeId(1)},2);
+	QVERIFY(reused.size()==5);
+	for(const auto& v:reused)
+	{
+		QVERIFY(graph.node(v.node).value()<7 and v.depth==(graph.node(v.node)==1?0:graph.node(v.node).value()>4?2:1));
+	}
+	const IncreasingUndirectedGraph increasing=buildBreadthFirstSegmented<IncreasingUndirectedGraph>();
+	const BoundedBreadthFirstSearch::Visits& grown=search(increasing,{increasing.nodeId(1)},1);
+	QVERIFY(grown.size()==4 and increasing.node(grown.front().node)==1);
+	QVERIFY(search(increasing,{increasing.nodeId(7)},3).size()==increasing.componentSize(7));
+	QVERIFY(&BoundedBreadthFirstSearch::local()==&BoundedBreadthFirstSearch::local());
+	try
+	{
+		search(graph,{graph.nodeIdBound()},1);
+		QVERIFY(false);
+	}
+	catch(const std::out_of_range&)
+	{
+	}
+}
+
+void GraphUnitTest::batchBreadthFirstSearch()
+{
+	UndirectedGraph grid;
+	for(int i=0;i<20;++i)
+	{
+		for(int j=0;j<20;++j)
+		{
+			UndirectedGraph::AdjacencyList l;
+			if(i+1<20)
+			{
+				l.insert(20*(i+1)+j);
+			}
+			if(j+1<20 and (i+j)%7)
+			{
+				l.insert(20*i+j+1);
+			}
+			grid.insert(20*i+j,l);
+		}
+	}
+	const CompactGraph compact(grid);
+	Concurrency::ThreadPool pool(3);
+	const BatchBreadthFirstSearch batch(compact,pool);
+	std::vector<CompactGraph::NodeId> sources;
+	for(CompactGraph::NodeId i=0;i<compact.size();i+=3)
+	{
+		sources.push_back(i);
+	}
+	sources.push_back(0);
+	BoundedBreadthFirstSearch single;
+	for(unsigned int depth=0;depth<=4;depth+=2)
+	{
+		std::vector<std::future<BatchBreadthFirstSearch::Reached>> reached=batch.reached(sources,depth);
+		QVERIFY(reached.size()==sources.size());
+		for(std::size_t q=0;q<sources.size();++q)
+		{
+			const BatchBreadthFirstSearch::Reached r=reached[q].get();
+			const BoundedBreadthFirstSearch::Visits& expected=single(compact,{sources[q]},depth);
+			QVERIFY(r.size()==expected.size() and r.front()==sources[q]);
+			for(const auto& n:r)
+			{
+				QVERIFY(single.visited(n));
+			}
+		}
+	}
+	std::vector<std::pair<CompactGraph::NodeId,CompactGraph::NodeId>> pairs;
+	for(CompactGraph::NodeId i=0;i<150;++i)
+	{
+		pairs.push_back(std::make_pair((i*37)%compact.size(),(i*101+7)%compact.size()));
+	}
+	std::vector<std::future<bool>> reachable=batch.reachable(pairs,6);
+	for(std::size_t q=0;q<pairs.size();++q)
+	{
+		single(compact,{pairs[q].first},6);
+		QVERIFY(reachable[q].get()==single.visited(pairs[q].second));
+	}
+	QVERIFY(batch.reached({},3).empty());
+	try
+	{
+		batch.reachable({{0,compact.size()}},1);
+		QVERIFY(false);
+	}
+	catch(const std::out_of_range&)
+	{
+	}
+}
+
+void GraphUnitTest::versionedGraph()
+{
+	VersionedGraph graph(4);
+	const VersionedGraph::Snapshot empty=graph.snapshot();
+	QVERIFY(empty.version()==0 and empty.empty() and not empty.contains(1));
+	graph.insert(1,{2,3,4});
+	graph.insert(3,{2,5});
+	for(int i=10;i<200;++i)
+	{
+		graph.insert(i,{i+1});
+	}
+	QVERIFY(graph.size()==196 and graph.edgeCount()==195 and graph.snapshot().empty());
+	QVERIFY(graph.publish()==1);
+	const VersionedGraph::Snapshot first=graph.snapshot();
+	QVERIFY(first.version()==1 and first.size()==196 and first.edgeCount()==195);
+	QVERIFY(first.isEdge(2,3) and first.isEdge(3,2) and not first.isEdge(1,5));
+	QVERIFY(first.degree(3)==3 and first.edgeWeight(1,4)==1);
+	graph.setWeight(1,4,7);
+	graph.remove(3);
+	graph.remove(150,151);
+	graph.edge(1,5,2);
+	graph.insert(3);
+	try
+	{
+		graph.edge(1,5);
+		QVERIFY(false);
+	}
+	catch(const VersionedGraph::EdgeExists&)
+	{
+	}
+	try
+	{
+		graph.remove(2,5);
+		QVERIFY(false);
+	}
+	catch(const VersionedGraph::NoSuchEdge&)
+	{
+	}
+	try
+	{
+		graph.insert(6,{6});
+		QVERIFY(false);
+	}
+	catch(const VersionedGraph::TrivialEdge&)
+	{
+	}
+	QVERIFY(graph.snapshot().version()==1);
+	QVERIFY(graph.publish()==2);
+	const VersionedGraph::Snapshot second=graph.snapshot();
+	QVERIFY(second.size()==196 and second.edgeCount()==192);
+	QVERIFY(second.degree(3)==0 and not second.isEdge(2,3) and not second.isEdge(150,151));
+	QVERIFY(second.edgeWeight(4,1)==7 and second.edgeWeight(5,1)==2);
+	QVERIFY(first.degree(3)==3 and first.isEdge(150,151) and first.edgeWeight(4,1)==1 and not first.isEdge(1,5));
+	for(VersionedGraph::NodeId i=0;i<second.nodeIdBound();++i)
+	{
+		if(second.isNodeId(i))
+		{
+			QVERIFY(second.id(second.node(i))==i);
+			for(const auto& n:second.neighbors(i))
+			{
+				QVERIFY(second.isEdge(second.node(n.id),second.node(i)));
+			}
+		}
+	}
+	graph.edge(2,5);
+	graph.setWeight(2,5,3);
+	graph.insert(2,{6,7});
+	graph.remove(2,6);
+	QVERIFY(not second.isEdge(2,5) and not second.contains(6) and second.degree(2)==1);
+	QVERIFY(graph.publish()==3);
+	QVERIFY(graph.snapshot().edgeWeight(5,2)==3 and graph.snapshot().degree(2)==3 and graph.snapshot().degree(6)==0);
+	graph.remove(1);
+	graph.publish();
+	try
+	{
+		graph.snapshot().degree(1);
+		QVERIFY(false);
+	}
+	catch(const VersionedGraph::NoSuchNode& e)
+	{
+		QVERIFY(e.node()==1);
+	}
+	QVERIFY(second.isEdge(1,2));
+}
+
+void GraphUnitTest::versionedGraphConcurrency()
+{
+	VersionedGraph graph;
+	std::atomic<bool> done(false);
+	std::atomic<unsigned int> failures(0);
+	std::vector<std::thread> readers;
+	for(int r=0;r<3;++r)
+	{
+		readers.emplace_back([&graph,&done,&failures]()
+		{
+			VersionedGraph::VersionNumber last=0;
+			while(not done)
+			{
+				const VersionedGraph::Snapshot s=graph.snapshot();
+				std::size_t degrees=0;
+				for(VersionedGraph::NodeId i=0;i<s.nodeIdBound();++i)
+				{
+					if(s.isNodeId(i))
+					{
+						degrees+=s.neighbors(i).size();
+					}
+				}
+				if(s.version()<last or degrees!=2*s.edgeCount() or s.edgeCount()!=s.version()*3)
+				{
+					++failures;
+				}
+				last=s.version();
+			}
+		});
+	}
+	for(int i=0;i<300;++i)
+	{
+		graph.insert(i,{i+1000,i+2000,i+3000});
+		graph.publish();
+	}
+	done=true;
+	for(auto& r:readers)
+	{
+		r.join();
+	}
+	QVERIFY(failures==0);
+	QVERIFY(graph.snapshot().edgeCount()==900);
+}
+
+void GraphUnitTest::concurrentGraph()
+{
+	ConcurrentUndirectedGraph graph(8);
+	graph.insert(1,{2,3});
+	graph.edge(2,3,5);
+	QVERIFY(graph.size()==3 and graph.edgeCount()==3);
+	QVERIFY(graph.isEdge(3,2) and graph.edgeWeight(2,3)==5 and graph.degree(1)==2);
+	QVERIFY(UndirectedGraph::NodeSet(graph.neighbors(1))==UndirectedGraph::NodeSet({2,3}));
+	try
+	{
+		graph.edge(3,2);
+		QVERIFY(false);
+	}
+	catch(const ConcurrentUndirectedGraph::EdgeExists&)
+	{
+	}
+	try
+	{
+		graph.edge(1,4);
+		QVERIFY(false);
+	}
+	catch(const ConcurrentUndirectedGraph::NoSuchNode& e)
+	{
+		QVERIFY(e.node()==4);
+	}
+	graph.remove(1);
+	QVERIFY(graph.size()==2 and graph.edgeCount()==1 and not graph.contains(1));
+	graph.remove(2,3);
+	QVERIFY(graph.edgeCount()==0 and graph.degree(2)==0);
+	ConcurrentUndirectedGraph shared;
+	const int n=2000;
+	const unsigned int threads=4;
+	std::vector<std::thread> workers;
+	for(unsigned int t=0;t<threads;++t)
+	{
+		workers.emplace_back([&shared,t,threads]()
+		{
+			for(int i=t;i<n;i+=threads)
+			{
+				shared.insert(i,{(i+1)%n,(i*7+3)%n});
+				if(i%10==0)
+				{
+					shared.insert(n+i,{i});
+					shared.remove(n+i);
+				}
+				else if(i%10==5)
+				{
+					shared.setWeight(i,(i+1)%n,2);
+				}
+			}
+		});
+	}
+	for(auto& w:workers)
+	{
+		w.join();
+	}
+	UndirectedGraph expected;
+	for(int i=0;i<n;++i)
+	{
+		expected.insert(i,{(i+1)%n,(i*7+3)%n});
+	}
+	for(int i=5;i<n;i+=10)
+	{
+		expected.setWeight(i,i+1,2);
+	}
+	const UndirectedGraph copy=shared.graph();
+	copy.validate();
+	QVERIFY(copy==expected);
+	QVERIFY(shared.size()==expected.size() and shared.edgeCount()==expected.edgeCount());
+	QVERIFY(shared.nodes()==expected.nodes());
+}
+
+void GraphUnitTest::partitioner()
+{
+	UndirectedGraph grid;
+	for(int r=0;r<16;++r)
+	{
+		for(int c=0;c<16;++c)
+		{
+			grid.insert(16*r+c);
+			if(c)
+			{
+				grid.edge(16*r+c,16*r+c-1,1+c%3);
+			}
+			if(r)
+			{
+				grid.edge(16*r+c,16*(r-1)+c);
+			}
+		}
+	}
+	const CompactGraph compact(grid);
+	const Partitioner partitioner(compact,4);
+	const Partitioner::Assignment hash=partitioner.hash();
+	const Partitioner::Assignment range=partitioner.range();
+	const Partitioner::Assignment greedy=partitioner.linearDeterministicGreedy();
+	const Partitioner::Assignment fennel=partitioner.fennel();
+	for(const auto& assignment:{hash,range,greedy,fennel})
+	{
+		QVERIFY(assignment.size()==compact.size());
+		std::vector<unsigned int> sizes(4,0);
+		for(const auto& p:assignment)
+		{
+			QVERIFY(p<4);
+			++sizes[p];
+		}
+		QVERIFY(*std::min_element(sizes.begin(),sizes.end())>0);
+	}
+	QVERIFY(std::is_sorted(range.begin(),range.end()));
+	for(const auto& assignment:{greedy,fennel})
+	{
+		QVERIFY(std::count(assignment.begin(),assignment.end(),0)<=std::ceil(1.1*compact.size()/4));
+		QVERIFY(partitioner.edgeCut(assignment)<partitioner.edgeCut(hash));
+	}
+	QVERIFY(partitioner.edgeCut(std::vector<unsigned int>(compact.size(),2))==0);
+	const Partitioner::Layout layout=partitioner.layout(greedy);
+	QVERIFY(layout.bounds.size()==5 and layout.bounds.front()==0 and layout.bounds.back()==compact.size());
+	for(unsigned int p=0;p<4;++p)
+	{
+		QVERIFY(std::is_sorted(layout.order.begin()+layout.bounds[p],layout.order.begin()+layout.bounds[p+1]));
+		for(auto i=layout.bounds[p];i<layout.bounds[p+1];++i)
+		{
+			QVERIFY(greedy[layout.order[i]]==p);
+		}
+	}
+	const CompactGraph placed=partitioner.apply(greedy,Concurrency::numaPlacement(4));
+	QVERIFY(placed.size()==compact.size() and placed.edgeCount()==compact.edgeCount());
+	QVERIFY(placed.partitions()==layout.bounds);
+	QVERIFY(placed.placement()==Concurrency::numaPlacement(4));
+	for(CompactGraph::NodeId u=0;u<compact.size();++u)
+	{
+		const CompactGraph::NodeId pu=placed.id(compact.label(u));
+		QVERIFY(placed.label(pu)==compact.label(u) and placed.degree(pu)==compact.degree(u));
+		QVERIFY(std::is_sorted(placed.neighbors(pu).begin(),placed.neighbors(pu).end()));
+		auto w=compact.weights(u).begin();
+		for(const auto& v:compact.neighbors(u))
+		{
+			QVERIFY(placed.edgeWeight(pu,placed.id(compact.label(v)))==*w++);
+		}
+	}
+	for(unsigned int parts=1;parts<12;++parts)
+	{
+		const std::vector<CompactGraph::NodeId> ranges=placed.balancedRanges(parts);
+		QVERIFY(ranges.size()<=std::max(parts,4u)+1);
+		for(const auto& b:layout.bounds)
+		{
+			QVERIFY(std::binary_search(ranges.begin(),ranges.end(),b));
+		}
+		const std::vector<unsigned int> nodes=placed.rangeNodes(ranges);
+		QVERIFY(nodes.size()+1==ranges.size());
+		for(std::size_t i=0;i<nodes.size();++i)
+		{
+			const unsigned int p=std::upper_bound(layout.bounds.begin(),layout.bounds.end(),ranges[i])-layout.bounds.begin()-1;
+			QVERIFY(nodes[i]==placed.placement()[p]);
+		}
+	}
+	QVERIFY(compact.rangeNodes(compact.balancedRanges(4)).empty());
+	const PageRank::Result expected=PageRank(compact,0.85,1e-12,1000,3)();
+	const PageRank::Result actual=PageRank(placed,0.85,1e-12,1000,3)();
+	for(CompactGraph::NodeId u=0;u<compact.size();++u)
+	{
+		QVERIFY(std::fabs(expected.ranks[u]-actual.ranks[placed.id(compact.label(u))])<1e-9);
+	}
+	std::vector<CompactGraph::NodeId> order(compact.size());
+	std::iota(order.begin(),order.end(),0);
+	QVERIFY(compact.permuted(order).partitions()==std::vector<CompactGraph::NodeId>({0,compact.size()}));
+	order[1]=0;
+	try
+	{
+		compact.permuted(order);
+		QVERIFY(false);
+	}
+	catch(const std::invalid_argument&)
+	{
+	}
+	order[1]=1;
+	try
+	{
+		compact.permuted(order,{0,10,5,compact.size()});
+		QVERIFY(false);
+	}
+	catch(const std::invalid_argument&)
+	{
+	}
+	try
+	{
+		compact.permuted(order,{0,10,compact.size()},{0});
+		QVERIFY(false);
+	}
+	catch(const std::invalid_argument&)
+	{
+	}
+	try
+	{
+		partitioner.edgeCut(std::vector<unsigned int>(compact.size(),4));
+		QVERIFY(false);
+	}
+	catch(const std::out_of_range&)
+	{
+	}
+	try
+	{
+		Partitioner(compact,0);
+		QVERIFY(false);
+	}
+	catch(const std::out_of_range&)
+	{
+	}
+	QVERIFY(Partitioner(CompactGraph(),3).apply(Partitioner(CompactGraph(),3).fennel()).empty());
+}
+
+void GraphUnitTest::reordering()
+{
+	UndirectedGraph path;
+	for(int i=0;i<20;++i)
+	{
+		path.insert(i*7%20);
+	}
+	for(int i=0;i<19;++i)
+	{
+		path.edge(i,i+1);
+	}
+	const CompactGraph compactPath(path);
+	const Reordering pathOrders(compactPath);
+	QVERIFY(pathOrders.bandwidth(pathOrders.reverseCuthillMcKee())==1);
+	QVERIFY(pathOrders.bandwidth(pathOrders.breadthFirst())<=2);
+	UndirectedGraph grid;
+	for(int r=0;r<10;++r)
+	{
+		for(int c=0;c<10;++c)
+		{
+			grid.insert((37*(10*r+c))%100);
+		}
+	}
+	for(int r=0;r<10;++r)
+	{
+		for(int c=0;c<10;++c)
+		{
+			if(c)
+			{
+				grid.edge(10*r+c,10*r+c-1);
+			}
+			if(r)
+			{
+				grid.edge(10*r+c,10*(r-1)+c);
+			}
+		}
+	}
+	grid.insert(100,{101});
+	grid.insert(102);
+	const CompactGraph compact(grid);
+	const Reordering reordering(compact);
+	const std::vector<Reordering::Permutation> permutations={reordering.reverseCuthillMcKee(),reordering.degreeDescending(),reordering.breadthFirst(),reordering.community()};
+	for(const auto& p:permutations)
+	{
+		QVERIFY(p.order.size()==compact.size() and p.position.size()==compact.size());
+		for(CompactGraph::NodeId i=0;i<compact.size();++i)
+		{
+			QVERIFY(p.position[p.order[i]]==i);
+		}
+		const CompactGraph reordered=reordering.apply(p);
+		QVERIFY(reordered.edgeCount()==compact.edgeCount());
+		for(CompactGraph::NodeId u=0;u<compact.size();++u)
+		{
+			QVERIFY(reordered.label(p.position[u])==compact.label(u));
+			for(const auto& v:compact.neighbors(u))
+			{
+				QVERIFY(reordered.isEdge(p.position[u],p.position[v]));
+			}
+		}
+	}
+	QVERIFY(reordering.bandwidth(permutations[0])<=11);
+	QVERIFY(reordering.bandwidth(permutations[0])<reordering.bandwidth(permutations[1]));
+	for(CompactGraph::NodeId i=1;i<compact.size();++i)
+	{
+		QVERIFY(compact.degree(permutations[1].order[i-1])>=compact.degree(permutations[1].order[i]));
+	}
+	const Reordering::Permutation& breadthFirst=permutations[2];
+	for(CompactGraph::NodeId i=1;i<compact.size();++i)
+	{
+		const CompactGraph::NodeId u=breadthFirst.order[i];
+		bool earlier=false;
+		for(const auto& v:compact.neighbors(u))
+		{
+			earlier=earlier or breadthFirst.position[v]<i;
+		}
+		QVERIFY(earlier or u==*std::min_element(breadthFirst.order.begin()+i,breadthFirst.order.end()));
+	}
+	const Louvain::Membership membership=Louvain(compact).membership();
+	const Reordering::Permutation& community=permutations[3];
+	std::vector<bool> finished(compact.size(),false);
+	for(CompactGraph::NodeId i=1;i<compact.size();++i)
+	{
+		const CompactGraph::NodeId previous=membership[community.order[i-1]],current=membership[community.order[i]];
+		if(previous!=current)
+		{
+			finished[previous]=true;
+			QVERIFY(not finished[current]);
+		}
+	}
+	QVERIFY(Reordering(CompactGraph()).reverseCuthillMcKee().order.empty());
+	try
+	{
+		reordering.apply(Reordering::Permutation());
+		QVERIFY(false);
+	}
+	catch(const std::invalid_argument&)
+	{
+	}
+}
+
+void GraphUnitTest::pageRank()
+{
+	UndirectedGraph cycle;
+	for(int i=0;i<10;++i)
+	{
+		cycle.insert(i,{(i+1)%10});
+	}
+	const CompactGraph compactCycle(cycle);
+	const PageRank::Result uniform=PageRank(compactCycle)();
+	QVERIFY(uniform.iterations>=1 and uniform.residual<1e-9);
+	for(const auto& r:uniform.ranks)
+	{
+		QVERIFY(std::fabs(r-0.1)<1e-9);
+	}
+	UndirectedGraph star;
+	star.insert(0,{1,2,3,4,5});
+	star.insert(6);
+	star.setWeight(0,1,4);
+	const CompactGraph compactStar(star);
+	for(unsigned int threads=1;threads<4;++threads)
+	{
+		const PageRank::Result result=PageRank(compactStar,0.85,1e-12,1000,threads)();
+		double sum=0;
+		for(const auto& r:result.ranks)
+		{
+			sum+=r;
+		}
+		QVERIFY(std::fabs(sum-1)<1e-9);
+		const PageRank::Ranks& ranks=result.ranks;
+		QVERIFY(ranks[compactStar.id(0)]>ranks[compactStar.id(1)]);
+		QVERIFY(ranks[compactStar.id(1)]>ranks[compactStar.id(2)]);
+		QVERIFY(std::fabs(ranks[compactStar.id(2)]-ranks[compactStar.id(5)])<1e-12);
+		QVERIFY(ranks[compactStar.id(6)]>0);
+	}
+	const PageRank::Result capped=PageRank(compactStar,0.85,0,3)();
+	QVERIFY(capped.iterations==3 and capped.residual>0);
+	const CompactGraph empty;
+	QVERIFY(PageRank(empty)().ranks.empty());
+	QVERIFY(not (std::is_constructible<PageRank,CompactGraph>::value));
+}
+
+void GraphUnitTest::personalizedPageRank()
+{
+	UndirectedGraph graph=buildBreadthFirstSegmented<UndirectedGraph>();
+	graph.setWeight(1,2,3);
+	const CompactGraph compact(graph);
+	const PageRank pageRank(compact,0.85,1e-12,1000);
+	const std::vector<CompactGraph::NodeId> seeds={compact.id(1),compact.id(2)};
+	const PageRank::Ranks exact=pageRank(seeds).ranks;
+	double sum=0;
+	for(const auto& r:exact)
+	{
+		sum+=r;
+	}
+	QVERIFY(std::fabs(sum-1)<1e-9);
+	QVERIFY(exact[compact.id(7)]==0 and exact[compact.id(8)]==0);
+	QVERIFY(exact[compact.id(1)]>exact[compact.id(6)]);
+	const double epsilon=1e-6;
+	const PageRank::SparseRanks approximate=pageRank.approximate(seeds,epsilon);
+	QVERIFY(not approximate.empty());
+	QVERIFY(approximate.front().first==compact.id(1) or approximate.front().first==compact.id(2));
+	for(std::size_t i=1;i<approximate.size();++i)
+	{
+		QVERIFY(approximate[i-1].second>=approximate[i].second);
+	}
+	for(const auto& r:approximate)
+	{
+		const CompactGraph::NodeId v=r.first;
+		double weight=0;
+		for(const auto& w:compact.weights(v))
+		{
+			weight+=w;
+		}
+		QVERIFY(r.second<=exact[v]+1e-9);
+		QVERIFY(exact[v]-r.second<=epsilon*weight+1e-9);
+		QVERIFY(compact.label(v).value()<7);
+	}
+	try
+	{
+		pageRank(std::vector<CompactGraph::NodeId>());
+		QVERIFY(false);
+	}
+	catch(const std::out_of_range&)
+	{
+	}
+	try
+	{
+		pageRank.approximate({compact.size()},epsilon);
+		QVERIFY(false);
+	}
+	catch(const std::out_of_range&)
+	{
+	}
+}
+
+void GraphUnitTest::louvain()
+{
+	//Zachary's karate club
+	const std::vector<std::pair<int,std::vector<int>>> club={{1,{2,3,4,5,6,7,8,9,11,12,13,14,18,20,22,32}},{2,{3,4,8,14,18,20,22,31}},
+		{3,{4,8,9,10,14,28,29,33}},{4,{8,13,14}},{5,{7,11}},{6,{7,11,17}},{7,{17}},{9,{31,33,34}},{10,{34}},{14,{34}},{15,{33,34}},
+		{16,{33,34}},{19,{33,34}},{20,{34}},{21,{33,34}},{23,{33,34}},{24,{26,28,30,33,34}},{25,{26,28,32}},{26,{32}},{27,{30,34}},
+		{28,{34}},{29,{32,34}},{30,{33,34}},{31,{33,34}},{32,{33,34}},{33,{34}}};
+	UndirectedGraph karate;
+	for(const auto& n:club)
+	{
+		UndirectedGraph::AdjacencyList neighbors;
+		for(const auto& m:n.second)
+		{
+			neighbors.insert(m);
+		}
+		karate.insert(n.first,neighbors);
+	}
+	QVERIFY(karate.size()==34 and karate.edgeCount()==78);
+	const Louvain louvain(karate);
+	const Louvain::Partition factions={{1,2,3,4,5,6,7,8,9,11,12,13,14,17,18,20,22},{10,15,16,19,21,23,24,25,26,27,28,29,30,31,32,33,34}};
+	QVERIFY(std::fabs(louvain.modularity(factions)-0.358235)<1e-6);
+	const Louvain::Partition communities=louvain();
+	QVERIFY(communities.size()>=3 and communities.size()<=5);
+	std::size_t covered=0;
+	for(std::size_t i=0;i<communities.size();++i)
+	{
+		covered+=communities[i].size();
+		QVERIFY(i==0 or communities[i-1].size()>=communities[i].size());
+	}
+	QVERIFY(covered==karate.size());
+	const double quality=louvain.modularity(communities);
+	//The best known partition has a modularity of 0.4198
+	QVERIFY(quality>0.41 and quality<0.4199);
+	for(unsigned int threads=1;threads<=4;++threads)
+	{
+		const Louvain::Membership membership=Louvain(karate,1,1e-7,threads).membership();
+		QVERIFY(std::fabs(louvain.modularity(membership)-quality)<1e-12);
+	}
+	UndirectedGraph cliques;
+	for(int i=0;i<4;++i)
+	{
+		for(int j=0;j<5;++j)
+		{
+			for(int k=j+1;k<5;++k)
+			{
+				cliques.insert(5*i+j,{5*i+k});
+			}
+		}
+		cliques.insert(5*i,{(5*i+5)%20});
+	}
+	cliques.insert(20);
+	const Louvain::Partition ring=Louvain(cliques)();
+	QVERIFY(ring.size()==5 and ring.back()==Louvain::NodeSet({20}));
+	for(int i=0;i<4;++i)
+	{
+		QVERIFY(ring[i].size()==5);
+		QVERIFY(std::all_of(ring[i].begin(),ring[i].end(),[&ring,i](const Node& n)
+		{
+			return n.value()/5==ring[i].begin()->value()/5;
+		}));
+	}
+	QVERIFY(Louvain(UndirectedGraph())().empty());
+	QVERIFY(Louvain(karate,2).modularity(factions)<louvain.modularity(factions));
+	UndirectedGraph ringOfCliques;
+	for(int i=0;i<1000;++i)
+	{
+		for(int j=0;j<5;++j)
+		{
+			for(int k=j+1;k<5;++k)
+			{
+				ringOfCliques.insert(5*i+j,{5*i+k});
+			}
+		}
+		ringOfCliques.insert(5*i,{(5*i+5)%5000});
+	}
+	const CompactGraph compactRing(ringOfCliques);
+	const Louvain::Membership reference=Louvain(compactRing,1,1e-7,1).membership();
+	const double referenceQuality=Louvain(compactRing,1,1e-7,1).modularity(reference);
+	QVERIFY(referenceQuality>0.9);
+	for(unsigned int threads=2;threads<=4;++threads)
+	{
+		const Louvain parallel(compactRing,1,1e-7,threads);
+		QVERIFY(parallel.membership()==reference and parallel.modularity(reference)==referenceQuality);
+	}
+	QVERIFY(not (std::is_constructible<Louvain,CompactGraph>::value));
+	for(const Louvain::Membership& bad:{Louvain::Membership(4999,0),Louvain::Membership(5000,5000)})
+	{
+		try
+		{
+			Louvain(compactRing).modularity(bad);
+			QVERIFY(false);
+		}
+		catch(const std::out_of_range&)
+		{
+		}
+	}
+}
+
 QTEST_APPLESS_MAIN(GraphUnitTest)
 
 #include "tst_GraphUnitTest.moc"
@@ -1,14 +1,26 @@
 #ifndef SetOperations_DisjointSets_H
 #define SetOperations_DisjointSets_H
 
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+#include <algorithm>
 #include <unordered_set>
 #include <unordered_map>
+#include "ParallelFor.h"
 
 namespace SetOperations
 {
 
 //! Union set implementation - This class maintains sets across union operations in almost constant time
 //!(inverse α() amortized)
+//! Elements are stored in plain arrays by index: a hash lookup maps an element to its index once per call, and the
+//! parents, ranks and set sizes are followed by index without any further hashing. The members of every set form a
+//! circular list through a next index per element, which join() splices in O(1), so a set is enumerated in O(size)
+//! while path compression only rewrites parents.
+//! The number of sets, the size of every set and the list of roots, also by index, are maintained by add() and join(),
+//! so statistics about the sets are cheap to poll and linking two sets does no hashing at all.
 //! The class makes copies of all input elements
 template<typename T>
 class DisjointSets
@@ -54,66 +66,6 @@ public:
 	{
 		using ElementException::ElementException;
 	};
-private:
-	//! Wrapper around the external element type. This class keep the value, the parent and the rank of an element
-	class Element
-	{
-	public:
-		Element(const T& x) noexcept:
-			m_x(x),
-			m_parent(x),
-			m_rank(0)
-		{
-		}
-
-		const T& parent() const noexcept
-		{
-			return m_parent;
-		}
-
-		//! ATENTION: Do not use this method directly. Use the parent(x,p) method of DisjointSets that maintains all
-		//! structures correctly
-		void parent(const T& p) const noexcept
-		{
-			m_parent=p;
-		}
-
-		unsigned int rank() const noexcept
-		{
-			return m_rank;
-		}
-
-		void increaseRank() const noexcept
-		{
-			++m_rank;
-		}
-
-		bool operator==(const Element& other) const noexcept
-		{
-			return m_x==other.m_x;
-		}
-
-		const T& element() const noexcept
-		{
-			return m_x;
-		}
-	private:
-		const T m_x;
-
-		mutable T m_parent;
-
-		mutable unsigned int m_rank;
-	};
-
-	//! Struct so that Element can be used with hash sets
-	class ElementHash
-	{
-	public:
-		::std::size_t operator()(const Element& e) const
-		{
-			return ::std::hash<T>()(e.element());
-		}
-	};
 public:
 	/*!
 	 * \brief add Add an element and keep it in its own set
@@ -122,11 +74,18 @@ public:
 	 */
 	void add(const T& x)
 	{
-		if(not m_elements.insert(x).second)
+		const Index i=m_values.size();
+		if(not m_indices.insert(std::make_pair(x,i)).second)
 		{
 			throw ElementExists(x);
 		}
-		m_sets[x].insert(x);
+		m_values.push_back(x);
+		m_parents.push_back(i);
+		m_ranks.push_back(0);
+		m_sizes.push_back(1);
+		m_next.push_back(i);
+		m_rootPositions.push_back(m_roots.size());
+		m_roots.push_back(i);
 	}
 
 	/*!
@@ -145,55 +104,341 @@ public:
 		}
 		catch(...)
 		{
-			m_sets.erase(x);
-			m_elements.erase(x);
+			removeLast();
 			throw;
 		}
 	}
 
 	using ElementSet=std::unordered_set<T>;
-private:
-	using Container=std::unordered_set<Element,ElementHash>;
-	using SetOfSets=std::unordered_map<T,ElementSet>;
+
+	//! The number of elements
+	typename ElementSet::size_type size() const noexcept
+	{
+		return m_values.size();
+	}
+protected:
+	//! The position of an element in the arrays
+	using Index=std::size_t;
 
 	/*!
-	 * \brief findHelper Helper method that does the lookup for an element
-	 * \param x
-	 * \return A reference to the element that is the representative of x's set
+	 * \brief index The index of an element
 	 * \throw NoSuchElement If x is not in the set
 	 */
-	const Element& findHelper(const T& x) const
+	Index index(const T& x) const
 	{
-		const typename Container::const_iterator it=m_elements.find(x);
-		if(it==m_elements.end())
+		const typename std::unordered_map<T,Index>::const_iterator it=m_indices.find(x);
+		if(it==m_indices.end())
 		{
 			throw NoSuchElement(x);
 		}
-		const Element& original=*it;
-		const Element* p=&original;
-		while(not (p->parent()==p->element()))
+		return it->second;
+	}
+
+	//! The index of the representative of an element, pointing the whole path at it
+	Index root(Index i) const noexcept
+	{
+		Index r=i;
+		while(m_parents[r]!=r)
 		{
-			const typename Container::const_iterator itP=m_elements.find(p->parent());
-			if(itP==m_elements.end())
-			{
-				throw CorruptedParent(p->element());
-			}
-			p=&*itP;
+			r=m_parents[r];
+		}
+		while(m_parents[i]!=r)
+		{
+			const Index next=m_parents[i];
+			m_parents[i]=r;
+			i=next;
+		}
+		return r;
+	}
+
+	//! The index of the representative of an element without compressing the path, so that it can run concurrently
+	Index representative(Index i) const noexcept
+	{
+		while(m_parents[i]!=i)
+		{
+			i=m_parents[i];
+		}
+		return i;
+	}
+
+	/*!
+	 * \brief link Join two sets by the indices of their roots: union by rank, then the circular lists are spliced by
+	 * swapping the successors of the two roots. Returns the root of the joined set
+	 */
+	Index link(Index xRoot,Index yRoot)
+	{
+		if(xRoot==yRoot)
+		{
+			return xRoot;
+		}
+		if(m_ranks[xRoot]<m_ranks[yRoot])
+		{
+			std::swap(xRoot,yRoot);
+		}
+		else if(m_ranks[xRoot]==m_ranks[yRoot])
+		{
+			++m_ranks[xRoot];
 		}
-		const T& pElement=p->element();
-		for(const Element* q=&original;not (q->parent()==q->element());)
+		m_parents[yRoot]=xRoot;
+		m_sizes[xRoot]+=m_sizes[yRoot];
+		std::swap(m_next[xRoot],m_next[yRoot]);
+		unroot(yRoot);
+		return xRoot;
+	}
+
+	//! Take an index out of the list of roots, by moving the last root into its place
+	void unroot(const Index i) noexcept
+	{
+		const Index position=m_rootPositions[i];
+		m_roots[position]=m_roots.back();
+		m_rootPositions[m_roots[position]]=position;
+		m_roots.pop_back();
+	}
+
+	//! Undo the add() of the last element, which must still be in a set of its own
+	void removeLast()
+	{
+		unroot(m_values.size()-1);
+		m_rootPositions.pop_back();
+		m_indices.erase(m_values.back());
+		m_values.pop_back();
+		m_parents.pop_back();
+		m_ranks.pop_back();
+		m_sizes.pop_back();
+		m_next.pop_back();
+	}
+
+	using IndexPair=std::pair<Index,Index>;
+
+	//! Sort and deduplicate in parallel: every chunk is sorted on its own thread, then neighboring chunks are merged
+	//! pairwise, also in parallel, until a single one is left
+	static void sortUnique(std::vector<IndexPair>& v,const unsigned int threads)
+	{
+		const std::size_t n=v.size();
+		const std::size_t chunks=std::max<std::size_t>(1,std::min<std::size_t>(threads?threads:Concurrency::hardwareThreads(),n/Concurrency::s_minimumChunk));
+		std::vector<std::size_t> bounds(chunks+1);
+		for(std::size_t chunk=0;chunk<=chunks;++chunk)
+		{
+			bounds[chunk]=n/chunks*chunk+std::min(chunk,n%chunks);
+		}
+		Concurrency::parallelForRanges(bounds,[&v](const std::size_t,const std::size_t first,const std::size_t last)
+		{
+			std::sort(v.begin()+first,v.begin()+last);
+		});
+		while(bounds.size()>2)
 		{
-			const typename Container::const_iterator itQ=m_elements.find(q->parent());
-			if(itQ==m_elements.end())
+			std::vector<std::size_t> merged;
+			for(std::size_t i=0;i<bounds.size();i+=2)
 			{
-				throw CorruptedParent(pElement);
+				merged.push_back(bounds[i]);
 			}
-			parent(*q,pElement);
-			q=&*itQ;
+			if(bounds.size()%2==0)
+			{
+				merged.push_back(bounds.back());
+			}
+			Concurrency::parallelForRanges(merged,[&v,&bounds](const std::size_t chunk,const std::size_t first,const std::size_t last)
+			{
+				if(2*chunk+2<bounds.size())
+				{
+					std::inplace_merge(v.begin()+first,v.begin()+bounds[2*chunk+1],v.begin()+last);
+				}
+			});
+			bounds.swap(merged);
 		}
-		return *p;
+		v.erase(std::unique(v.begin(),v.end()),v.end());
 	}
 public:
+	//! Iterates over the members of a set by following the circular list from its representative
+	class MemberIterator
+	{
+	public:
+		using iterator_category=std::forward_iterator_tag;
+		using value_type=T;
+		using difference_type=std::ptrdiff_t;
+		using pointer=const T*;
+		using reference=const T&;
+
+		MemberIterator() noexcept:
+			m_sets(nullptr),
+			m_first(0),
+			m_current(0),
+			m_end(true)
+		{
+		}
+
+		reference operator*() const noexcept
+		{
+			return m_sets->m_values[m_current];
+		}
+
+		pointer operator->() const noexcept
+		{
+			return &**this;
+		}
+
+		MemberIterator& operator++() noexcept
+		{
+			m_current=m_sets->m_next[m_current];
+			m_end=m_current==m_first;
+			return *this;
+		}
+
+		MemberIterator operator++(int) noexcept
+		{
+			const MemberIterator result=*this;
+			++*this;
+			return result;
+		}
+
+		//! Only meaningful between iterators over the same set
+		bool operator==(const MemberIterator& other) const noexcept
+		{
+			return m_end==other.m_end and (m_end or m_current==other.m_current);
+		}
+
+		bool operator!=(const MemberIterator& other) const noexcept
+		{
+			return not(*this==other);
+		}
+	private:
+		friend class DisjointSets;
+
+		const DisjointSets* m_sets;
+
+		Index m_first;
+
+		Index m_current;
+
+		bool m_end;
+
+		MemberIterator(const DisjointSets* sets,const Index first) noexcept:
+			m_sets(sets),
+			m_first(first),
+			m_current(first),
+			m_end(false)
+		{
+		}
+	};
+
+	//! The members of a set, as returned by members()
+	class MemberRange
+	{
+	public:
+		MemberIterator begin() const noexcept
+		{
+			return m_begin;
+		}
+
+		MemberIterator end() const noexcept
+		{
+			return MemberIterator();
+		}
+	private:
+		friend class DisjointSets;
+
+		MemberIterator m_begin;
+
+		explicit MemberRange(const MemberIterator& begin) noexcept:
+			m_begin(begin)
+		{
+		}
+	};
+
+	//! Iterates over the representative elements of the sets by walking the list of roots
+	class RootIterator
+	{
+	public:
+		using iterator_category=std::forward_iterator_tag;
+		using value_type=T;
+		using difference_type=std::ptrdiff_t;
+		using pointer=const T*;
+		using reference=const T&;
+
+		RootIterator() noexcept:
+			m_sets(nullptr)
+		{
+		}
+
+		reference operator*() const noexcept
+		{
+			return m_sets->m_values[*m_current];
+		}
+
+		pointer operator->() const noexcept
+		{
+			return &**this;
+		}
+
+		RootIterator& operator++() noexcept
+		{
+			++m_current;
+			return *this;
+		}
+
+		RootIterator operator++(int) noexcept
+		{
+			const RootIterator result=*this;
+			++m_current;
+			return result;
+		}
+
+		bool operator==(const RootIterator& other) const noexcept
+		{
+			return m_current==other.m_current;
+		}
+
+		bool operator!=(const RootIterator& other) const noexcept
+		{
+			return not(*this==other);
+		}
+	private:
+		friend class DisjointSets;
+
+		const DisjointSets* m_sets;
+
+		typename std::vector<Index>::const_iterator m_current;
+
+		RootIterator(const DisjointSets* sets,const typename std::vector<Index>::const_iterator current) noexcept:
+			m_sets(sets),
+			m_current(current)
+		{
+		}
+	};
+
+	//! The representative elements of all sets, as returned by roots()
+	class RootRange
+	{
+	public:
+		RootIterator begin() const noexcept
+		{
+			return RootIterator(m_sets,m_sets->m_roots.begin());
+		}
+
+		RootIterator end() const noexcept
+		{
+			return RootIterator(m_sets,m_sets->m_roots.end());
+		}
+
+		std::size_t size() const noexcept
+		{
+			return m_sets->m_roots.size();
+		}
+
+		bool empty() const noexcept
+		{
+			return m_sets->m_roots.empty();
+		}
+	private:
+		friend class DisjointSets;
+
+		const DisjointSets* m_sets;
+
+		explicit RootRange(const DisjointSets* sets) noexcept:
+			m_sets(sets)
+		{
+		}
+	};
+
 	/*!
 	 * \brief find Find the set an element belongs to
 	 * \param x
@@ -202,7 +447,7 @@ public:
 	 */
 	const T& find(const T& x) const
 	{
-		return findHelper(x).element();
+		return m_values[root(index(x))];
 	}
 
 	/*!
@@ -213,85 +458,260 @@ public:
 	 */
 	void join(const T& x, const T& y)
 	{
-		const Element& xRoot=findHelper(x);
-		const Element& yRoot=findHelper(y);
-		if(xRoot==yRoot)
+		link(root(index(x)),root(index(y)));
+	}
+
+	using ElementPair=std::pair<T,T>;
+
+	using ElementPairs=std::vector<ElementPair>;
+
+	/*!
+	 * \brief joinBatch Join the sets of every pair of elements, giving the same sets as join() on every pair in turn.
+	 * The elements are looked up and mapped to their representatives in parallel, without compressing paths. The pairs
+	 * of representatives that differ are sorted and deduplicated in parallel, then linked by index, so the sequential
+	 * part does no hashing and sees every pair of sets once. A final parallel pass points every element at its
+	 * representative. Meant for large batches: it costs O(pairs*log(pairs)/threads+size()/threads) beyond the links
+	 * \param threads The number of threads. 0 means Concurrency::hardwareThreads()
+	 * \throw NoSuchElement If an element is not in the set. No set is changed then
+	 */
+	void joinBatch(const ElementPairs& pairs,const unsigned int threads=0)
+	{
+		const Index n=m_values.size();
+		std::vector<IndexPair> links(pairs.size());
+		Concurrency::parallelFor(0,pairs.size(),[this,n,&pairs,&links](const std::size_t first,const std::size_t last)
+		{
+			for(std::size_t i=first;i<last;++i)
+			{
+				const Index x=representative(index(pairs[i].first));
+				const Index y=representative(index(pairs[i].second));
+				links[i]=x==y?IndexPair(n,n):IndexPair(std::minmax(x,y));
+			}
+		},threads);
+		sortUnique(links,threads);
+		if(not links.empty() and links.back().first==n)
+		{
+			links.pop_back();
+		}
+		if(links.empty())
 		{
 			return;
 		}
-		const unsigned int xRank=xRoot.rank();
-		const unsigned int yRank=yRoot.rank();
-		if(xRank<yRank)
+		for(const auto& l:links)
 		{
-			parent(xRoot,yRoot.element());
+			link(root(l.first),root(l.second));
 		}
-		else if(yRank<xRank)
+		std::vector<Index> parents(n);
+		Concurrency::parallelFor(0,n,[this,&parents](const std::size_t first,const std::size_t last)
+		{
+			for(Index i=first;i<last;++i)
+			{
+				parents[i]=representative(i);
+			}
+		},threads);
+		m_parents.swap(parents);
+	}
+
+	/*!
+	 * \brief findBatch The representative element of every element, looked up in parallel. Paths are not compressed,
+	 * so it doesn't write to the structure
+	 * \param threads The number of threads. 0 means Concurrency::hardwareThreads()
+	 * \throw NoSuchElement If an element is not in the set
+	 */
+	std::vector<T> findBatch(const std::vector<T>& xs,const unsigned int threads=0) const
+	{
+		std::vector<Index> roots(xs.size());
+		Concurrency::parallelFor(0,xs.size(),[this,&xs,&roots](const std::size_t first,const std::size_t last)
 		{
-			parent(yRoot,xRoot.element());
+			for(std::size_t i=first;i<last;++i)
+			{
+				roots[i]=representative(index(xs[i]));
+			}
+		},threads);
+		std::vector<T> result;
+		result.reserve(xs.size());
+		for(const auto& r:roots)
+		{
+			result.push_back(m_values[r]);
 		}
-		else
+		return result;
+	}
+
+	//! The number of sets
+	typename ElementSet::size_type setCount() const noexcept
+	{
+		return m_roots.size();
+	}
+
+	/*!
+	 * \brief setSize The number of elements in the set of an element
+	 * \throw NoSuchElement If x is not in the set
+	 */
+	std::size_t setSize(const T& x) const
+	{
+		return m_sizes[root(index(x))];
+	}
+
+	//! The representative element of every set, in no particular order and without copying them. Adding elements or
+	//! joining sets afterwards invalidates the iterators of the range
+	RootRange roots() const noexcept
+	{
+		return RootRange(this);
+	}
+
+	//! A set by its representative element and its size
+	using SetSize=std::pair<T,std::size_t>;
+
+	//! The k largest sets, largest first, by their representative element and size. O(sets*log(k))
+	std::vector<SetSize> largest(const std::size_t k) const
+	{
+		std::vector<SetSize> result;
+		result.reserve(m_roots.size());
+		for(const auto& r:m_roots)
 		{
-			parent(yRoot,xRoot.element());
-			xRoot.increaseRank();
+			result.push_back(SetSize(m_values[r],m_sizes[r]));
 		}
+		const auto larger=[](const SetSize& a,const SetSize& b)
+		{
+			return a.second>b.second;
+		};
+		const std::size_t n=std::min(k,result.size());
+		std::partial_sort(result.begin(),result.begin()+n,result.end(),larger);
+		result.erase(result.begin()+n,result.end());
+		return result;
 	}
 
 	using ElementSets=std::vector<ElementSet>;
 
 	//! Get all the sets. Note that this method copies all elements in the return value
-	ElementSets sets() const noexcept
+	ElementSets sets() const
 	{
 		ElementSets result;
-		result.reserve(m_sets.size());
-		for(const auto& s:m_sets)
+		result.reserve(m_roots.size());
+		for(const auto& r:m_roots)
 		{
-			result.push_back(s.second);
+			const MemberRange m(MemberIterator(this,r));
+			result.push_back(ElementSet(m.begin(),m.end()));
 		}
 		return result;
 	}
 
-	//! Get the set of an element. This method returns a reference to the internal set structure,
-	//! so modifying the sets afterwards can invalidate the returned value
-	const ElementSet& set(const T& x) const
+	/*!
+	 * \brief members The members of the set of an element, without copying them. Joining sets afterwards invalidates
+	 * the range
+	 * \throw NoSuchElement If x is not in the set
+	 */
+	MemberRange members(const T& x) const
+	{
+		return MemberRange(MemberIterator(this,index(x)));
+	}
+
+	/*!
+	 * \brief set Get a copy of the set of an element, in O(size)
+	 * \throw NoSuchElement If x is not in the set
+	 */
+	ElementSet set(const T& x) const
+	{
+		const MemberRange m=members(x);
+		return ElementSet(m.begin(),m.end());
+	}
+
+	/*!
+	 * \brief validate Check the parent structure of all elements in one pass, split across all hardware threads.
+	 * Every parent must be an element and every chain of parents must end at a root. Then every root must be in the
+	 * list of roots, and its circular list must hold exactly the elements under it, as many as its recorded size
+	 * \throw CorruptedParent On the first element found to be inconsistent
+	 */
+	void validate() const
 	{
-		const typename SetOfSets::const_iterator it=m_sets.find(find(x));
-		if(it==m_sets.end())
+		const Index n=m_values.size();
+		Concurrency::parallelFor(0,n,[this,n](const std::size_t first,const std::size_t last)
+		{
+			for(Index i=first;i<last;++i)
+			{
+				const typename std::unordered_map<T,Index>::const_iterator it=m_indices.find(m_values[i]);
+				if(it==m_indices.end() or it->second!=i or m_next[i]>=n or rootOf(i)==n)
+				{
+					throw CorruptedParent(m_values[i]);
+				}
+			}
+		});
+		Index members=0;
+		typename ElementSet::size_type roots=0;
+		for(Index r=0;r<n;++r)
 		{
-			throw CorruptedParent(x);
+			if(m_parents[r]!=r)
+			{
+				continue;
+			}
+			if(r>=m_rootPositions.size() or m_rootPositions[r]>=m_roots.size() or m_roots[m_rootPositions[r]]!=r)
+			{
+				throw CorruptedParent(m_values[r]);
+			}
+			++roots;
+			Index count=0;
+			Index i=r;
+			do
+			{
+				if(count==n or rootOf(i)!=r)
+				{
+					throw CorruptedParent(m_values[i]);
+				}
+				++count;
+				i=m_next[i];
+			}
+			while(i!=r);
+			if(count!=m_sizes[r])
+			{
+				throw CorruptedParent(m_values[r]);
+			}
+			members+=count;
+		}
+		if(members!=n or roots!=m_roots.size() or m_indices.size()!=n or m_rootPositions.size()!=n)
+		{
+			throw CorruptedParent(n?m_values.front():m_indices.begin()->first);
 		}
-		return it->second;
 	}
 private:
 	template<typename S>
 	friend std::ostream& ::operator<<(std::ostream&,const SetOperations::DisjointSets<S>&);
+protected:
+	//! The element at every index
+	std::vector<T> m_values;
+
+	std::unordered_map<T,Index> m_indices;
+
+	//! The parent of every index. Roots are their own parent
+	mutable std::vector<Index> m_parents;
+
+	//! The rank of every root
+	std::vector<unsigned char> m_ranks;
+
+	//! The number of elements in the set of every root
+	std::vector<Index> m_sizes;
+
+	//! The next member of the set of every index, in a circular list
+	std::vector<Index> m_next;
 
-	Container m_elements;
-	mutable SetOfSets m_sets;
+	//! The indices that are their own parent, in no particular order
+	std::vector<Index> m_roots;
 
-	//! Use this method to reparent an element safely - do not manipulate the element directly
-	void parent(const Element& e,const T& newParent) const
+	//! The position of every root in m_roots. Meaningless for the other indices
+	std::vector<Index> m_rootPositions;
+
+	//! The root of an index without compressing the path, so that it can run concurrently. Returns size() if the chain
+	//! of parents leaves the arrays or doesn't end
+	Index rootOf(Index i) const noexcept
 	{
-		const T& qElement=e.element();
-		const T& qParent=e.parent();
-		const typename SetOfSets::iterator qSetIt=m_sets.find(qParent);
-		if(qSetIt==m_sets.end())
-		{
-			throw CorruptedParent(qParent);
-		}
-		ElementSet& qSet=qSetIt->second;
-		const typename ElementSet::iterator qIt=qSet.find(qElement);
-		if(qIt==qSet.end())
-		{
-			throw CorruptedParent(qElement);
-		}
-		qSet.erase(qIt);
-		if(qSet.empty())
+		const Index n=m_values.size();
+		for(Index steps=0;m_parents[i]!=i;++steps)
 		{
-			m_sets.erase(qSetIt);
+			if(m_parents[i]>=n or steps==n)
+			{
+				return n;
+			}
+			i=m_parents[i];
 		}
-		e.parent(newParent);
-		m_sets[newParent].insert(qElement);
-
+		return i;
 	}
 };
 
@@ -300,9 +720,9 @@ private:
 template<typename T>
 std::ostream& operator<<(std::ostream& o,const SetOperations::DisjointSets<T>& s)
 {
-	for(const auto& n:s.m_elements)
+	for(const auto& x:s.m_values)
 	{
-		o<<n.element()<<" -> "<<s.find(n.element())<<std::endl;
+		o<<x<<" -> "<<s.find(x)<<std::endl;
 	}
 	return o;
 }
@@ -8,6 +8,7 @@ QT       -= core gui
 
 TARGET = SetOperations
 TEMPLATE = lib
+CONFIG += thread
 QMAKE_CXXFLAGS += -Wall -Werror -std=c++11
 
 DEFINES += SETOPERATIONS_LIBRARY
@@ -15,7 +16,8 @@ DEFINES += SETOPERATIONS_LIBRARY
 SOURCES +=
 
 HEADERS += \
-    DisjointSets.h
+    DisjointSets.h \
+    WeightedDisjointSets.h
 
 unix:!symbian {
     maemo5 {
@@ -25,3 +27,6 @@ unix:!symbian {
     }
     INSTALLS += target
 }
+
+INCLUDEPATH += $$PWD/../Concurrency
+DEPENDPATH += $$PWD/../Concurrency
@@ -0,0 +1,254 @@
+#ifndef SetOperations_WeightedDisjointSets_H
+#define SetOperations_WeightedDisjointSets_H
+
+#include <vector>
+#include <exception>
+#include "DisjointSets.h"
+
+namespace SetOperations
+{
+
+//! The group of parities: addition and subtraction are both exclusive or. Use it as the potential of a
+//! WeightedDisjointSets to keep parity constraints, such as "x and y are on different sides"
+class Parity
+{
+public:
+	Parity(const bool odd=false) noexcept:
+		m_odd(odd)
+	{
+	}
+
+	bool odd() const noexcept
+	{
+		return m_odd;
+	}
+
+	Parity operator+(const Parity& other) const noexcept
+	{
+		return Parity(m_odd!=other.m_odd);
+	}
+
+	Parity operator-(const Parity& other) const noexcept
+	{
+		return *this+other;
+	}
+
+	bool operator==(const Parity& other) const noexcept
+	{
+		return m_odd==other.m_odd;
+	}
+
+	bool operator!=(const Parity& other) const noexcept
+	{
+		return not(*this==other);
+	}
+private:
+	bool m_odd;
+};
+
+//! Union set that also keeps the difference between the elements of a set, for relation constraints such as
+//! "x = y + d". Every element stores its potential relative to its parent, so the difference between two elements of a
+//! set is the difference of their potentials relative to the root. Paths are compressed as in DisjointSets, summing the
+//! potentials along the way, so lookups stay almost constant time and a contradicting join is detected without
+//! searching.
+//! It shares the array layout of DisjointSets with one more array for the potentials.
+//! W is any group with +, binary - and W() as zero, such as an integer type, or Parity
+template<typename T,typename W=long long>
+class WeightedDisjointSets:private DisjointSets<T>
+{
+	using Base=DisjointSets<T>;
+
+	using Index=typename Base::Index;
+public:
+	using Potential=W;
+
+	using typename Base::NoSuchElement;
+	using typename Base::ElementExists;
+	using typename Base::CorruptedParent;
+	using typename Base::ElementSet;
+	using typename Base::ElementSets;
+	using typename Base::MemberIterator;
+	using typename Base::MemberRange;
+	using typename Base::RootIterator;
+	using typename Base::RootRange;
+	using typename Base::SetSize;
+
+	using Base::size;
+	using Base::setCount;
+	using Base::roots;
+	using Base::largest;
+	using Base::sets;
+	using Base::members;
+	using Base::set;
+
+	//! Thrown when asking for the difference between elements in different sets
+	class Unrelated:public std::exception
+	{
+	public:
+		Unrelated(const T& x,const T& y) noexcept:
+			m_x(x),
+			m_y(y)
+		{
+		}
+
+		const T& first() const noexcept
+		{
+			return m_x;
+		}
+
+		const T& second() const noexcept
+		{
+			return m_y;
+		}
+	private:
+		const T m_x;
+
+		const T m_y;
+	};
+
+	/*!
+	 * \brief add Add an element in its own set
+	 * \throw ElementExists if the element is already added
+	 */
+	void add(const T& x)
+	{
+		Base::add(x);
+		try
+		{
+			m_potentials.push_back(W());
+		}
+		catch(...)
+		{
+			Base::removeLast();
+			throw;
+		}
+	}
+
+	/*!
+	 * \brief find Find the set an element belongs to
+	 * \return The representative element of the set
+	 * \throw NoSuchElement If x is not in the set
+	 */
+	const T& find(const T& x) const
+	{
+		return Base::m_values[root(Base::index(x))];
+	}
+
+	/*!
+	 * \brief potential The difference between an element and the representative of its set
+	 * \throw NoSuchElement If x is not in the set
+	 */
+	W potential(const T& x) const
+	{
+		const Index i=Base::index(x);
+		root(i);
+		return m_potentials[i];
+	}
+
+	/*!
+	 * \brief related Whether two elements are in the same set, so that their difference is known
+	 * \throw NoSuchElement If an element is not in the set
+	 */
+	bool related(const T& x,const T& y) const
+	{
+		return root(Base::index(x))==root(Base::index(y));
+	}
+
+	/*!
+	 * \brief difference The difference x - y implied by the joins so far
+	 * \throw NoSuchElement If an element is not in the set
+	 * \throw Unrelated If the elements are in different sets
+	 */
+	W difference(const T& x,const T& y) const
+	{
+		const Index i=Base::index(x);
+		const Index j=Base::index(y);
+		if(root(i)!=root(j))
+		{
+			throw Unrelated(x,y);
+		}
+		return m_potentials[i]-m_potentials[j];
+	}
+
+	/*!
+	 * \brief join Record that x - y = delta, joining the sets of x and y. If they are in the same set already, only
+	 * checks the constraint
+	 * \return False if the constraint contradicts the joins so far, in which case nothing changes
+	 * \throw NoSuchElement If an element is not in the set
+	 */
+	bool join(const T& x,const T& y,const W& delta)
+	{
+		const Index i=Base::index(x);
+		const Index j=Base::index(y);
+		const Index xRoot=root(i);
+		const Index yRoot=root(j);
+		if(xRoot==yRoot)
+		{
+			return m_potentials[i]-m_potentials[j]==delta;
+		}
+		//With root potentials Rx and Ry, x - y = delta means Rx - Ry = delta - px + py
+		const W offset=delta-m_potentials[i]+m_potentials[j];
+		if(Base::link(xRoot,yRoot)==xRoot)
+		{
+			m_potentials[yRoot]=W()-offset;
+		}
+		else
+		{
+			m_potentials[xRoot]=offset;
+		}
+		return true;
+	}
+
+	/*!
+	 * \brief setSize The number of elements in the set of an element
+	 * \throw NoSuchElement If x is not in the set
+	 */
+	std::size_t setSize(const T& x) const
+	{
+		return Base::m_sizes[root(Base::index(x))];
+	}
+
+	/*!
+	 * \brief validate Check the parent structure as DisjointSets::validate() does, and that every element has a
+	 * potential
+	 * \throw CorruptedParent On the first element found to be inconsistent
+	 */
+	void validate() const
+	{
+		Base::validate();
+		if(m_potentials.size()!=size())
+		{
+			throw CorruptedParent(size()?Base::m_values.front():*roots().begin());
+		}
+	}
+private:
+	//! The difference between every element and its parent. Zero for roots
+	mutable std::vector<W> m_potentials;
+
+	//! The index of the representative of an element. The whole path is pointed at it, each element's potential
+	//! becoming the sum of the potentials from it to the root
+	Index root(const Index i) const
+	{
+		Index r=i;
+		W total=W();
+		while(Base::m_parents[r]!=r)
+		{
+			total=total+m_potentials[r];
+			r=Base::m_parents[r];
+		}
+		for(Index q=i;Base::m_parents[q]!=r;)
+		{
+			const Index next=Base::m_parents[q];
+			const W rest=total-m_potentials[q];
+			m_potentials[q]=total;
+			Base::m_parents[q]=r;
+			total=rest;
+			q=next;
+		}
+		return r;
+	}
+};
+
+}
+
+#endif // SetOperations_WeightedDisjointSets_H
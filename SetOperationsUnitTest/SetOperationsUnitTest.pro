@@ -9,7 +9,7 @@ QT       += testlib
 QT       -= gui
 
 TARGET = tst_SetOperationsUnitTest
-CONFIG   += console
+CONFIG   += console thread
 CONFIG   -= app_bundle
 
 TEMPLATE = app
@@ -24,3 +24,6 @@ else:unix: LIBS += -L$$OUT_PWD/../SetOperations/ -lSetOperations
 
 INCLUDEPATH += $$PWD/../SetOperations
 DEPENDPATH += $$PWD/../SetOperations
+
+INCLUDEPATH += $$PWD/../Concurrency
+DEPENDPATH += $$PWD/../Concurrency
@@ -1,5 +1,6 @@
 #include <QtTest>
 #include "DisjointSets.h"
+#include "WeightedDisjointSets.h"
 
 using namespace SetOperations;
 
@@ -82,6 +83,11 @@ private Q_SLOTS:
 	void disjointSetsSets();
 	void disjointSetsSet();
 	void disjointSets();
+	void disjointSetsValidate();
+	void disjointSetsStatistics();
+	void disjointSetsMembers();
+	void disjointSetsBatch();
+	void weightedDisjointSets();
 private:
 	template<typename T,template<typename> class S>
 	static bool disjoint(const std::vector<S<T>>& sets)
@@ -267,6 +273,269 @@ void SetOperationsUnitTest::disjointSets()
 	}
 }
 
+void SetOperationsUnitTest::disjointSetsValidate()
+{
+	DisjointSets<int> empty;
+	empty.validate();
+	QVERIFY(empty.size()==0);
+	DisjointSets<TestElement> sets=createComplex();
+	sets.validate();
+	const IntVector elements=flatten<int,unordered_set,vector>(m_all);
+	QVERIFY(sets.size()==elements.size());
+	DisjointSets<int> large;
+	const int n=10000;
+	for(int i=0;i<n;++i)
+	{
+		large.add(i);
+	}
+	for(int i=1;i<n;++i)
+	{
+		large.join(i,i/2);
+	}
+	large.validate();
+	QVERIFY(large.size()==n);
+}
+
+void SetOperationsUnitTest::disjointSetsStatistics()
+{
+	DisjointSets<TestElement> sets=createComplex();
+	QVERIFY(sets.setCount()==m_all.size() and sets.roots().size()==m_all.size());
+	std::vector<std::size_t> sizes;
+	for(const auto& next:m_all)
+	{
+		sizes.push_back(next.size());
+		QVERIFY(std::count(sets.roots().begin(),sets.roots().end(),sets.find(*next.begin()))==1);
+		for(const auto& e:next)
+		{
+			QVERIFY(sets.setSize(e)==next.size());
+		}
+	}
+	std::sort(sizes.rbegin(),sizes.rend());
+	const std::vector<DisjointSets<TestElement>::SetSize> largest=sets.largest(2);
+	QVERIFY(largest.size()==std::min<std::size_t>(2,sizes.size()));
+	for(std::size_t i=0;i<largest.size();++i)
+	{
+		QVERIFY(largest[i].second==sizes[i] and sets.setSize(largest[i].first)==sizes[i]);
+	}
+	QVERIFY(sets.largest(sizes.size()+5).size()==sizes.size());
+	const TestElement& other=*m_all.back().begin();
+	sets.join(*m_all.front().begin(),other);
+	QVERIFY(sets.setCount()+1==m_all.size());
+	QVERIFY(sets.setSize(other)==m_all.front().size()+m_all.back().size());
+	sets.validate();
+	const DisjointSets<TestElement>::RootRange roots=sets.roots();
+	QVERIFY(roots.size()==sets.setCount() and std::count(roots.begin(),roots.end(),sets.find(other))==1);
+	QVERIFY(DisjointSets<TestElement>::ElementSet(roots.begin(),roots.end()).size()==roots.size());
+	DisjointSets<int> ints;
+	ints.add(1);
+	try
+	{
+		ints.add(2,3);
+		QVERIFY(false);
+	}
+	catch(const DisjointSets<int>::NoSuchElement&)
+	{
+	}
+	QVERIFY(ints.setCount()==1 and std::vector<int>(ints.roots().begin(),ints.roots().end())==std::vector<int>({1}));
+	ints.validate();
+	try
+	{
+		ints.setSize(2);
+		QVERIFY(false);
+	}
+	catch(const DisjointSets<int>::NoSuchElement&)
+	{
+	}
+	QVERIFY(DisjointSets<int>().largest(3).empty());
+}
+
+void SetOperationsUnitTest::disjointSetsMembers()
+{
+	DisjointSets<TestElement> sets=createComplex();
+	for(const auto& next:m_all)
+	{
+		for(const auto& e:next)
+		{
+			std::vector<TestElement> members;
+			for(const auto& m:sets.members(e))
+			{
+				members.push_back(m);
+			}
+			QVERIFY(members.size()==next.size() and members.front()==e);
+			QVERIFY(unordered_set<TestElement>(members.begin(),members.end())==next);
+		}
+	}
+	DisjointSets<int> chain;
+	const int n=1000;
+	for(int i=0;i<n;++i)
+	{
+		chain.add(i);
+	}
+	for(int i=n-1;i>0;--i)
+	{
+		chain.join(i,i-1);
+		QVERIFY(chain.set(i).size()==std::size_t(n-i+1));
+	}
+	chain.validate();
+	QVERIFY(chain.sets().size()==1 and chain.set(n/2).size()==n);
+	try
+	{
+		chain.members(n);
+		QVERIFY(false);
+	}
+	catch(const DisjointSets<int>::NoSuchElement&)
+	{
+	}
+}
+
+void SetOperationsUnitTest::disjointSetsBatch()
+{
+	const int n=20000;
+	DisjointSets<int> sequential,batch;
+	for(int i=0;i<n;++i)
+	{
+		sequential.add(i);
+		batch.add(i);
+	}
+	DisjointSets<int>::ElementPairs pairs;
+	unsigned int seed=1;
+	for(int i=0;i<n*3/4;++i)
+	{
+		seed=seed*1103515245+12345;
+		const int x=seed%n;
+		seed=seed*1103515245+12345;
+		pairs.push_back(std::make_pair(x,int(seed%n)));
+		pairs.push_back(pairs.back());
+	}
+	for(const auto& p:pairs)
+	{
+		sequential.join(p.first,p.second);
+	}
+	batch.joinBatch(pairs,4);
+	batch.validate();
+	QVERIFY(batch.setCount()==sequential.setCount() and batch.setCount()>1);
+	std::vector<int> all(n);
+	for(int i=0;i<n;++i)
+	{
+		all[i]=i;
+	}
+	const std::vector<int> roots=batch.findBatch(all,4);
+	for(int i=0;i<n;++i)
+	{
+		QVERIFY(roots[i]==batch.find(i) and batch.setSize(i)==sequential.setSize(i));
+		QVERIFY(batch.set(i)==sequential.set(i));
+	}
+	batch.joinBatch(DisjointSets<int>::ElementPairs());
+	QVERIFY(batch.setCount()==sequential.setCount());
+	pairs.push_back(std::make_pair(0,n));
+	try
+	{
+		batch.joinBatch(pairs);
+		QVERIFY(false);
+	}
+	catch(const DisjointSets<int>::NoSuchElement& e)
+	{
+		QVERIFY(e.element()==n);
+	}
+	QVERIFY(batch.setCount()==sequential.setCount());
+	try
+	{
+		batch.findBatch(std::vector<int>{1,-1});
+		QVERIFY(false);
+	}
+	catch(const DisjointSets<int>::NoSuchElement& e)
+	{
+		QVERIFY(e.element()==-1);
+	}
+	DisjointSets<int> chain;
+	for(int i=0;i<n;++i)
+	{
+		chain.add(i);
+		pairs[i]=std::make_pair(i,i?i-1:0);
+	}
+	pairs.resize(n);
+	chain.joinBatch(pairs);
+	chain.validate();
+	QVERIFY(chain.setCount()==1 and chain.setSize(n-1)==std::size_t(n));
+}
+
+void SetOperationsUnitTest::weightedDisjointSets()
+{
+	WeightedDisjointSets<int> sets;
+	const int n=1000;
+	for(int i=0;i<n;++i)
+	{
+		sets.add(i);
+	}
+	for(int i=1;i<n;++i)
+	{
+		QVERIFY(sets.join(i,i-1,i%7));
+	}
+	sets.validate();
+	QVERIFY(sets.setCount()==1 and sets.setSize(0)==std::size_t(n));
+	long long expected=0;
+	for(int i=1;i<n;++i)
+	{
+		expected+=i%7;
+		QVERIFY(sets.difference(i,0)==expected and sets.difference(0,i)==-expected);
+		QVERIFY(sets.potential(i)-sets.potential(0)==expected);
+	}
+	QVERIFY(sets.join(n-1,0,expected));
+	QVERIFY(not sets.join(n-1,0,expected+1));
+	QVERIFY(sets.difference(n-1,0)==expected);
+	WeightedDisjointSets<int> pairs;
+	for(int i=0;i<6;++i)
+	{
+		pairs.add(i);
+	}
+	QVERIFY(pairs.join(0,1,5) and pairs.join(2,3,-2) and pairs.join(4,5,1));
+	QVERIFY(not pairs.related(1,3));
+	try
+	{
+		pairs.difference(1,3);
+		QVERIFY(false);
+	}
+	catch(const WeightedDisjointSets<int>::Unrelated& e)
+	{
+		QVERIFY(e.first()==1 and e.second()==3);
+	}
+	QVERIFY(pairs.join(1,3,10) and pairs.join(5,0,3));
+	QVERIFY(pairs.related(1,3) and pairs.difference(0,2)==5+10+2);
+	QVERIFY(pairs.difference(4,2)==1+3+5+10+2);
+	QVERIFY(pairs.find(4)==pairs.find(2) and pairs.set(4).size()==6);
+	QVERIFY(not pairs.join(4,3,0) and pairs.join(4,3,1+3+5+10));
+	pairs.validate();
+	try
+	{
+		pairs.join(0,6,1);
+		QVERIFY(false);
+	}
+	catch(const WeightedDisjointSets<int>::NoSuchElement& e)
+	{
+		QVERIFY(e.element()==6);
+	}
+	try
+	{
+		pairs.add(0);
+		QVERIFY(false);
+	}
+	catch(const WeightedDisjointSets<int>::ElementExists&)
+	{
+	}
+	QVERIFY(pairs.size()==6);
+	WeightedDisjointSets<int,Parity> sides;
+	for(int i=0;i<5;++i)
+	{
+		sides.add(i);
+	}
+	QVERIFY(sides.join(0,1,true) and sides.join(1,2,true) and sides.join(3,4,true));
+	QVERIFY(sides.difference(0,2)==Parity(false));
+	QVERIFY(not sides.join(0,2,true));
+	QVERIFY(sides.join(2,3,false) and sides.difference(0,4)==Parity(true));
+	QVERIFY(not sides.join(4,1,true) and sides.join(4,1,false));
+	sides.validate();
+}
+
 QTEST_APPLESS_MAIN(SetOperationsUnitTest)
 
 #include "tst_SetOperationsUnitTest.moc"
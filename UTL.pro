@@ -1,6 +1,8 @@
 TEMPLATE = subdirs
 
 SUBDIRS += \
+    Concurrency \
+    ConcurrencyUnitTest \
     SetOperations \
     SetOperationsUnitTest \
     Graph \
@@ -1,5 +1,7 @@
 #include <QtTest>
 #include "KCore.h"
+#include "CompactGraph.h"
+#include "CompressedGraph.h"
 
 using namespace Graph;
 
@@ -10,6 +12,7 @@ public:
 	KCoreUnitTest();
 private Q_SLOTS:
 	void kCore();
+	void kCoreDense();
 	void kCoreBenchmark();
 private:
 	using UndirectedGraph=Graph::UndirectedGraph<unsigned int>;
@@ -43,6 +46,27 @@ void KCoreUnitTest::kCore()
 	QVERIFY(KCore<unsigned int>(graph,3)()==KCore<unsigned int>::NodeSet({1,2,4,5,6}));
 }
 
+void KCoreUnitTest::kCoreDense()
+{
+	const UndirectedGraph graph=randomGraph(300,12);
+	const CompactGraph<unsigned int> compact(graph);
+	const CompressedGraph<unsigned int> compressed(compact);
+	const std::vector<KCore<unsigned int>::NodeDegree> coreNumbers=KCore<unsigned int>(graph,0).coreNumbers();
+	const std::vector<KCore<unsigned int>::NodeDegree> compactCoreNumbers=KCore<unsigned int,CompactGraph<unsigned int>>(compact,0).coreNumbers();
+	for(unsigned int k=0;k<20;++k)
+	{
+		const KCore<unsigned int>::NodeSet core=KCore<unsigned int>(graph,k)();
+		QVERIFY((KCore<unsigned int,CompactGraph<unsigned int>>(compact,k)())==core);
+		QVERIFY((KCore<unsigned int,CompressedGraph<unsigned int>>(compressed,k)())==core);
+		for(const auto& n:graph.nodesView())
+		{
+			QVERIFY((coreNumbers[graph.nodeId(n)]>=k)==(core.count(n)==1));
+			QVERIFY((compactCoreNumbers[compact.id(n)]>=k)==(core.count(n)==1));
+		}
+	}
+	QVERIFY((KCore<unsigned int,CompressedGraph<unsigned int>>(CompressedGraph<unsigned int>(),2)()).empty());
+}
+
 KCoreUnitTest::UndirectedGraph KCoreUnitTest::randomGraph(const unsigned int numberOfNodes,const double averageDegree)
 {
 	const unsigned int pickProbability=RAND_MAX*averageDegree/(numberOfNodes-1);